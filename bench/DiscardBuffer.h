@@ -0,0 +1,27 @@
+/**
+ * @file DiscardBuffer.h
+ * @brief Stream buffer the benchmarks use to silence progress messages.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.0
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <streambuf>
+
+namespace bench {
+
+/**
+ * @brief Stream buffer that accepts and drops everything.
+ * @details A null rdbuf would put std::cout in a failed state, which log()
+ * takes as the reader having gone away.
+ */
+class DiscardBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return traits_type::not_eof(c); }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+} // namespace bench
@@ -0,0 +1,139 @@
+/**
+ * @file alloc_bench.cpp
+ * @brief Counts heap allocations made by one add + commit.
+ *
+ * @details Replaces the global allocation functions with counting ones and
+ * stages and commits files of increasing size in a scratch repository.
+ * Reports, per add + commit, the number of allocations, the bytes
+ * allocated and the peak of live heap bytes, the last two relative to the
+ * file size. Every avoidable copy of the content shows up as roughly one
+ * more "x content" in the bytes column; the allocation count should not
+ * grow with the file size.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.1
+ * @date 2026-10-14
+ * @lastModified 2026-10-14
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <iostream>
+#include <filesystem>
+#include <unistd.h>
+#include "core/Repository.h"
+#include "DiscardBuffer.h"
+
+namespace {
+
+/**
+ * @brief Heap usage since the last reset().
+ * @details Atomic because the store's worker threads allocate too; relaxed
+ * ordering is enough, the totals are only read after they have joined.
+ */
+struct AllocStats {
+    std::atomic<std::size_t> count{0};
+    std::atomic<std::size_t> bytes{0};
+    std::atomic<std::size_t> live{0};
+    std::atomic<std::size_t> peak{0};
+
+    void reset() {
+        count.store(0, std::memory_order_relaxed);
+        bytes.store(0, std::memory_order_relaxed);
+        peak.store(live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+};
+
+AllocStats g_stats;
+
+// Each block is prefixed with its size so frees can be subtracted from live.
+constexpr std::size_t kHeader = alignof(std::max_align_t);
+
+void* counted_alloc(std::size_t n) {
+    void* p = std::malloc(n + kHeader);
+    if (!p) throw std::bad_alloc();
+    *static_cast<std::size_t*>(p) = n;
+    g_stats.count.fetch_add(1, std::memory_order_relaxed);
+    g_stats.bytes.fetch_add(n, std::memory_order_relaxed);
+    std::size_t live = g_stats.live.fetch_add(n, std::memory_order_relaxed) + n;
+    std::size_t peak = g_stats.peak.load(std::memory_order_relaxed);
+    while (live > peak && !g_stats.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    return static_cast<char*>(p) + kHeader;
+}
+
+void counted_free(void* p) noexcept {
+    if (!p) return;
+    void* block = static_cast<char*>(p) - kHeader;
+    g_stats.live.fetch_sub(*static_cast<std::size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+/**
+ * @brief Deterministic, mildly compressible text of @p size bytes.
+ */
+std::string make_content(std::size_t size, std::uint32_t seed) {
+    static const char* words[] = {"alpha ", "beta ", "gamma ", "delta\n", "epsilon ", "zeta ", "eta\n", "theta "};
+    std::string out;
+    out.reserve(size + 16);
+    std::uint32_t x = seed * 2654435761u + 1;
+    while (out.size() < size) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        out += words[x % 8];
+        if (x % 5 == 0) out += std::to_string(x);
+    }
+    out.resize(size);
+    return out;
+}
+
+} // namespace
+
+void* operator new(std::size_t n) { return counted_alloc(n); }
+void* operator new[](std::size_t n) { return counted_alloc(n); }
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, std::size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::size_t) noexcept { counted_free(p); }
+
+int main() {
+    namespace fs = std::filesystem;
+    const fs::path scratch = fs::temp_directory_path() / ("tri-alloc-bench-" + std::to_string(::getpid()));
+    fs::create_directories(scratch);
+    const fs::path home = fs::current_path();
+    fs::current_path(scratch);
+
+    constexpr int kRounds = 4;
+    std::printf("%10s %14s %16s %14s\n", "file KiB", "allocs/commit", "bytes x content", "peak x content");
+
+    for (std::size_t size = 1u << 20; size <= 16u << 20; size *= 4) {
+        fs::remove_all(".tri");
+        core::Repository repo;
+        bench::DiscardBuffer discard;
+        std::streambuf* out = std::cout.rdbuf(&discard);   // keep progress messages out of the table
+
+        std::size_t count = 0, bytes = 0, peak = 0;
+        for (int r = 0; r < kRounds; ++r) {
+            std::string content = make_content(size, static_cast<std::uint32_t>(size + r));
+            std::size_t baseline = g_stats.live.load(std::memory_order_relaxed);
+            g_stats.reset();
+            repo.add("big.txt", content);
+            repo.commit("round " + std::to_string(r), "bench");
+            count += g_stats.count.load(std::memory_order_relaxed);
+            bytes += g_stats.bytes.load(std::memory_order_relaxed);
+            peak += g_stats.peak.load(std::memory_order_relaxed) - baseline;
+        }
+
+        std::cout.rdbuf(out);
+        std::printf("%10zu %14zu %16.2f %14.2f\n", size >> 10, count / kRounds,
+                    static_cast<double>(bytes) / kRounds / size, static_cast<double>(peak) / kRounds / size);
+    }
+
+    fs::current_path(home);
+    fs::remove_all(scratch);
+    return 0;
+}
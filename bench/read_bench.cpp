@@ -0,0 +1,125 @@
+/**
+ * @file read_bench.cpp
+ * @brief Measures read throughput of published snapshots against thread count.
+ *
+ * @details Builds a scratch repository with a linear history, then runs
+ * reader threads that each take Repository::snapshot() and run a short log,
+ * a merge-base query and a blob read in a loop, while one writer keeps
+ * committing. Reports total and per-thread queries per second and the
+ * number of commits the writer made meanwhile. Queries take no locks; each
+ * round takes a fresh snapshot, which holds one of libstdc++'s shared_ptr
+ * mutexes for a reference-count increment, so the bench also shows what
+ * that acquisition costs as readers are added.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.2
+ * @date 2026-10-14
+ * @lastModified 2026-10-14
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <filesystem>
+#include <unistd.h>
+#include "core/Repository.h"
+#include "DiscardBuffer.h"
+
+namespace {
+
+constexpr int kHistory = 2000;
+constexpr int kFiles = 16;
+constexpr std::chrono::milliseconds kRun(500);
+
+std::string file_name(int i) { return "src/f" + std::to_string(i % kFiles) + ".txt"; }
+std::string file_content(int i) { return "version " + std::to_string(i) + "\n" + std::string(512, 'a' + i % 26); }
+
+void commit_one(core::Repository& repo, int i) {
+    repo.add(file_name(i), file_content(i));
+    repo.commit("commit " + std::to_string(i), "bench");
+}
+
+/**
+ * @brief One query round against a snapshot.
+ * @return False if an answer was wrong.
+ */
+bool query(const core::ReadSnapshot& s, std::uint32_t seed) {
+    const core::CommitGraphView& g = s.commit_graph();
+    std::uint32_t n = static_cast<std::uint32_t>(g.size());
+    entities::ObjectId tip = g.id(n - 1);
+    entities::ObjectId other = g.id(seed % n);
+
+    std::vector<core::CommitInfo> log = s.log(tip, 10);
+    if (log.empty() || log.front().id != tip) return false;
+    if (s.merge_base(tip, other) != other) return false;
+
+    int version = static_cast<int>(seed % kHistory);
+    std::string want = file_content(version);
+    return s.get_blob_content(entities::File::hash_of(file_name(version), want)) == want;
+}
+
+} // namespace
+
+int main() {
+    namespace fs = std::filesystem;
+    const fs::path scratch = fs::temp_directory_path() / ("tri-read-bench-" + std::to_string(::getpid()));
+    fs::create_directories(scratch);
+    const fs::path home = fs::current_path();
+    fs::current_path(scratch);
+
+    core::Repository repo;
+    bench::DiscardBuffer discard;
+    std::streambuf* out = std::cout.rdbuf(&discard);   // keep progress messages out of the table
+    for (int i = 0; i < kHistory; ++i) commit_one(repo, i);
+
+    std::vector<std::string> rows;
+    int next = kHistory;
+    bool ok = true;
+    for (unsigned threads = 1; threads <= 8; threads *= 2) {
+        std::atomic<bool> stop{false};
+        std::atomic<bool> failed{false};
+        std::atomic<std::uint64_t> queries{0};
+
+        std::vector<std::thread> readers;
+        for (unsigned t = 0; t < threads; ++t) {
+            readers.emplace_back([&, t] {
+                std::uint64_t done = 0;
+                std::uint32_t seed = 2654435761u * (t + 1);
+                while (!stop.load(std::memory_order_relaxed)) {
+                    std::shared_ptr<const core::ReadSnapshot> s = repo.snapshot();
+                    seed = seed * 1664525u + 1013904223u;
+                    if (!query(*s, seed >> 8)) failed = true;
+                    ++done;
+                }
+                queries += done;
+            });
+        }
+
+        int first = next;
+        auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < kRun) commit_one(repo, next++);
+        stop = true;
+        for (auto& r : readers) r.join();
+        std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+
+        char row[128];
+        double qps = static_cast<double>(queries.load()) / secs.count();
+        std::snprintf(row, sizeof(row), "%8u %14.0f %14.0f %16.1f", threads, qps, qps / threads,
+                      (next - first) / secs.count());
+        rows.push_back(row);
+        ok = ok && !failed;
+    }
+    std::cout.rdbuf(out);
+
+    std::printf("%8s %14s %14s %16s\n", "threads", "queries/s", "per thread", "writer commits/s");
+    for (const std::string& row : rows) std::printf("%s\n", row.c_str());
+
+    fs::current_path(home);
+    fs::remove_all(scratch);
+    if (!ok) std::fprintf(stderr, "read_bench: a snapshot query returned a wrong answer\n");
+    return ok ? 0 : 1;
+}
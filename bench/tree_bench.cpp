@@ -0,0 +1,102 @@
+/**
+ * @file tree_bench.cpp
+ * @brief Measures Merkle tree construction against snapshot size.
+ *
+ * @details Builds synthetic snapshots of increasing size laid out as a
+ * two-level directory hierarchy and reports the time per file for a full
+ * tree build and for an incremental single-file update. A full build that
+ * scales linearly shows a flat ns/file column; the incremental update
+ * should stay roughly constant regardless of snapshot size.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.0
+ * @date 2026-10-14
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "core/MerkleTree.h"
+#include "data_structures/HashTable.h"
+
+namespace {
+
+/**
+ * @brief In-memory TreeStore so the benchmark measures hashing, not I/O.
+ */
+class MemoryTreeStore : public core::TreeStore {
+private:
+    data_structures::HashTable<entities::ObjectId, std::string> trees_;
+
+public:
+    bool load_tree(const entities::ObjectId& id, std::string& payload) override {
+        const std::string* p = trees_.find(id);
+        if (!p) return false;
+        payload = *p;
+        return true;
+    }
+
+    void store_tree(const entities::ObjectId& id, const std::string& payload) override {
+        trees_.insert(id, payload);
+    }
+};
+
+entities::ObjectId synthetic_id(std::size_t n) {
+    return entities::ObjectId(crypto::Sha256::hash(std::to_string(n)));
+}
+
+/**
+ * @brief Snapshot of @p files files, 32 per directory, 32 directories per group.
+ * @details Every directory also holds a "name.txt" beside a "name/"
+ * subdirectory sibling, so children never arrive in name order for free.
+ */
+entities::Manifest make_snapshot(std::size_t files) {
+    std::vector<entities::ManifestEntry> entries;
+    entries.reserve(files);
+    for (std::size_t i = 0; i < files; ++i) {
+        std::string path = "g" + std::to_string(i / 1024) + "/d" + std::to_string((i / 32) % 32) +
+                           (i % 2 ? ".txt" : "/f" + std::to_string(i % 32) + ".c");
+        entries.emplace_back(path, synthetic_id(i));
+    }
+    return entities::Manifest::from_entries(std::move(entries));
+}
+
+template <typename F>
+double best_of(int runs, F&& fn) {
+    double best = 1e300;
+    for (int r = 0; r < runs; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double, std::nano> ns = std::chrono::steady_clock::now() - start;
+        if (ns.count() < best) best = ns.count();
+    }
+    return best;
+}
+
+} // namespace
+
+int main() {
+    std::printf("%10s %14s %12s %16s\n", "files", "full build ms", "ns/file", "1-file update us");
+
+    for (std::size_t files = 1000; files <= 128000; files *= 2) {
+        entities::Manifest snapshot = make_snapshot(files);
+
+        MemoryTreeStore store;
+        entities::ObjectId root;
+        double full = best_of(3, [&] {
+            core::MerkleTree tree(snapshot, &store);
+            root = tree.get_root_hash();
+        });
+
+        std::size_t n = 0;
+        double update = best_of(20, [&] {
+            std::vector<entities::ManifestEntry> change;
+            change.emplace_back("g0/d3/f6.c", synthetic_id(files + ++n));
+            core::MerkleTree::update(store, root, std::move(change));
+        });
+
+        std::printf("%10zu %14.2f %12.1f %16.1f\n", files, full / 1e6, full / files, update / 1e3);
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file BatchProtocol.h
+ * @brief Framing of requests and responses for `tri --batch`.
+ *
+ * @details Batch mode keeps one Repository open and answers requests read
+ * from standard input, so scripts pay the cost of opening the repository
+ * once instead of once per operation. Every argument is sent with its
+ * length, so paths and file contents may hold spaces, newlines or NUL
+ * bytes without quoting.
+ *
+ * A request is a header line holding the argument count and the byte
+ * length of each argument, followed by the arguments back to back:
+ *
+ *     3 3 5 6\n
+ *     adda.txthello\n
+ *
+ * is `add`, `a.txt`, `hello\n`. A response is `ok <length>\n` or
+ * `error <length>\n` followed by that many bytes of command output (for an
+ * error, the output so far and the message).
+ *
+ * Requests may be pipelined: a client can write any number of requests
+ * before reading, and responses come back in request order. The server
+ * only flushes when it has no further request buffered, so a batch of
+ * requests costs one round trip rather than one per request.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.0
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <cstddef>
+#include <stdexcept>
+
+namespace core {
+
+/**
+ * @brief Reads and writes batch-mode frames.
+ * * A malformed header leaves the stream at an unknown position, so the
+ *   server reports it and stops instead of guessing where the next request
+ *   starts
+ * * Limits guard against a corrupt header allocating unbounded memory
+ */
+class BatchProtocol {
+public:
+    static constexpr std::size_t kMaxArgs = 1024;
+    static constexpr std::size_t kMaxRequestBytes = std::size_t(1) << 30;
+
+    /**
+     * @brief Reads one request.
+     * @param in Stream positioned at a header line.
+     * @param[out] args Receives the arguments.
+     * @return False at end of input before a header.
+     * @throws std::runtime_error if the header is malformed or the input
+     * ends inside a request.
+     */
+    static bool read_request(std::istream& in, std::vector<std::string>& args) {
+        std::string header;
+        if (!std::getline(in, header)) return false;
+
+        std::istringstream fields(header);
+        std::size_t count = 0;
+        if (!(fields >> count) || count == 0 || count > kMaxArgs) {
+            throw std::runtime_error("Malformed batch header: '" + header + "'");
+        }
+
+        std::vector<std::size_t> lengths(count);
+        std::size_t total = 0;
+        for (std::size_t& len : lengths) {
+            if (!(fields >> len) || len > kMaxRequestBytes - total) {
+                throw std::runtime_error("Malformed batch header: '" + header + "'");
+            }
+            total += len;
+        }
+        std::string rest;
+        if (fields >> rest) throw std::runtime_error("Malformed batch header: '" + header + "'");
+
+        args.assign(count, std::string());
+        for (std::size_t i = 0; i < count; ++i) {
+            args[i].resize(lengths[i]);
+            if (lengths[i] && !in.read(&args[i][0], static_cast<std::streamsize>(lengths[i]))) {
+                throw std::runtime_error("Batch input ended inside a request");
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Writes one response; the caller decides when to flush.
+     */
+    static void write_response(std::ostream& out, bool ok, const std::string& body) {
+        out << (ok ? "ok " : "error ") << body.size() << '\n';
+        out.write(body.data(), static_cast<std::streamsize>(body.size()));
+    }
+
+    /**
+     * @brief Encodes a request, for clients and scripts.
+     */
+    static std::string encode_request(const std::vector<std::string>& args) {
+        std::string out = std::to_string(args.size());
+        for (const std::string& a : args) out += ' ' + std::to_string(a.size());
+        out += '\n';
+        for (const std::string& a : args) out += a;
+        return out;
+    }
+};
+
+} // namespace core
@@ -0,0 +1,131 @@
+/**
+ * @file BinaryIO.h
+ * @brief Little-endian encoding helpers for on-disk repository formats.
+ *
+ * @details All persistent structures under `.tri/` (object pack, pack index,
+ * serialized commits) are written through these helpers so that the files
+ * are byte-for-byte identical regardless of host endianness.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.0
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+namespace core {
+namespace binary_io {
+
+/**
+ * @brief Appends a 32-bit unsigned integer in little-endian order.
+ */
+inline void put_u32(std::string& out, std::uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+}
+
+/**
+ * @brief Appends a 64-bit unsigned integer in little-endian order.
+ */
+inline void put_u64(std::string& out, std::uint64_t v) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+}
+
+/**
+ * @brief Appends a length-prefixed string.
+ */
+inline void put_string(std::string& out, const std::string& s) {
+    put_u32(out, static_cast<std::uint32_t>(s.size()));
+    out.append(s);
+}
+
+/**
+ * @brief Decodes a 32-bit little-endian integer from raw memory.
+ */
+inline std::uint32_t load_u32(const unsigned char* p) {
+    std::uint32_t v = 0;
+    for (int i = 3; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+/**
+ * @brief Decodes a 64-bit little-endian integer from raw memory.
+ */
+inline std::uint64_t load_u64(const unsigned char* p) {
+    std::uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+/**
+ * @brief Bounds-checked sequential reader over an encoded buffer.
+ * * Throws std::runtime_error on truncated input
+ */
+class ByteReader {
+private:
+    const unsigned char* data_;
+    std::size_t size_;
+    std::size_t pos_;
+
+    void require(std::size_t n) const {
+        if (size_ - pos_ < n) throw std::runtime_error("ByteReader: truncated input");
+    }
+
+public:
+    ByteReader(const void* data, std::size_t size)
+        : data_(static_cast<const unsigned char*>(data)), size_(size), pos_(0) {}
+
+    explicit ByteReader(const std::string& s) : ByteReader(s.data(), s.size()) {}
+
+    std::uint8_t u8() {
+        require(1);
+        return data_[pos_++];
+    }
+
+    std::uint32_t u32() {
+        require(4);
+        std::uint32_t v = load_u32(data_ + pos_);
+        pos_ += 4;
+        return v;
+    }
+
+    std::uint64_t u64() {
+        require(8);
+        std::uint64_t v = load_u64(data_ + pos_);
+        pos_ += 8;
+        return v;
+    }
+
+    std::string string() {
+        std::uint32_t len = u32();
+        return bytes(len);
+    }
+
+    std::string bytes(std::size_t len) {
+        require(len);
+        std::string s(reinterpret_cast<const char*>(data_ + pos_), len);
+        pos_ += len;
+        return s;
+    }
+
+    /**
+     * @brief Returns a pointer to the next @p len bytes and skips them.
+     */
+    const unsigned char* raw(std::size_t len) {
+        require(len);
+        const unsigned char* p = data_ + pos_;
+        pos_ += len;
+        return p;
+    }
+
+    std::size_t position() const { return pos_; }
+    bool at_end() const { return pos_ == size_; }
+};
+
+} // namespace binary_io
+} // namespace core
@@ -0,0 +1,313 @@
+/**
+ * @file BitmapIndex.h
+ * @brief Persisted reachability bitmaps for selected commits.
+ *
+ * @details For a selected commit the index stores two bitmaps: the commits
+ * it can reach, numbered by CommitGraph position, and the objects (commits,
+ * trees and blobs) it can reach, numbered by the index's own object table.
+ * A reachability query walks the graph from the tips only until it meets a
+ * commit with a bitmap, ORs that bitmap in and skips everything below it;
+ * when every tip has a bitmap no commit or tree is decoded at all.
+ *
+ * Bitmaps stay EWAH-compressed in memory and are OR-ed into the result
+ * without being expanded. History is immutable, so bitmaps never go stale
+ * as commits are added; commits newer than the last build are simply walked.
+ *
+ * File layout (little-endian): "TRIBMP01", u32 object count, the object ids
+ * in numbering order, u32 entry count, then per entry `[ObjectId commit]
+ * [u32 position][EWAH commits][EWAH objects]`, followed by the SHA-256 of
+ * everything before it.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.0
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <queue>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include "BinaryIO.h"
+#include "CommitGraph.h"
+#include "MerkleTree.h"
+#include "../crypto/Sha256.h"
+#include "../data_structures/Bitmap.h"
+#include "../data_structures/HashTable.h"
+#include "../entities/ObjectId.h"
+
+namespace core {
+
+/**
+ * @brief Everything reachable from a set of commits.
+ * * commits is indexed by CommitGraph position
+ * * objects is indexed by BitmapIndex object number; reachable objects the
+ *   index does not number yet are listed in extra_objects
+ */
+struct ReachSet {
+    data_structures::Bitmap commits;
+    data_structures::Bitmap objects;
+    std::vector<entities::ObjectId> extra_objects;
+};
+
+/**
+ * @brief Reachability bitmaps over a stable commit and object numbering.
+ * * Lookups of the bitmap of a commit are O(1)
+ * * Only the object table is kept expanded; bitmaps are decoded on use
+ */
+class BitmapIndex {
+private:
+    static constexpr char kMagic[8] = {'T', 'R', 'I', 'B', 'M', 'P', '0', '1'};
+
+    struct Entry {
+        entities::ObjectId commit;
+        std::uint32_t pos;
+        std::string commits;   ///< EWAH
+        std::string objects;   ///< EWAH
+    };
+
+    std::vector<entities::ObjectId> objects_;
+    data_structures::HashTable<entities::ObjectId, std::uint32_t> numbers_;
+    std::vector<Entry> entries_;
+    data_structures::HashTable<std::uint32_t, std::size_t> by_pos_;
+
+    std::uint32_t number(const entities::ObjectId& id) {
+        std::uint32_t n = static_cast<std::uint32_t>(objects_.size());
+        objects_.push_back(id);
+        numbers_.put(id, n);
+        return n;
+    }
+
+    /**
+     * @brief Adds @p id to @p out unless it is already there.
+     * @return True if the object was new.
+     */
+    bool add_object(ReachSet& out, data_structures::HashTable<entities::ObjectId, bool>& extra,
+                    const entities::ObjectId& id) const {
+        if (const std::uint32_t* n = numbers_.find(id)) {
+            if (out.objects.test(*n)) return false;
+            out.objects.set(*n);
+            return true;
+        }
+        if (!extra.insert(id, true)) return false;
+        out.extra_objects.push_back(id);
+        return true;
+    }
+
+    /**
+     * @brief Adds a tree and everything below it that is not yet in @p out.
+     * @throws std::runtime_error if a tree is missing.
+     */
+    void add_tree(TreeStore& store, ReachSet& out, data_structures::HashTable<entities::ObjectId, bool>& extra,
+                  const entities::ObjectId& root) const {
+        if (root.is_null() || !add_object(out, extra, root)) return;
+        std::vector<entities::ObjectId> todo{root};
+        while (!todo.empty()) {
+            entities::ObjectId id = todo.back();
+            todo.pop_back();
+            for (const TreeEntry& e : MerkleTree::load_entries(store, id)) {
+                if (add_object(out, extra, e.id) && e.is_tree()) todo.push_back(e.id);
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief Drops every bitmap and the object numbering.
+     */
+    void clear() {
+        objects_.clear();
+        numbers_.clear();
+        entries_.clear();
+        by_pos_.clear();
+    }
+
+    std::size_t size() const { return entries_.size(); }
+    std::size_t object_count() const { return objects_.size(); }
+
+    /**
+     * @brief Returns the id of object number @p n.
+     */
+    const entities::ObjectId& object(std::uint32_t n) const { return objects_[n]; }
+
+    bool has_bitmap(std::uint32_t pos) const { return by_pos_.find(pos) != nullptr; }
+
+    /**
+     * @brief Computes everything reachable from @p tips.
+     *
+     * @details Commits are expanded in decreasing position order. Parents
+     * always have smaller positions than their children, so a commit with a
+     * bitmap is met before any of its ancestors and they are never walked.
+     *
+     * @param graph Graph that numbers the commits.
+     * @param tips Starting positions (kNone entries are ignored).
+     * @param with_objects Also collect trees and blobs; otherwise only
+     * ReachSet::commits is filled.
+     * @param store Tree source, used for commits without a bitmap.
+     * @param tree_of Returns the root tree id of the commit at a position.
+     * @throws std::runtime_error if a needed tree is missing.
+     */
+    template <typename TreeOf>
+    ReachSet reach(const CommitGraph& graph, const std::vector<std::uint32_t>& tips, bool with_objects,
+                   TreeStore& store, TreeOf&& tree_of) const {
+        ReachSet out;
+        out.commits.resize(graph.size());
+        if (with_objects) out.objects.resize(objects_.size());
+        data_structures::HashTable<entities::ObjectId, bool> extra;
+
+        std::priority_queue<std::uint32_t> queue;
+        for (std::uint32_t t : tips) {
+            if (t != CommitGraph::kNone) queue.push(t);
+        }
+        while (!queue.empty()) {
+            std::uint32_t pos = queue.top();
+            queue.pop();
+            if (out.commits.test(pos)) continue;
+
+            if (const std::size_t* i = by_pos_.find(pos)) {
+                out.commits.or_ewah(entries_[*i].commits);
+                if (with_objects) out.objects.or_ewah(entries_[*i].objects);
+                continue;
+            }
+            out.commits.set(pos);
+            if (with_objects) {
+                add_object(out, extra, graph.id(pos));
+                add_tree(store, out, extra, tree_of(pos));
+            }
+            for (std::uint32_t p : {graph.parent1(pos), graph.parent2(pos)}) {
+                if (p != CommitGraph::kNone && !out.commits.test(p)) queue.push(p);
+            }
+        }
+        return out;
+    }
+
+    /**
+     * @brief Replaces the index with bitmaps for the given commits.
+     * @details Commits are processed from oldest to newest, so the bitmap of
+     * each one is built on top of those already computed for its ancestors
+     * and the whole build walks every commit and tree about once. Objects
+     * are numbered in the order they are discovered, keeping old history in
+     * low numbers and long runs of ones.
+     * @param selected Positions to index; duplicates and kNone are ignored.
+     * @throws std::runtime_error if a needed tree is missing.
+     */
+    template <typename TreeOf>
+    void build(const CommitGraph& graph, std::vector<std::uint32_t> selected, TreeStore& store, TreeOf&& tree_of) {
+        clear();
+        std::sort(selected.begin(), selected.end());
+        selected.erase(std::unique(selected.begin(), selected.end()), selected.end());
+
+        for (std::uint32_t pos : selected) {
+            if (pos == CommitGraph::kNone || pos >= graph.size()) continue;
+            ReachSet r = reach(graph, {pos}, true, store, tree_of);
+            r.objects.resize(objects_.size() + r.extra_objects.size());
+            for (const entities::ObjectId& id : r.extra_objects) r.objects.set(number(id));
+            r.commits.resize(pos + 1);
+
+            by_pos_.put(pos, entries_.size());
+            entries_.push_back(Entry{graph.id(pos), pos, r.commits.encode_ewah(), r.objects.encode_ewah()});
+        }
+    }
+
+    /**
+     * @brief Writes the index atomically.
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void save(const std::string& path) const {
+        std::string out(kMagic, sizeof(kMagic));
+        binary_io::put_u32(out, static_cast<std::uint32_t>(objects_.size()));
+        for (const entities::ObjectId& id : objects_) {
+            out.append(reinterpret_cast<const char*>(id.data()), entities::ObjectId::size());
+        }
+        binary_io::put_u32(out, static_cast<std::uint32_t>(entries_.size()));
+        for (const Entry& e : entries_) {
+            out.append(reinterpret_cast<const char*>(e.commit.data()), entities::ObjectId::size());
+            binary_io::put_u32(out, e.pos);
+            out.append(e.commits);
+            out.append(e.objects);
+        }
+        crypto::Digest sum = crypto::Sha256::hash(out);
+        out.append(reinterpret_cast<const char*>(sum.bytes.data()), sum.bytes.size());
+
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+            if (!f || !f.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+                throw std::runtime_error("Cannot write bitmap index: " + tmp);
+            }
+        }
+        if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+            throw std::runtime_error("Cannot replace bitmap index: " + path);
+        }
+    }
+
+    /**
+     * @brief Loads the index; a missing, damaged or outdated file leaves it empty.
+     * @details The index is only a cache. It is dropped as a whole if any
+     * entry disagrees with @p graph about a commit's position, which happens
+     * when the commit graph was rebuilt.
+     */
+    void load(const std::string& path, const CommitGraph& graph) {
+        clear();
+
+        std::ifstream f(path, std::ios::binary);
+        if (!f) return;
+        std::string data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+        const std::size_t sum_size = crypto::Digest::kSize;
+        if (data.size() < sizeof(kMagic) + 8 + sum_size ||
+            std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+            return;
+        }
+        std::string_view body(data.data(), data.size() - sum_size);
+        crypto::Digest sum = crypto::Sha256::hash(body);
+        if (std::memcmp(sum.bytes.data(), data.data() + body.size(), sum_size) != 0) return;
+
+        try {
+            binary_io::ByteReader in(body.data(), body.size());
+            in.raw(sizeof(kMagic));
+            std::uint32_t count = in.u32();
+            objects_.reserve(count);
+            numbers_.reserve(count);
+            for (std::uint32_t i = 0; i < count; ++i) {
+                number(entities::ObjectId::from_bytes(in.raw(entities::ObjectId::size())));
+            }
+
+            auto ewah = [&](std::size_t bits_limit) {
+                std::string_view rest = body.substr(in.position());
+                std::size_t n = data_structures::Bitmap::ewah_size(rest);
+                if (data_structures::Bitmap::ewah_bits(rest) > bits_limit) {
+                    throw std::runtime_error("bitmap out of range");
+                }
+                in.raw(n);
+                return std::string(rest.substr(0, n));
+            };
+
+            std::uint32_t entries = in.u32();
+            for (std::uint32_t i = 0; i < entries; ++i) {
+                Entry e;
+                e.commit = entities::ObjectId::from_bytes(in.raw(entities::ObjectId::size()));
+                e.pos = in.u32();
+                if (e.pos >= graph.size() || graph.id(e.pos) != e.commit) {
+                    throw std::runtime_error("commit graph changed");
+                }
+                e.commits = ewah(e.pos + 1);
+                e.objects = ewah(objects_.size());
+                by_pos_.put(e.pos, entries_.size());
+                entries_.push_back(std::move(e));
+            }
+            if (!in.at_end()) throw std::runtime_error("trailing data");
+        } catch (const std::runtime_error&) {
+            clear();
+        }
+    }
+};
+
+} // namespace core
@@ -0,0 +1,309 @@
+/**
+ * @file BlobPipeline.h
+ * @brief Parallel hashing, encoding and batched storage of many blobs.
+ *
+ * @details Staging a large tree used to read, hash, compress and append one
+ * file at a time. The pipeline splits that work: delta bases are resolved
+ * up front on the calling thread, a pool of workers reads, hashes and
+ * encodes files, and the calling thread collects finished blobs from a
+ * bounded queue and appends them to the pack in large batches. The pack is
+ * synced and indexed once, at the end.
+ *
+ * The queue bounds how many encoded blobs wait for the writer, so memory
+ * stays proportional to the batch size and thread count rather than to the
+ * size of the import.
+ *
+ * Content the store already holds is never encoded: inputs whose id is
+ * known from a scan are looked up before being read, and the workers look
+ * every other id up in a snapshot of the store as soon as it is hashed.
+ *
+ * Files of kStreamThreshold bytes or more are never loaded whole: they are
+ * read, hashed and compressed in fixed-size pieces straight into the pack
+ * on the calling thread (see stream_file()). Such files are not stored as
+ * deltas. So are files the store splits into content-defined chunks (see
+ * ObjectStore::set_chunking()), since chunks are cut as the bytes arrive.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.5
+ * @date 2026-10-14
+ * @lastModified 2026-10-14
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+#include <cstdint>
+#include "GraphManager.h"
+#include "WorkingTree.h"
+#include "../data_structures/Queue.h"
+#include "../entities/File.h"
+#include "../entities/ObjectId.h"
+
+namespace core {
+
+/**
+ * @brief A file to store.
+ */
+struct BlobInput {
+    std::string path;                       ///< Repository path; also the file read if content is null
+    entities::ObjectId base;                ///< Suggested delta base (previous version), or the null id
+    const std::string* content = nullptr;   ///< Content already in memory, or nullptr to read the file
+    std::uint64_t size = 0;                 ///< Size of the file on disk, if known; selects streaming
+    entities::ObjectId id;                  ///< Content id if already known (e.g. from a scan), else null
+};
+
+/**
+ * @brief What became of one BlobInput.
+ */
+struct BlobOutput {
+    entities::ObjectId id;   ///< Content id (valid if ok)
+    bool ok = false;         ///< False if the file could not be read
+    bool existed = false;    ///< The store already held it; nothing was encoded or written
+};
+
+/**
+ * @brief Stores batches of blobs using all cores and few writes.
+ * * Workers only touch their own job and read an immutable snapshot of
+ *   the store; the store itself is used by the calling thread alone
+ * * Results are returned in input order, independent of scheduling
+ */
+class BlobPipeline {
+private:
+    static constexpr std::size_t kBatchBytes = 8u << 20;     ///< Encoded bytes gathered per pack write
+    static constexpr std::size_t kMinJobsPerThread = 8;      ///< Below this, extra threads cost more than they save
+
+    /**
+     * @brief Blocking FIFO with a fixed capacity.
+     * @details close() wakes every waiter; afterwards push() and pop() fail.
+     */
+    template <typename T>
+    class BoundedQueue {
+    private:
+        data_structures::Queue<T> items_;
+        std::size_t capacity_;
+        bool closed_ = false;
+        std::mutex mutex_;
+        std::condition_variable not_full_;
+        std::condition_variable not_empty_;
+
+    public:
+        explicit BoundedQueue(std::size_t capacity) : capacity_(std::max<std::size_t>(capacity, 1)) {}
+
+        bool push(const T& item) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_full_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+            if (closed_) return false;
+            items_.enqueue(item);
+            not_empty_.notify_one();
+            return true;
+        }
+
+        bool pop(T& out) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+            if (items_.empty()) return false;
+            out = items_.front();
+            items_.dequeue();
+            not_full_.notify_one();
+            return true;
+        }
+
+        void close() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+            not_full_.notify_all();
+            not_empty_.notify_all();
+        }
+    };
+
+    unsigned threads_;
+
+    unsigned thread_count(std::size_t jobs) const {
+        unsigned n = threads_ ? threads_ : std::max(1u, std::thread::hardware_concurrency());
+        std::size_t useful = std::max<std::size_t>(1, jobs / kMinJobsPerThread);
+        return static_cast<unsigned>(std::min<std::size_t>(n, useful));
+    }
+
+    /**
+     * @brief Reads, hashes and encodes one input.
+     * @details Content found in @p known is not encoded; the input is
+     * marked as existing and its read buffer released.
+     * @return False if the file could not be read.
+     */
+    static bool process(const BlobInput& in, const ObjectStore::Snapshot& known, PendingWrite& w,
+                        BlobOutput& out) {
+        if (in.content) w.source = *in.content;
+        else if (!WorkingTree::read_file(in.path, w.data)) return false;
+
+        w.key = entities::File::hash_of(in.path, w.payload());
+        out.id = w.key;
+        if (known.contains(w.key)) {
+            out.existed = true;
+            w = PendingWrite();
+            return true;
+        }
+        try {
+            w.encode();
+        } catch (const std::runtime_error&) {
+            // A damaged delta base must not lose the new version: store it whole.
+            w.base_id = entities::ObjectId();
+            w.base = PackedObject();
+            w.encode();
+        }
+        return true;
+    }
+
+public:
+    /**
+     * @brief Creates a pipeline.
+     * @param threads Worker threads (0 = hardware concurrency).
+     */
+    explicit BlobPipeline(unsigned threads = 0) : threads_(threads) {}
+
+    static constexpr std::uint64_t kStreamThreshold = 8u << 20;   ///< Files this large are streamed
+
+    /**
+     * @brief Stores a file from disk in constant memory.
+     *
+     * @details The file is read in pieces that are hashed and handed to the
+     * store's BlobWriter as they arrive, so neither the content nor its
+     * encoding is ever held whole. The blob is not durable until
+     * GraphManager::flush().
+     *
+     * @param graph Store to write to.
+     * @param path Repository path; also the file read.
+     * @param[out] out Receives the path, size and id of the stored file.
+     * @return False if the file could not be read; nothing is stored then.
+     * @throws std::runtime_error if the pack cannot be written.
+     */
+    static bool stream_file(GraphManager& graph, const std::string& path, entities::File& out) {
+        ObjectStore::BlobWriter writer = graph.stream_blob();
+        entities::File::Hasher hasher(path);
+        bool read = WorkingTree::read_chunks(path, [&](std::string_view piece) {
+            hasher.update(piece);
+            writer.write(piece);
+        });
+        if (!read) return false;
+
+        entities::ObjectId id = hasher.finish();
+        std::uint64_t size = writer.size();
+        writer.finish(id);
+        out = entities::File(path, size, id);
+        return true;
+    }
+
+    /**
+     * @brief Stores every input and makes the result durable.
+     *
+     * @details Blobs already in the store are neither encoded nor written
+     * again. After the last batch the pack is synced and the index rewritten
+     * once. An exception thrown on a worker thread stops the workers and is
+     * rethrown here.
+     *
+     * @param graph Store to write to; only used from the calling thread.
+     * @param inputs Files to store; in-memory contents are read in place and
+     * must stay alive until the call returns.
+     * @return One result per input, in input order.
+     * @throws std::runtime_error if the pack cannot be written, or whatever
+     * a worker threw.
+     */
+    std::vector<BlobOutput> store(GraphManager& graph, const std::vector<BlobInput>& inputs) {
+        const std::size_t n = inputs.size();
+        std::vector<BlobOutput> results(n);
+        if (n == 0) return results;
+
+        // Large and chunked files go straight to the pack; everything else through the workers.
+        std::vector<std::size_t> todo;
+        todo.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            const BlobInput& in = inputs[i];
+            if (!in.id.is_null() && graph.has_object(in.id)) {
+                results[i].id = in.id;
+                results[i].ok = results[i].existed = true;
+            } else if (in.content && graph.chunks(in.content->size())) {
+                results[i].id = entities::File::hash_of(in.path, *in.content);
+                graph.save_blob(results[i].id, *in.content);
+                results[i].ok = true;
+            } else if (!in.content && (in.size >= kStreamThreshold || graph.chunks(in.size))) {
+                entities::File streamed;
+                results[i].ok = stream_file(graph, in.path, streamed);
+                results[i].id = streamed.get_hash();
+            } else {
+                todo.push_back(i);
+            }
+        }
+
+        std::vector<PendingWrite> jobs(n);
+        for (std::size_t i : todo) jobs[i] = graph.prepare_blob(inputs[i].base);
+        const ObjectStore::Snapshot known = graph.object_snapshot();   // read by the workers
+
+        std::vector<PendingWrite> batch;
+        std::size_t batch_bytes = 0;
+        auto collect = [&](std::size_t i) {
+            if (!results[i].ok || results[i].existed) return;
+            batch_bytes += jobs[i].header.size() + jobs[i].stored().size();
+            batch.push_back(std::move(jobs[i]));
+            if (batch_bytes >= kBatchBytes) {
+                graph.write_objects(batch);
+                batch.clear();
+                batch_bytes = 0;
+            }
+        };
+
+        const std::size_t count = todo.size();
+        const unsigned threads = thread_count(count);
+        if (threads <= 1) {
+            for (std::size_t i : todo) {
+                results[i].ok = process(inputs[i], known, jobs[i], results[i]);
+                collect(i);
+            }
+        } else {
+            BoundedQueue<std::size_t> done(2 * threads);
+            std::atomic<std::size_t> next{0};
+            std::exception_ptr failure;
+            std::mutex failure_mutex;
+            auto worker = [&] {
+                try {
+                    for (std::size_t k; (k = next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+                        std::size_t i = todo[k];
+                        results[i].ok = process(inputs[i], known, jobs[i], results[i]);
+                        if (!done.push(i)) return;
+                    }
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(failure_mutex);
+                    if (!failure) failure = std::current_exception();
+                    done.close();   // wakes the collector and the other workers
+                }
+            };
+
+            std::vector<std::thread> pool;
+            pool.reserve(threads);
+            for (unsigned t = 0; t < threads; ++t) pool.emplace_back(worker);
+            try {
+                std::size_t i = 0;
+                for (std::size_t k = 0; k < count && done.pop(i); ++k) collect(i);
+            } catch (...) {
+                done.close();
+                for (auto& t : pool) t.join();
+                throw;
+            }
+            for (auto& t : pool) t.join();
+            if (failure) std::rethrow_exception(failure);
+        }
+
+        graph.write_objects(batch);
+        graph.flush();
+        return results;
+    }
+};
+
+} // namespace core
@@ -0,0 +1,78 @@
+/**
+ * @file BlobView.h
+ * @brief Non-owning view of blob content that keeps its backing storage alive.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.0
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace core {
+
+/**
+ * @brief Pointer/length view of blob bytes.
+ * * Usually points into a memory-mapped pack; the mapping is kept alive by owner
+ * * When the bytes also live in a file, source_fd()/source_offset() locate them
+ *   so writers can use in-kernel copies (copy_file_range)
+ */
+class BlobView {
+private:
+    std::shared_ptr<const void> owner_;
+    const char* data_;
+    std::size_t size_;
+    int source_fd_;
+    std::uint64_t source_offset_;
+
+public:
+    /**
+     * @brief Creates an empty view.
+     */
+    BlobView() : data_(nullptr), size_(0), source_fd_(-1), source_offset_(0) {}
+
+    /**
+     * @brief Creates a view over memory kept alive by @p owner.
+     * @param owner Keeps the viewed memory valid (may be null for static/borrowed data).
+     * @param data First byte.
+     * @param size Number of bytes.
+     * @param source_fd File the bytes were mapped from, or -1.
+     * @param source_offset Offset of the first byte within @p source_fd.
+     */
+    BlobView(std::shared_ptr<const void> owner, const char* data, std::size_t size,
+             int source_fd = -1, std::uint64_t source_offset = 0)
+        : owner_(std::move(owner)), data_(data), size_(size),
+          source_fd_(source_fd), source_offset_(source_offset) {}
+
+    /**
+     * @brief Creates a borrowed view over a string; the string must outlive the view.
+     */
+    static BlobView borrow(const std::string& s) {
+        return BlobView(nullptr, s.data(), s.size());
+    }
+
+    /**
+     * @brief Creates a view that owns its bytes.
+     */
+    static BlobView adopt(std::string&& s) {
+        auto holder = std::make_shared<const std::string>(std::move(s));
+        return BlobView(holder, holder->data(), holder->size());
+    }
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    int source_fd() const { return source_fd_; }
+    std::uint64_t source_offset() const { return source_offset_; }
+
+    std::string_view view() const { return std::string_view(data_, size_); }
+    std::string to_string() const { return std::string(data_, size_); }
+};
+
+} // namespace core
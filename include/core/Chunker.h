@@ -0,0 +1,125 @@
+/**
+ * @file Chunker.h
+ * @brief Content-defined chunking with FastCDC.
+ *
+ * @details Cut points are chosen by the content itself: a gear hash rolls
+ * over the bytes (one shift and one table lookup per byte) and a chunk ends
+ * where the hash matches a mask. An insertion therefore only moves the cut
+ * points next to it; every chunk after the next matching position is byte
+ * for byte the same as before, so versions of a file that grow or change
+ * locally share almost all of their chunks.
+ *
+ * Normalized chunking keeps sizes close to the average: up to the average
+ * size a mask with two more bits (harder to match) is used, past it one
+ * with two fewer bits, and no chunk is shorter than a quarter or longer
+ * than eight times the average. The first quarter is skipped without
+ * hashing, which is where most of FastCDC's speed comes from.
+ *
+ * The gear table is fixed, so the same content is always cut the same way.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.0
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <stdexcept>
+
+namespace core {
+
+/**
+ * @brief Splits byte streams at content-defined boundaries.
+ * * cut() only looks at the bytes it is given, up to max_size()
+ * * Sizes are powers of two between kMinAverage and kMaxAverage
+ */
+class FastCdc {
+public:
+    static constexpr std::size_t kMinAverage = 1u << 10;
+    static constexpr std::size_t kMaxAverage = 1u << 18;
+    static constexpr std::size_t kDefaultAverage = 1u << 16;
+
+private:
+    static constexpr std::array<std::uint64_t, 256> make_gear() {
+        std::array<std::uint64_t, 256> t{};
+        std::uint64_t x = 0x7472692d63646321ull;   // splitmix64
+        for (auto& v : t) {
+            x += 0x9e3779b97f4a7c15ull;
+            std::uint64_t z = x;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            v = z ^ (z >> 31);
+        }
+        return t;
+    }
+
+    static const std::array<std::uint64_t, 256>& gear() {
+        static constexpr std::array<std::uint64_t, 256> table = make_gear();
+        return table;
+    }
+
+    /**
+     * @brief Mask of the @p bits highest bits; those depend on the most bytes.
+     */
+    static constexpr std::uint64_t top_bits(unsigned bits) { return ~std::uint64_t(0) << (64 - bits); }
+
+    std::size_t avg_;
+    std::size_t min_;
+    std::size_t max_;
+    std::uint64_t mask_small_;   ///< Used before the average size: harder to match
+    std::uint64_t mask_large_;   ///< Used after it: easier to match
+
+public:
+    /**
+     * @brief Creates a chunker.
+     * @param average Target chunk size.
+     * @throws std::runtime_error if @p average is not a power of two in range.
+     */
+    explicit FastCdc(std::size_t average = kDefaultAverage)
+        : avg_(average), min_(average / 4), max_(average * 8) {
+        if (average < kMinAverage || average > kMaxAverage || (average & (average - 1))) {
+            throw std::runtime_error("FastCdc: average chunk size must be a power of two between 1 KiB and 256 KiB");
+        }
+        unsigned bits = 0;
+        while ((std::size_t(1) << bits) < average) ++bits;
+        mask_small_ = top_bits(bits + 2);
+        mask_large_ = top_bits(bits - 2);
+    }
+
+    std::size_t average_size() const { return avg_; }
+    std::size_t min_size() const { return min_; }
+    std::size_t max_size() const { return max_; }
+
+    /**
+     * @brief Returns the length of the chunk starting at @p data.
+     * @details With fewer than max_size() bytes available the result may
+     * be the whole input; callers that have more data coming should pass
+     * at least max_size() bytes unless the input is final.
+     */
+    std::size_t cut(std::string_view data) const {
+        std::size_t n = data.size();
+        if (n <= min_) return n;
+        if (n > max_) n = max_;
+        std::size_t normal = n < avg_ ? n : avg_;
+
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(data.data());
+        const std::array<std::uint64_t, 256>& g = gear();
+        std::uint64_t fp = 0;
+        std::size_t i = min_;
+        for (; i < normal; ++i) {
+            fp = (fp << 1) + g[p[i]];
+            if (!(fp & mask_small_)) return i + 1;
+        }
+        for (; i < n; ++i) {
+            fp = (fp << 1) + g[p[i]];
+            if (!(fp & mask_large_)) return i + 1;
+        }
+        return n;
+    }
+};
+
+} // namespace core
@@ -0,0 +1,458 @@
+/**
+ * @file CommitGraph.h
+ * @brief Compact, persisted commit DAG with generation numbers.
+ *
+ * @details Each known commit gets a dense position. Parents are stored as
+ * positions as well, so ancestry walks never decode commit objects. The
+ * generation of a commit is 1 for a root and otherwise 1 + the largest
+ * parent generation; an ancestor always has a strictly smaller generation
+ * than its descendants, which lets walks skip whole regions of history.
+ *
+ * File layout (little-endian): "TRICGR01", u32 commit count, then per commit
+ * in position order `[ObjectId][u32 parent1][u32 parent2][u32 generation]
+ * [u64 time]`, followed by the SHA-256 of everything before it. Parents
+ * always precede their children.
+ *
+ * Nodes are append-only and never move, so the graph can hand out views
+ * (snapshot()) that other threads read while commits are being added.
+ * Walks mark commits in a per-thread array that is reset by bumping an
+ * epoch, so a query costs what it visits, not the length of history.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.3
+ * @date 2026-10-14
+ * @lastModified 2026-10-14
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include "BinaryIO.h"
+#include "../data_structures/AppendOnlyArray.h"
+#include "../entities/Commit.h"
+#include "../entities/ObjectId.h"
+#include "../crypto/Sha256.h"
+
+namespace core {
+
+class CommitGraph;
+
+/**
+ * @brief Read-only view of the first size() commits of a CommitGraph.
+ * * Every query of CommitGraph is answered here
+ * * A copy taken with CommitGraph::snapshot() shares the graph's storage and
+ *   stays valid and unchanged while the graph keeps growing, even when it is
+ *   used from other threads
+ */
+class CommitGraphView {
+public:
+    static constexpr std::uint32_t kNone = 0xffffffffu;
+
+protected:
+    struct Node {
+        entities::ObjectId id;
+        std::uint32_t parent1 = kNone;
+        std::uint32_t parent2 = kNone;
+        std::uint32_t generation = 1;
+        std::uint64_t time = 0;
+    };
+
+    using Nodes = data_structures::AppendOnlyArray<Node>;
+
+    /**
+     * @brief Commit id → position, open-addressed over the node array.
+     * @details Slots hold position + 1 (0 = empty) and are written once, by
+     * the appending thread; readers probe concurrently and ignore positions
+     * not below their own size. The graph replaces a full index with a
+     * larger copy, so older views keep probing the table they started with.
+     */
+    class PositionIndex {
+    private:
+        std::unique_ptr<std::atomic<std::uint32_t>[]> slots_;
+        std::size_t mask_;
+        std::size_t used_ = 0;
+
+    public:
+        explicit PositionIndex(std::size_t expected) {
+            std::size_t capacity = 64;
+            while (capacity < 2 * expected) capacity *= 2;
+            slots_.reset(new std::atomic<std::uint32_t>[capacity]);
+            for (std::size_t i = 0; i < capacity; ++i) slots_[i].store(0, std::memory_order_relaxed);
+            mask_ = capacity - 1;
+        }
+
+        bool full() const { return 2 * (used_ + 1) > mask_ + 1; }
+
+        void insert(const entities::ObjectId& id, std::uint32_t pos) {
+            std::size_t i = id.hash() & mask_;
+            while (slots_[i].load(std::memory_order_relaxed) != 0) i = (i + 1) & mask_;
+            slots_[i].store(pos + 1, std::memory_order_release);
+            ++used_;
+        }
+
+        std::uint32_t find(const entities::ObjectId& id, const Nodes& nodes, std::size_t count) const {
+            for (std::size_t i = id.hash() & mask_;; i = (i + 1) & mask_) {
+                std::uint32_t slot = slots_[i].load(std::memory_order_acquire);
+                if (slot == 0) return kNone;
+                if (slot - 1 < count && nodes[slot - 1].id == id) return slot - 1;
+            }
+        }
+    };
+
+    std::shared_ptr<Nodes> nodes_ = std::make_shared<Nodes>();
+    std::shared_ptr<PositionIndex> index_ = std::make_shared<PositionIndex>(0);
+    std::size_t count_ = 0;
+
+    const Node& node(std::uint32_t pos) const { return (*nodes_)[pos]; }
+
+    /**
+     * @brief Visit marks of one thread's walks, cleared in O(1).
+     * @details A mark counts only if it carries the current epoch, so
+     * start() clears every mark by bumping the epoch. The array grows to the
+     * largest graph the thread has walked and is reused by later walks.
+     */
+    class Marks {
+    private:
+        struct Mark {
+            std::uint32_t epoch = 0;
+            char flags = 0;
+        };
+        std::vector<Mark> marks_;
+        std::uint32_t epoch_ = 0;
+
+    public:
+        /**
+         * @brief Clears every mark and makes room for @p count positions.
+         */
+        void start(std::size_t count) {
+            if (marks_.size() < count) marks_.resize(count);
+            if (++epoch_ == 0) {   // wrapped: old stamps could look current
+                std::fill(marks_.begin(), marks_.end(), Mark());
+                epoch_ = 1;
+            }
+        }
+
+        char get(std::uint32_t pos) const { return marks_[pos].epoch == epoch_ ? marks_[pos].flags : 0; }
+        void set(std::uint32_t pos, char flags) { marks_[pos] = Mark{epoch_, flags}; }
+    };
+
+    /**
+     * @brief Returns the calling thread's marks, cleared for @p count positions.
+     * @details Walks do not nest, so one set per thread suffices.
+     */
+    static Marks& fresh_marks(std::size_t count) {
+        thread_local Marks marks;
+        marks.start(count);
+        return marks;
+    }
+
+public:
+    /**
+     * @brief Returns the position of a commit, or kNone if it is not indexed.
+     */
+    std::uint32_t find(const entities::ObjectId& id) const { return index_->find(id, *nodes_, count_); }
+
+    std::size_t size() const { return count_; }
+    const entities::ObjectId& id(std::uint32_t pos) const { return node(pos).id; }
+    std::uint32_t parent1(std::uint32_t pos) const { return node(pos).parent1; }
+    std::uint32_t parent2(std::uint32_t pos) const { return node(pos).parent2; }
+    std::uint32_t generation(std::uint32_t pos) const { return node(pos).generation; }
+    std::uint64_t time(std::uint32_t pos) const { return node(pos).time; }
+
+    /**
+     * @brief Checks whether @p ancestor is reachable from @p descendant
+     * (a commit counts as its own ancestor).
+     * @details Commits with a generation below that of @p ancestor cannot
+     * lead to it and are never expanded.
+     */
+    bool is_ancestor(std::uint32_t ancestor, std::uint32_t descendant) const {
+        if (ancestor == kNone || descendant == kNone) return false;
+        const std::uint32_t floor = node(ancestor).generation;
+
+        Marks& seen = fresh_marks(count_);
+        std::vector<std::uint32_t> stack{descendant};
+        seen.set(descendant, 1);
+        while (!stack.empty()) {
+            std::uint32_t pos = stack.back();
+            stack.pop_back();
+            if (pos == ancestor) return true;
+            for (std::uint32_t p : {node(pos).parent1, node(pos).parent2}) {
+                if (p != kNone && !seen.get(p) && node(p).generation >= floor) {
+                    seen.set(p, 1);
+                    stack.push_back(p);
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Finds every best common ancestor of two commits.
+     *
+     * @details Both tips are painted at once: commits are taken from a queue
+     * in decreasing generation order (then time), each carrying the marks of
+     * the sides that reached it. Every child of a commit has a larger
+     * generation, so a commit's marks are final when it is taken. A commit
+     * reached from both sides is a merge base; it and everything below it
+     * become stale, since no ancestor of a merge base can be a best one. The
+     * walk ends as soon as only stale commits are queued, so its cost follows
+     * the divergence of the two tips rather than the length of history.
+     *
+     * With criss-cross merges there can be several best common ancestors,
+     * none of which descends from another.
+     *
+     * @return Merge bases ordered by decreasing generation, then time; empty
+     * if the histories are disjoint.
+     */
+    std::vector<std::uint32_t> merge_bases(std::uint32_t a, std::uint32_t b) const {
+        std::vector<std::uint32_t> result;
+        if (a == kNone || b == kNone) return result;
+        if (a == b) {
+            result.push_back(a);
+            return result;
+        }
+
+        enum : char { kFromA = 1, kFromB = 2, kStale = 4 };
+        Marks& marks = fresh_marks(count_);
+        auto later_first = [this](std::uint32_t x, std::uint32_t y) {
+            if (node(x).generation != node(y).generation) return node(x).generation < node(y).generation;
+            return node(x).time < node(y).time;
+        };
+        std::priority_queue<std::uint32_t, std::vector<std::uint32_t>, decltype(later_first)> queue(later_first);
+
+        std::size_t active = 0;   // queued commits that are not stale
+        auto paint = [&](std::uint32_t pos, char flags) {
+            char old = marks.get(pos);
+            if ((old & flags) == flags) return;
+            bool was_active = old && !(old & kStale);
+            if (!old) queue.push(pos);
+            marks.set(pos, old | flags);
+            bool is_active = !((old | flags) & kStale);
+            if (is_active && !was_active) ++active;
+            if (!is_active && was_active) --active;
+        };
+
+        paint(a, kFromA);
+        paint(b, kFromB);
+        while (active > 0) {
+            std::uint32_t pos = queue.top();
+            queue.pop();
+            char flags = marks.get(pos) & (kFromA | kFromB | kStale);
+            if (!(flags & kStale)) --active;
+
+            if (flags == (kFromA | kFromB)) {
+                marks.set(pos, flags | kStale);
+                result.push_back(pos);
+                flags |= kStale;
+            }
+            for (std::uint32_t p : {node(pos).parent1, node(pos).parent2}) {
+                if (p != kNone) paint(p, flags);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Finds a best common ancestor of two commits.
+     * @return The first of merge_bases(), or kNone if the histories are disjoint.
+     */
+    std::uint32_t merge_base(std::uint32_t a, std::uint32_t b) const {
+        std::vector<std::uint32_t> bases = merge_bases(a, b);
+        return bases.empty() ? kNone : bases.front();
+    }
+};
+
+/**
+ * @brief Commit ancestry indexed by position.
+ * * Lookups of a commit's position are O(1); parent and generation access
+ *   are array reads
+ * * is_ancestor() and merge_bases() visit only commits whose generation is at
+ *   least that of the answer, instead of the whole history
+ * * Nodes are only ever appended, so snapshot() is O(1) and never copies
+ */
+class CommitGraph : public CommitGraphView {
+private:
+    static constexpr char kMagic[8] = {'T', 'R', 'I', 'C', 'G', 'R', '0', '1'};
+
+    std::size_t saved_count_ = 0;   ///< Nodes already on disk
+
+    std::uint32_t append(const entities::Commit* c, std::uint32_t p1, std::uint32_t p2) {
+        Node n;
+        n.id = c->get_id();
+        n.parent1 = p1;
+        n.parent2 = p2;
+        n.time = static_cast<std::uint64_t>(c->get_time());
+        std::uint32_t g = 0;
+        if (p1 != kNone) g = node(p1).generation;
+        if (p2 != kNone && node(p2).generation > g) g = node(p2).generation;
+        n.generation = g + 1;
+        return push(n);
+    }
+
+    std::uint32_t push(const Node& n) {
+        std::uint32_t pos = static_cast<std::uint32_t>(nodes_->push_back(n));
+        count_ = nodes_->size();
+        if (index_->full()) {
+            // Views keep the old table; new ones get a copy with room to grow.
+            auto bigger = std::make_shared<PositionIndex>(2 * count_);
+            for (std::uint32_t i = 0; i < pos; ++i) bigger->insert(node(i).id, i);
+            index_ = std::move(bigger);
+        }
+        index_->insert(n.id, pos);
+        return pos;
+    }
+
+    /**
+     * @brief Starts over with empty storage, leaving views of the old one intact.
+     */
+    void reset_storage(std::size_t expected) {
+        nodes_ = std::make_shared<Nodes>();
+        index_ = std::make_shared<PositionIndex>(expected);
+        count_ = 0;
+    }
+
+public:
+    /**
+     * @brief Returns a view of the graph as it is now.
+     * @details The view may be read from any thread while this graph keeps
+     * appending commits (or is cleared); it never sees later changes.
+     */
+    CommitGraphView snapshot() const { return *this; }
+
+    /**
+     * @brief Returns the position of @p commit, indexing it and any
+     * unindexed ancestors first.
+     * @details Parents are resolved through the commits themselves, so this
+     * loads history only the first time an old repository is indexed.
+     */
+    std::uint32_t ensure(entities::Commit* commit) {
+        if (!commit) return kNone;
+        std::uint32_t known = find(commit->get_id());
+        if (known != kNone) return known;
+
+        std::vector<entities::Commit*> stack{commit};
+        while (!stack.empty()) {
+            entities::Commit* c = stack.back();
+            if (find(c->get_id()) != kNone) {
+                stack.pop_back();
+                continue;
+            }
+            entities::Commit* p1 = c->get_parent1();
+            entities::Commit* p2 = c->get_parent2();
+            std::uint32_t i1 = p1 ? find(p1->get_id()) : kNone;
+            std::uint32_t i2 = p2 ? find(p2->get_id()) : kNone;
+            if (p1 && i1 == kNone) {
+                stack.push_back(p1);
+                continue;
+            }
+            if (p2 && i2 == kNone) {
+                stack.push_back(p2);
+                continue;
+            }
+            append(c, i1, i2);
+            stack.pop_back();
+        }
+        return find(commit->get_id());
+    }
+
+    /**
+     * @brief Forgets every commit; the next save() rewrites the file.
+     * @details Used after garbage collection, when the surviving commits are
+     * re-indexed with ensure() and receive new positions.
+     */
+    void clear() {
+        reset_storage(0);
+        saved_count_ = static_cast<std::size_t>(-1);
+    }
+
+    /**
+     * @brief Writes the graph atomically if commits were added since the last save.
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void save(const std::string& path) {
+        if (saved_count_ == count_) return;
+
+        std::string out(kMagic, sizeof(kMagic));
+        out.reserve(sizeof(kMagic) + 4 + count_ * (entities::ObjectId::size() + 20) + 32);
+        binary_io::put_u32(out, static_cast<std::uint32_t>(count_));
+        for (std::uint32_t pos = 0; pos < count_; ++pos) {
+            const Node& n = node(pos);
+            out.append(reinterpret_cast<const char*>(n.id.data()), entities::ObjectId::size());
+            binary_io::put_u32(out, n.parent1);
+            binary_io::put_u32(out, n.parent2);
+            binary_io::put_u32(out, n.generation);
+            binary_io::put_u64(out, n.time);
+        }
+        crypto::Digest sum = crypto::Sha256::hash(out);
+        out.append(reinterpret_cast<const char*>(sum.bytes.data()), sum.bytes.size());
+
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+            if (!f || !f.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+                throw std::runtime_error("Cannot write commit graph: " + tmp);
+            }
+        }
+        if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+            throw std::runtime_error("Cannot replace commit graph: " + path);
+        }
+        saved_count_ = count_;
+    }
+
+    /**
+     * @brief Loads the graph; a missing or damaged file leaves it empty.
+     * @details The graph can always be rebuilt from the commits, so
+     * corruption is not an error.
+     */
+    void load(const std::string& path) {
+        reset_storage(0);
+        saved_count_ = 0;
+
+        std::ifstream f(path, std::ios::binary);
+        if (!f) return;
+        std::string data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+        const std::size_t sum_size = crypto::Digest::kSize;
+        if (data.size() < sizeof(kMagic) + 4 + sum_size ||
+            std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+            return;
+        }
+        std::string_view body(data.data(), data.size() - sum_size);
+        crypto::Digest sum = crypto::Sha256::hash(body);
+        if (std::memcmp(sum.bytes.data(), data.data() + body.size(), sum_size) != 0) return;
+
+        try {
+            binary_io::ByteReader in(body.data() + sizeof(kMagic), body.size() - sizeof(kMagic));
+            std::uint32_t count = in.u32();
+            reset_storage(std::min<std::size_t>(count, body.size() / (entities::ObjectId::size() + 20)));
+            for (std::uint32_t i = 0; i < count; ++i) {
+                Node n;
+                n.id = entities::ObjectId::from_bytes(in.raw(entities::ObjectId::size()));
+                n.parent1 = in.u32();
+                n.parent2 = in.u32();
+                n.generation = in.u32();
+                n.time = in.u64();
+                if ((n.parent1 != kNone && n.parent1 >= i) || (n.parent2 != kNone && n.parent2 >= i)) {
+                    throw std::runtime_error("parent after child");
+                }
+                push(n);
+            }
+        } catch (const std::runtime_error&) {
+            reset_storage(0);
+            return;
+        }
+        saved_count_ = count_;
+    }
+};
+
+} // namespace core
@@ -0,0 +1,394 @@
+/**
+ * @file Compression.h
+ * @brief Fast LZ77 block codec for stored objects, with optional dictionaries.
+ *
+ * @details The block format follows LZ4: a stream of sequences, each made of
+ * a token byte (high nibble literal length, low nibble match length - 4),
+ * optional length extension bytes (runs of 255), the literals, a 16-bit
+ * little-endian match offset and optional match length extension bytes. The
+ * final sequence carries literals only.
+ *
+ * A dictionary is a byte string that conceptually precedes every block, so
+ * matches may reach back into it. Repositories made of many small, similar
+ * files compress far better with one because each file alone is too short
+ * to contain repeats.
+ *
+ * Content too large to hold in memory is compressed as a sequence of
+ * frames, each an independent block of at most kFrameSize input bytes:
+ * `[u32 raw size][u32 packed size][bytes]`, where a packed size of 0 means
+ * the frame is stored uncompressed. Frames are produced one at a time, so
+ * the writer needs memory proportional to one frame only.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.2
+ * @date 2026-10-14
+ * @lastModified 2026-10-14
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include "BinaryIO.h"
+#include "../data_structures/HashTable.h"
+
+namespace core {
+
+/**
+ * @brief Encoding applied to a stored object payload.
+ */
+enum class Codec : std::uint8_t {
+    NONE = 0,
+    LZ = 1,
+    DELTA = 2,      ///< Delta against another stored blob (see DeltaCodec)
+    LZ_FRAMES = 3,  ///< Sequence of independently compressed frames (see LzCodec::append_frame())
+    CHUNKED = 4     ///< List of content-defined chunks stored as separate objects (see ObjectStore)
+};
+
+/**
+ * @brief LZ4-style block compressor and decompressor.
+ * * Level 1 probes a single hash slot and skips ahead faster over
+ *   incompressible data; each further level doubles the match-chain depth
+ *   (level 9 searches 256 candidates) for a smaller output
+ * * Decompression speed does not depend on the level
+ */
+class LzCodec {
+public:
+    static constexpr int kMinLevel = 1;
+    static constexpr int kMaxLevel = 9;
+    static constexpr std::size_t kMaxOffset = 65535;
+    static constexpr std::size_t kMaxDictionary = 32 * 1024;   ///< Leaves half the window for the data itself
+    static constexpr std::size_t kFrameSize = 1u << 20;        ///< Largest input of one frame
+    static constexpr std::size_t kFrameHeader = 8;
+
+private:
+    static constexpr std::size_t kMinMatch = 4;
+    static constexpr int kHashBits = 16;
+
+    static std::uint32_t read32(const unsigned char* p) {
+        std::uint32_t v;
+        std::memcpy(&v, p, 4);
+        return v;
+    }
+
+    static std::uint32_t hash4(std::uint32_t v) {
+        return (v * 2654435761u) >> (32 - kHashBits);
+    }
+
+    static void put_length(std::string& out, std::size_t len) {
+        while (len >= 255) {
+            out.push_back(static_cast<char>(255));
+            len -= 255;
+        }
+        out.push_back(static_cast<char>(len));
+    }
+
+    static void emit(std::string& out, const unsigned char* lit, std::size_t lit_len,
+                     std::size_t offset, std::size_t match_len) {
+        std::size_t m = match_len ? match_len - kMinMatch : 0;
+        out.push_back(static_cast<char>(((lit_len < 15 ? lit_len : 15) << 4) | (m < 15 ? m : 15)));
+        if (lit_len >= 15) put_length(out, lit_len - 15);
+        out.append(reinterpret_cast<const char*>(lit), lit_len);
+        if (match_len == 0) return;
+        out.push_back(static_cast<char>(offset & 0xff));
+        out.push_back(static_cast<char>(offset >> 8));
+        if (m >= 15) put_length(out, m - 15);
+    }
+
+    static std::size_t read_length(const unsigned char*& ip, const unsigned char* end) {
+        std::size_t len = 0;
+        unsigned char b;
+        do {
+            if (ip == end) throw std::runtime_error("LzCodec: truncated length");
+            b = *ip++;
+            len += b;
+        } while (b == 255);
+        return len;
+    }
+
+public:
+    /**
+     * @brief Compresses @p src.
+     *
+     * @param src Bytes to compress.
+     * @param level Effort from kMinLevel to kMaxLevel (clamped).
+     * @param dict Optional dictionary; only its last kMaxDictionary bytes are used.
+     * @return Compressed block.
+     */
+    static std::string compress(std::string_view src, int level = kMinLevel, std::string_view dict = {}) {
+        level = std::clamp(level, kMinLevel, kMaxLevel);
+        if (dict.size() > kMaxDictionary) dict = dict.substr(dict.size() - kMaxDictionary);
+
+        // Matching runs over dict + src so dictionary bytes are ordinary history.
+        std::string joined;
+        const unsigned char* base;
+        std::size_t start = dict.size();
+        if (dict.empty()) {
+            base = reinterpret_cast<const unsigned char*>(src.data());
+        } else {
+            joined.reserve(dict.size() + src.size());
+            joined.append(dict).append(src);
+            base = reinterpret_cast<const unsigned char*>(joined.data());
+        }
+        const std::size_t n = start + src.size();
+
+        std::string out;
+        out.reserve(src.size() / 2 + 16);
+
+        const std::size_t depth = std::size_t(1) << (level - 1);
+        std::vector<std::int32_t> head(std::size_t(1) << kHashBits, -1);
+        std::vector<std::int32_t> prev(depth > 1 ? n : 0, -1);
+
+        auto insert = [&](std::size_t pos) {
+            std::uint32_t h = hash4(read32(base + pos));
+            if (depth > 1) prev[pos] = head[h];
+            head[h] = static_cast<std::int32_t>(pos);
+        };
+
+        if (n >= kMinMatch) {
+            for (std::size_t p = 0; p + kMinMatch <= start; ++p) insert(p);
+        }
+
+        std::size_t anchor = start;
+        std::size_t pos = start;
+        std::size_t misses = 0;
+        while (pos + kMinMatch <= n) {
+            std::uint32_t cur = read32(base + pos);
+            std::int32_t cand = head[hash4(cur)];
+
+            std::size_t best_len = 0, best_off = 0;
+            for (std::size_t tries = 0; cand >= 0 && tries < depth; ++tries) {
+                std::size_t c = static_cast<std::size_t>(cand);
+                if (pos - c > kMaxOffset) break;
+                if (read32(base + c) == cur) {
+                    std::size_t len = kMinMatch;
+                    while (pos + len < n && base[c + len] == base[pos + len]) ++len;
+                    if (len > best_len) {
+                        best_len = len;
+                        best_off = pos - c;
+                        if (pos + len == n) break;
+                    }
+                }
+                if (depth == 1) break;
+                cand = prev[c];
+            }
+
+            if (best_len < kMinMatch) {
+                insert(pos);
+                // At level 1, step faster through data that keeps missing.
+                pos += (depth == 1) ? 1 + (misses++ >> 5) : 1;
+                continue;
+            }
+
+            emit(out, base + anchor, pos - anchor, best_off, best_len);
+            std::size_t end = pos + best_len;
+            if (depth > 1) {
+                for (std::size_t p = pos; p < end && p + kMinMatch <= n; ++p) insert(p);
+            } else {
+                insert(pos);
+                if (end >= 2 && end - 2 > pos && end - 2 + kMinMatch <= n) insert(end - 2);
+            }
+            pos = anchor = end;
+            misses = 0;
+        }
+
+        emit(out, base + anchor, n - anchor, 0, 0);
+        return out;
+    }
+
+    /**
+     * @brief Decompresses a block produced by compress().
+     *
+     * @param src Compressed block.
+     * @param raw_size Exact decompressed size.
+     * @param dict The dictionary the block was compressed with, if any.
+     * @param[out] out Receives the decompressed bytes.
+     * @throws std::runtime_error if the block is corrupt or does not decode
+     * to exactly @p raw_size bytes.
+     */
+    static void decompress(std::string_view src, std::size_t raw_size, std::string_view dict, std::string& out) {
+        out.clear();
+        out.resize(raw_size);
+        decode_block(src, dict, reinterpret_cast<unsigned char*>(&out[0]), raw_size);
+    }
+
+    /**
+     * @brief Compresses one frame of @p chunk and appends it to @p out.
+     * @details The frame is stored uncompressed if compression does not
+     * make it smaller.
+     * @param chunk At most kFrameSize bytes.
+     * @throws std::runtime_error if @p chunk is larger than a frame.
+     */
+    static void append_frame(std::string& out, std::string_view chunk, int level, std::string_view dict = {}) {
+        if (chunk.size() > kFrameSize) throw std::runtime_error("LzCodec: frame too large");
+        std::string packed = compress(chunk, level, dict);
+        bool keep = packed.size() < chunk.size();
+        binary_io::put_u32(out, static_cast<std::uint32_t>(chunk.size()));
+        binary_io::put_u32(out, keep ? static_cast<std::uint32_t>(packed.size()) : 0);
+        out.append(keep ? std::string_view(packed) : chunk);
+    }
+
+    /**
+     * @brief Decodes a sequence of frames written by append_frame().
+     * @throws std::runtime_error if a frame is corrupt or the frames do not
+     * add up to exactly @p raw_size bytes.
+     */
+    static void decompress_frames(std::string_view src, std::size_t raw_size, std::string_view dict, std::string& out) {
+        out.clear();
+        out.resize(raw_size);
+        std::size_t produced = 0;
+        while (!src.empty()) {
+            if (src.size() < kFrameHeader) throw std::runtime_error("LzCodec: truncated frame header");
+            const unsigned char* h = reinterpret_cast<const unsigned char*>(src.data());
+            std::size_t raw = binary_io::load_u32(h);
+            std::size_t packed = binary_io::load_u32(h + 4);
+            std::size_t stored = packed ? packed : raw;
+            if (raw > kFrameSize || raw > raw_size - produced || stored > src.size() - kFrameHeader) {
+                throw std::runtime_error("LzCodec: frame out of bounds");
+            }
+            std::string_view body = src.substr(kFrameHeader, stored);
+            unsigned char* op = reinterpret_cast<unsigned char*>(&out[0]) + produced;
+            if (packed) decode_block(body, dict, op, raw);
+            else if (raw) std::memcpy(op, body.data(), raw);
+            produced += raw;
+            src.remove_prefix(kFrameHeader + stored);
+        }
+        if (produced != raw_size) throw std::runtime_error("LzCodec: size mismatch");
+    }
+
+private:
+    /**
+     * @brief Decodes one block into exactly @p raw_size bytes at @p op.
+     */
+    static void decode_block(std::string_view src, std::string_view dict, unsigned char* op, std::size_t raw_size) {
+        if (dict.size() > kMaxDictionary) dict = dict.substr(dict.size() - kMaxDictionary);
+
+        unsigned char* const ostart = op;
+        unsigned char* const oend = op + raw_size;
+        const unsigned char* ip = reinterpret_cast<const unsigned char*>(src.data());
+        const unsigned char* const iend = ip + src.size();
+        const unsigned char* const dstart = reinterpret_cast<const unsigned char*>(dict.data());
+
+        for (;;) {
+            if (ip == iend) throw std::runtime_error("LzCodec: truncated block");
+            unsigned token = *ip++;
+
+            std::size_t lit = token >> 4;
+            if (lit == 15) lit += read_length(ip, iend);
+            if (static_cast<std::size_t>(iend - ip) < lit || static_cast<std::size_t>(oend - op) < lit) {
+                throw std::runtime_error("LzCodec: literal run out of bounds");
+            }
+            std::memcpy(op, ip, lit);
+            op += lit;
+            ip += lit;
+
+            if (ip == iend) break;
+
+            if (iend - ip < 2) throw std::runtime_error("LzCodec: truncated offset");
+            std::size_t offset = ip[0] | (static_cast<std::size_t>(ip[1]) << 8);
+            ip += 2;
+            std::size_t len = (token & 15);
+            if (len == 15) len += read_length(ip, iend);
+            len += kMinMatch;
+
+            std::size_t produced = static_cast<std::size_t>(op - ostart);
+            if (offset == 0 || offset > produced + dict.size() || static_cast<std::size_t>(oend - op) < len) {
+                throw std::runtime_error("LzCodec: match out of bounds");
+            }
+
+            if (offset > produced) {
+                // Leading part of the match lies in the dictionary.
+                std::size_t from_dict = std::min(len, offset - produced);
+                std::memcpy(op, dstart + dict.size() - (offset - produced), from_dict);
+                op += from_dict;
+                len -= from_dict;
+            }
+            const unsigned char* match = op - offset;
+            if (offset >= len) {
+                std::memcpy(op, match, len);
+                op += len;
+            } else {
+                while (len--) *op++ = *match++;   // overlapping copy repeats the pattern
+            }
+        }
+
+        if (op != oend) throw std::runtime_error("LzCodec: size mismatch");
+    }
+
+public:
+    /**
+     * @brief Builds a dictionary from representative samples.
+     *
+     * @details Every sample is cut into fixed-size segments, and each segment
+     * is scored by how many samples contain its 8-byte substrings. The
+     * best-scoring distinct segments are kept, with the most useful placed
+     * last so they are reached with the shortest offsets.
+     *
+     * @param samples Contents of typical objects.
+     * @param capacity Maximum dictionary size (at most kMaxDictionary).
+     * @return Dictionary bytes; empty if the samples share nothing.
+     */
+    static std::string train_dictionary(const std::vector<std::string_view>& samples,
+                                         std::size_t capacity = 16 * 1024) {
+        constexpr std::size_t kGram = 8;
+        constexpr std::size_t kSegment = 64;
+        capacity = std::min(capacity, kMaxDictionary);
+
+        // Number of distinct samples each 8-gram appears in.
+        data_structures::HashTable<std::string_view, std::uint32_t> freq;
+        data_structures::HashTable<std::string_view, std::size_t> seen_in;
+        for (std::size_t s = 0; s < samples.size(); ++s) {
+            std::string_view sample = samples[s];
+            for (std::size_t i = 0; i + kGram <= sample.size(); ++i) {
+                std::string_view g = sample.substr(i, kGram);
+                std::size_t* last = seen_in.find(g);
+                if (last && *last == s + 1) continue;
+                if (last) *last = s + 1;
+                else seen_in.put(g, s + 1);
+                if (std::uint32_t* f = freq.find(g)) ++*f;
+                else freq.put(g, 1);
+            }
+        }
+
+        struct Segment {
+            std::string_view bytes;
+            std::uint64_t score;
+        };
+        std::vector<Segment> segments;
+        for (std::string_view sample : samples) {
+            for (std::size_t i = 0; i + kGram <= sample.size(); i += kSegment) {
+                std::string_view seg = sample.substr(i, std::min(kSegment, sample.size() - i));
+                std::uint64_t score = 0;
+                for (std::size_t j = 0; j + kGram <= seg.size(); ++j) {
+                    std::uint32_t f = *freq.find(seg.substr(j, kGram));
+                    if (f > 1) score += f - 1;   // a gram seen in one sample only helps nobody else
+                }
+                if (score > 0) segments.push_back(Segment{seg, score});
+            }
+        }
+        std::stable_sort(segments.begin(), segments.end(),
+            [](const Segment& a, const Segment& b) { return a.score > b.score; });
+
+        std::vector<std::string_view> chosen;
+        data_structures::HashTable<std::string_view, bool> taken;
+        std::size_t total = 0;
+        for (const Segment& seg : segments) {
+            if (total + seg.bytes.size() > capacity) continue;
+            if (!taken.insert(seg.bytes, true)) continue;
+            chosen.push_back(seg.bytes);
+            total += seg.bytes.size();
+        }
+
+        std::string dict;
+        dict.reserve(total);
+        for (auto it = chosen.rbegin(); it != chosen.rend(); ++it) dict.append(*it);
+        return dict;
+    }
+};
+
+} // namespace core
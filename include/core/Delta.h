@@ -0,0 +1,171 @@
+/**
+ * @file Delta.h
+ * @brief Copy/insert delta encoding of one blob against another.
+ *
+ * @details A delta is a sequence of instructions that rebuild the target
+ * from the base:
+ * - `0x00 [varint len] [len bytes]` inserts literal bytes
+ * - `0x01 [varint offset] [varint len]` copies @c len bytes of the base
+ *   starting at @c offset
+ *
+ * Varints are little-endian base-128. Matches are found by indexing the
+ * base in 16-byte blocks and sliding a rolling hash over the target, so
+ * encoding is linear in the size of both inputs.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.0
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace core {
+
+/**
+ * @brief Computes and applies binary deltas.
+ */
+class DeltaCodec {
+private:
+    static constexpr std::size_t kBlock = 16;
+    static constexpr std::uint32_t kBase = 0x01000193u;
+    static constexpr unsigned char kInsert = 0;
+    static constexpr unsigned char kCopy = 1;
+
+    static void put_varint(std::string& out, std::uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<char>((v & 0x7f) | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<char>(v));
+    }
+
+    static std::uint64_t read_varint(const unsigned char*& p, const unsigned char* end) {
+        std::uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p == end) throw std::runtime_error("DeltaCodec: truncated varint");
+            unsigned char b = *p++;
+            v |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        throw std::runtime_error("DeltaCodec: varint too long");
+    }
+
+    static std::uint32_t block_hash(const unsigned char* p) {
+        std::uint32_t h = 0;
+        for (std::size_t i = 0; i < kBlock; ++i) h = h * kBase + p[i];
+        return h;
+    }
+
+    static void put_insert(std::string& out, const unsigned char* p, std::size_t len) {
+        if (len == 0) return;
+        out.push_back(static_cast<char>(kInsert));
+        put_varint(out, len);
+        out.append(reinterpret_cast<const char*>(p), len);
+    }
+
+public:
+    /**
+     * @brief Encodes @p target as a delta against @p base.
+     * @param limit Give up once the delta would exceed this size (0 = no limit).
+     * @return Delta bytes, or an empty string if it exceeded @p limit.
+     */
+    static std::string encode(std::string_view base, std::string_view target, std::size_t limit = 0) {
+        const auto* b = reinterpret_cast<const unsigned char*>(base.data());
+        const auto* t = reinterpret_cast<const unsigned char*>(target.data());
+        const std::size_t bn = base.size(), tn = target.size();
+
+        std::string out;
+        if (tn == 0) return out;
+        if (bn < kBlock || tn < kBlock) {
+            put_insert(out, t, tn);
+            return (limit && out.size() > limit) ? std::string() : out;
+        }
+
+        std::size_t buckets = 1;
+        while (buckets < bn / kBlock * 2) buckets <<= 1;
+        const std::size_t mask = buckets - 1;
+        std::vector<std::int64_t> index(buckets, -1);
+        // Walk backwards so the earliest occurrence of a block wins.
+        for (std::size_t k = bn / kBlock; k-- > 0;) {
+            index[block_hash(b + k * kBlock) & mask] = static_cast<std::int64_t>(k * kBlock);
+        }
+
+        std::uint32_t drop = 1;   // kBase^(kBlock-1), weight of the byte leaving the window
+        for (std::size_t i = 1; i < kBlock; ++i) drop *= kBase;
+
+        std::size_t pending = 0;   // start of the literal run not yet emitted
+        std::size_t i = 0;
+        std::uint32_t h = block_hash(t);
+        while (i + kBlock <= tn) {
+            std::int64_t cand = index[h & mask];
+            if (cand >= 0 && std::memcmp(b + cand, t + i, kBlock) == 0) {
+                std::size_t bo = static_cast<std::size_t>(cand), to = i;
+                while (bo > 0 && to > pending && b[bo - 1] == t[to - 1]) {
+                    --bo;
+                    --to;
+                }
+                std::size_t len = i - to + kBlock;
+                while (bo + len < bn && to + len < tn && b[bo + len] == t[to + len]) ++len;
+
+                put_insert(out, t + pending, to - pending);
+                out.push_back(static_cast<char>(kCopy));
+                put_varint(out, bo);
+                put_varint(out, len);
+                if (limit && out.size() > limit) return std::string();
+
+                i = pending = to + len;
+                if (i + kBlock <= tn) h = block_hash(t + i);
+                continue;
+            }
+            if (i + kBlock < tn) h = (h - t[i] * drop) * kBase + t[i + kBlock];
+            ++i;
+        }
+        put_insert(out, t + pending, tn - pending);
+        return (limit && out.size() > limit) ? std::string() : out;
+    }
+
+    /**
+     * @brief Rebuilds the target from @p base and @p delta.
+     * @param raw_size Exact size of the target.
+     * @param[out] out Receives the target.
+     * @throws std::runtime_error if the delta is corrupt or does not
+     * produce exactly @p raw_size bytes.
+     */
+    static void apply(std::string_view base, std::string_view delta, std::size_t raw_size, std::string& out) {
+        out.clear();
+        out.reserve(raw_size);
+        const auto* p = reinterpret_cast<const unsigned char*>(delta.data());
+        const auto* end = p + delta.size();
+
+        while (p < end) {
+            unsigned char op = *p++;
+            if (op == kInsert) {
+                std::uint64_t len = read_varint(p, end);
+                if (len > static_cast<std::uint64_t>(end - p) || out.size() + len > raw_size) {
+                    throw std::runtime_error("DeltaCodec: insert out of bounds");
+                }
+                out.append(reinterpret_cast<const char*>(p), static_cast<std::size_t>(len));
+                p += len;
+            } else if (op == kCopy) {
+                std::uint64_t off = read_varint(p, end);
+                std::uint64_t len = read_varint(p, end);
+                if (off > base.size() || len > base.size() - off || out.size() + len > raw_size) {
+                    throw std::runtime_error("DeltaCodec: copy out of bounds");
+                }
+                out.append(base.data() + off, static_cast<std::size_t>(len));
+            } else {
+                throw std::runtime_error("DeltaCodec: unknown instruction");
+            }
+        }
+        if (out.size() != raw_size) throw std::runtime_error("DeltaCodec: size mismatch");
+    }
+};
+
+} // namespace core
@@ -0,0 +1,365 @@
+/**
+ * @file Diff.h
+ * @brief Line-based diff engine (Myers, linear space) and unified output.
+ *
+ * @details Texts are split into lines that keep their terminating newline,
+ * so a missing newline at the end of a file is an ordinary difference. Each
+ * distinct line is interned to a dense integer id, and the diff itself only
+ * compares ids.
+ *
+ * The shortest edit script is found with Myers' O(ND) algorithm in its
+ * linear-space form: the middle snake of the edit graph is located by
+ * searching from both corners at once, and the two halves are diffed
+ * recursively. Lines that occur on only one side can never match, so they
+ * are marked as changed up front and left out of the search. When the edit
+ * distance of a region gets very large, the search settles for the furthest
+ * point reached instead of the optimal split, which bounds the cost of
+ * diffing unrelated files.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.0
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "../data_structures/HashTable.h"
+
+namespace core {
+
+/**
+ * @brief Lines of a text with their interned ids.
+ */
+struct LineSeq {
+    std::vector<std::string_view> lines;   ///< Views into the original text, newline included
+    std::vector<std::uint32_t> ids;        ///< Equal lines have equal ids
+};
+
+/**
+ * @brief Assigns the same dense id to equal lines across several texts.
+ * * Texts passed to split() must outlive the table and the returned views
+ */
+class LineTable {
+private:
+    data_structures::HashTable<std::string_view, std::uint32_t> ids_;
+
+public:
+    /**
+     * @brief Splits @p text into lines and interns each of them.
+     */
+    LineSeq split(std::string_view text) {
+        LineSeq seq;
+        std::size_t start = 0;
+        while (start < text.size()) {
+            std::size_t nl = text.find('\n', start);
+            std::size_t end = (nl == std::string_view::npos) ? text.size() : nl + 1;
+            std::string_view line = text.substr(start, end - start);
+
+            const std::uint32_t* known = ids_.find(line);
+            std::uint32_t id = known ? *known : static_cast<std::uint32_t>(ids_.size());
+            if (!known) ids_.put(line, id);
+
+            seq.lines.push_back(line);
+            seq.ids.push_back(id);
+            start = end;
+        }
+        return seq;
+    }
+
+    /**
+     * @brief Returns one more than the largest id handed out so far.
+     */
+    std::uint32_t size() const { return static_cast<std::uint32_t>(ids_.size()); }
+};
+
+/**
+ * @brief A maximal run of changed lines: `a[a_begin, a_end)` is replaced
+ * by `b[b_begin, b_end)`. Either range may be empty.
+ */
+struct DiffHunk {
+    std::size_t a_begin = 0;
+    std::size_t a_end = 0;
+    std::size_t b_begin = 0;
+    std::size_t b_end = 0;
+};
+
+/**
+ * @brief Computes and prints line diffs.
+ * * hunks() returns the changed regions in order; the lines between two
+ *   hunks are equal on both sides
+ * * Memory use is linear in the number of lines
+ */
+class LineDiff {
+private:
+    static constexpr std::int64_t kMinCost = 256;   ///< Edit distance searched exactly in any region
+
+    const std::vector<std::uint32_t>& a_;
+    const std::vector<std::uint32_t>& b_;
+    std::vector<std::uint32_t> fa_, fb_;   ///< Lines that occur on both sides
+    std::vector<std::size_t> ma_, mb_;     ///< Positions of fa_/fb_ in a_/b_
+    std::vector<char> ca_, cb_;            ///< Changed flags of a_/b_
+    std::vector<std::int64_t> v1_, v2_;    ///< Furthest x per diagonal, forward and backward
+    std::int64_t max_cost_ = kMinCost;
+
+    LineDiff(const std::vector<std::uint32_t>& a, const std::vector<std::uint32_t>& b) : a_(a), b_(b) {}
+
+    void mark_a(std::size_t x0, std::size_t x1) { for (std::size_t x = x0; x < x1; ++x) ca_[ma_[x]] = 1; }
+    void mark_b(std::size_t y0, std::size_t y1) { for (std::size_t y = y0; y < y1; ++y) cb_[mb_[y]] = 1; }
+
+    /**
+     * @brief Finds a point on a shortest edit path through
+     * `fa_[x0, x1)` × `fb_[y0, y1)`.
+     * @return False if the two ranges share no line at all.
+     */
+    bool bisect(std::size_t x0, std::size_t x1, std::size_t y0, std::size_t y1,
+                std::size_t& split_x, std::size_t& split_y) {
+        const std::int64_t n = static_cast<std::int64_t>(x1 - x0);
+        const std::int64_t m = static_cast<std::int64_t>(y1 - y0);
+        const std::int64_t max_d = (n + m + 1) / 2;
+        const std::int64_t offset = max_d;
+        const std::int64_t length = 2 * max_d + 2;
+        const std::int64_t delta = n - m;
+        const bool front = (delta % 2) != 0;   // odd delta: paths meet during a forward step
+
+        v1_.assign(static_cast<std::size_t>(length), -1);
+        v2_.assign(static_cast<std::size_t>(length), -1);
+        v1_[offset + 1] = 0;
+        v2_[offset + 1] = 0;
+
+        const std::uint32_t* a = fa_.data() + x0;
+        const std::uint32_t* b = fb_.data() + y0;
+        std::int64_t k1start = 0, k1end = 0, k2start = 0, k2end = 0;
+        std::int64_t best_x = 0, best_y = 0;
+
+        for (std::int64_t d = 0; d < max_d; ++d) {
+            for (std::int64_t k1 = -d + k1start; k1 <= d - k1end; k1 += 2) {
+                const std::int64_t i1 = offset + k1;
+                std::int64_t x = (k1 == -d || (k1 != d && v1_[i1 - 1] < v1_[i1 + 1])) ? v1_[i1 + 1] : v1_[i1 - 1] + 1;
+                std::int64_t y = x - k1;
+                while (x < n && y < m && a[x] == b[y]) {
+                    ++x;
+                    ++y;
+                }
+                v1_[i1] = x;
+                if (x > n) {
+                    k1end += 2;        // ran off the right edge
+                } else if (y > m) {
+                    k1start += 2;      // ran off the bottom edge
+                } else {
+                    if (x + y > best_x + best_y) {
+                        best_x = x;
+                        best_y = y;
+                    }
+                    if (front) {
+                        const std::int64_t i2 = offset + delta - k1;
+                        if (i2 >= 0 && i2 < length && v2_[i2] != -1 && x >= n - v2_[i2]) {
+                            split_x = x0 + static_cast<std::size_t>(x);
+                            split_y = y0 + static_cast<std::size_t>(y);
+                            return true;
+                        }
+                    }
+                }
+            }
+
+            for (std::int64_t k2 = -d + k2start; k2 <= d - k2end; k2 += 2) {
+                const std::int64_t i2 = offset + k2;
+                std::int64_t x = (k2 == -d || (k2 != d && v2_[i2 - 1] < v2_[i2 + 1])) ? v2_[i2 + 1] : v2_[i2 - 1] + 1;
+                std::int64_t y = x - k2;
+                while (x < n && y < m && a[n - x - 1] == b[m - y - 1]) {
+                    ++x;
+                    ++y;
+                }
+                v2_[i2] = x;
+                if (x > n) {
+                    k2end += 2;
+                } else if (y > m) {
+                    k2start += 2;
+                } else if (!front) {
+                    const std::int64_t i1 = offset + delta - k2;
+                    if (i1 >= 0 && i1 < length && v1_[i1] != -1) {
+                        const std::int64_t fx = v1_[i1];
+                        const std::int64_t fy = fx - (i1 - offset);
+                        if (fx >= n - x) {
+                            split_x = x0 + static_cast<std::size_t>(fx);
+                            split_y = y0 + static_cast<std::size_t>(fy);
+                            return true;
+                        }
+                    }
+                }
+            }
+
+            if (d + 1 >= max_cost_ && best_x + best_y > 0) {
+                // Too expensive to finish exactly: split where the forward search got furthest.
+                split_x = x0 + static_cast<std::size_t>(best_x);
+                split_y = y0 + static_cast<std::size_t>(best_y);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void compare(std::size_t x0, std::size_t x1, std::size_t y0, std::size_t y1) {
+        while (x0 < x1 && y0 < y1 && fa_[x0] == fb_[y0]) {
+            ++x0;
+            ++y0;
+        }
+        while (x0 < x1 && y0 < y1 && fa_[x1 - 1] == fb_[y1 - 1]) {
+            --x1;
+            --y1;
+        }
+        if (x0 == x1 || y0 == y1) {
+            mark_a(x0, x1);
+            mark_b(y0, y1);
+            return;
+        }
+
+        std::size_t x = 0, y = 0;
+        bool split = bisect(x0, x1, y0, y1, x, y);
+        if (!split || (x == x0 && y == y0) || (x == x1 && y == y1)) {
+            mark_a(x0, x1);
+            mark_b(y0, y1);
+            return;
+        }
+        compare(x0, x, y0, y);
+        compare(x, x1, y, y1);
+    }
+
+    std::vector<DiffHunk> run() {
+        std::uint32_t top = 0;
+        for (std::uint32_t id : a_) top = std::max(top, id + 1);
+        for (std::uint32_t id : b_) top = std::max(top, id + 1);
+        std::vector<char> in_a(top, 0), in_b(top, 0);
+        for (std::uint32_t id : a_) in_a[id] = 1;
+        for (std::uint32_t id : b_) in_b[id] = 1;
+
+        ca_.assign(a_.size(), 0);
+        cb_.assign(b_.size(), 0);
+        for (std::size_t i = 0; i < a_.size(); ++i) {
+            if (!in_b[a_[i]]) {
+                ca_[i] = 1;
+                continue;
+            }
+            fa_.push_back(a_[i]);
+            ma_.push_back(i);
+        }
+        for (std::size_t j = 0; j < b_.size(); ++j) {
+            if (!in_a[b_[j]]) {
+                cb_[j] = 1;
+                continue;
+            }
+            fb_.push_back(b_[j]);
+            mb_.push_back(j);
+        }
+
+        const double diagonals = static_cast<double>(fa_.size() + fb_.size() + 3);
+        max_cost_ = std::max(kMinCost, static_cast<std::int64_t>(std::sqrt(diagonals)));
+        compare(0, fa_.size(), 0, fb_.size());
+
+        std::vector<DiffHunk> hunks;
+        std::size_t i = 0, j = 0;
+        while (i < a_.size() || j < b_.size()) {
+            if (i < a_.size() && j < b_.size() && !ca_[i] && !cb_[j]) {
+                ++i;
+                ++j;
+                continue;
+            }
+            DiffHunk h;
+            h.a_begin = i;
+            h.b_begin = j;
+            while (i < a_.size() && ca_[i]) ++i;
+            while (j < b_.size() && cb_[j]) ++j;
+            h.a_end = i;
+            h.b_end = j;
+            hunks.push_back(h);
+        }
+        return hunks;
+    }
+
+    static void put_line(std::string& out, char tag, std::string_view line) {
+        out.push_back(tag);
+        out.append(line);
+        if (line.empty() || line.back() != '\n') out.append("\n\\ No newline at end of file\n");
+    }
+
+    static void put_range(std::string& out, std::size_t begin, std::size_t count) {
+        // 1-based start; an empty range names the line before it.
+        out.append(std::to_string(count == 0 ? begin : begin + 1));
+        if (count != 1) out.append(",").append(std::to_string(count));
+    }
+
+public:
+    /**
+     * @brief Computes the changed regions between two line sequences.
+     * @param a Ids of the old lines.
+     * @param b Ids of the new lines (from the same LineTable).
+     * @return Hunks ordered by position; empty if the sequences are equal.
+     */
+    static std::vector<DiffHunk> hunks(const std::vector<std::uint32_t>& a, const std::vector<std::uint32_t>& b) {
+        LineDiff diff(a, b);
+        return diff.run();
+    }
+
+    /**
+     * @brief Checks whether content looks binary (a NUL in its first 8 KiB).
+     */
+    static bool is_binary(std::string_view text) {
+        return text.substr(0, 8192).find('\0') != std::string_view::npos;
+    }
+
+    /**
+     * @brief Formats two texts as a unified diff.
+     * @param old_text Old content.
+     * @param new_text New content.
+     * @param old_label Name after `---` (e.g. "a/path" or "/dev/null").
+     * @param new_label Name after `+++`.
+     * @param context Unchanged lines shown around each change.
+     * @return The diff, or an empty string if the texts are equal.
+     */
+    static std::string unified(std::string_view old_text, std::string_view new_text,
+                               const std::string& old_label, const std::string& new_label,
+                               std::size_t context = 3) {
+        LineTable table;
+        LineSeq a = table.split(old_text);
+        LineSeq b = table.split(new_text);
+        std::vector<DiffHunk> hs = hunks(a.ids, b.ids);
+        if (hs.empty()) return std::string();
+
+        std::string out = "--- " + old_label + "\n+++ " + new_label + "\n";
+        std::size_t h = 0;
+        while (h < hs.size()) {
+            // Hunks separated by at most 2 * context equal lines share one block.
+            std::size_t last = h;
+            while (last + 1 < hs.size() && hs[last + 1].a_begin - hs[last].a_end <= 2 * context) ++last;
+
+            std::size_t lead = std::min(context, hs[h].a_begin);
+            std::size_t trail = std::min(context, a.lines.size() - hs[last].a_end);
+            std::size_t a_begin = hs[h].a_begin - lead, a_end = hs[last].a_end + trail;
+            std::size_t b_begin = hs[h].b_begin - lead, b_end = hs[last].b_end + trail;
+
+            out.append("@@ -");
+            put_range(out, a_begin, a_end - a_begin);
+            out.append(" +");
+            put_range(out, b_begin, b_end - b_begin);
+            out.append(" @@\n");
+
+            std::size_t pos = a_begin;
+            for (std::size_t k = h; k <= last; ++k) {
+                for (; pos < hs[k].a_begin; ++pos) put_line(out, ' ', a.lines[pos]);
+                for (std::size_t x = hs[k].a_begin; x < hs[k].a_end; ++x) put_line(out, '-', a.lines[x]);
+                for (std::size_t y = hs[k].b_begin; y < hs[k].b_end; ++y) put_line(out, '+', b.lines[y]);
+                pos = hs[k].a_end;
+            }
+            for (; pos < a_end; ++pos) put_line(out, ' ', a.lines[pos]);
+            h = last + 1;
+        }
+        return out;
+    }
+};
+
+} // namespace core
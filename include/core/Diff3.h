@@ -0,0 +1,154 @@
+/**
+ * @file Diff3.h
+ * @brief Line-level three-way merge of text files.
+ *
+ * @details Both sides are diffed against the base with LineDiff. Hunks of
+ * the two diffs that overlap or touch in the base form one region; a region
+ * changed by one side only takes that side, a region both sides changed
+ * identically takes the shared result, and anything else is a conflict
+ * written between markers:
+ *
+ *     <<<<<<< HEAD
+ *     our lines
+ *     =======
+ *     their lines
+ *     >>>>>>> label
+ *
+ * Lines at the start or end of a conflict that both sides share are moved
+ * out of the markers. Lines outside every region are the same on all three
+ * versions and are copied from the base.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.0
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include "Diff.h"
+
+namespace core {
+
+/**
+ * @brief Outcome of a three-way text merge.
+ */
+struct Diff3Result {
+    std::string text;            ///< Merged content, with conflict markers if any
+    std::size_t conflicts = 0;   ///< Number of conflicting regions
+};
+
+/**
+ * @brief diff3-style merge that resolves non-overlapping changes.
+ */
+class Diff3 {
+private:
+    /**
+     * @brief Lines of one side covering the base range `[lo, hi)` of a region.
+     * @param hs Hunks of that side against the base.
+     * @param first,last Hunks of the side inside the region (first == last: none).
+     */
+    static void side_range(const std::vector<DiffHunk>& hs, std::size_t first, std::size_t last,
+                           std::size_t lo, std::size_t hi, std::size_t& begin, std::size_t& end) {
+        if (first == last) {
+            // Unchanged on this side, so the base lines map one to one.
+            std::ptrdiff_t shift = 0;
+            if (first > 0) {
+                shift = static_cast<std::ptrdiff_t>(hs[first - 1].b_end) - static_cast<std::ptrdiff_t>(hs[first - 1].a_end);
+            }
+            begin = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(lo) + shift);
+            end = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(hi) + shift);
+            return;
+        }
+        begin = hs[first].b_begin - (hs[first].a_begin - lo);
+        end = hs[last - 1].b_end + (hi - hs[last - 1].a_end);
+    }
+
+    static void append_lines(std::string& out, const LineSeq& seq, std::size_t begin, std::size_t end,
+                             bool terminate = false) {
+        for (std::size_t i = begin; i < end; ++i) out.append(seq.lines[i]);
+        if (terminate && end > begin && seq.lines[end - 1].back() != '\n') out.push_back('\n');
+    }
+
+    static bool same_lines(const LineSeq& x, std::size_t xb, std::size_t xe,
+                           const LineSeq& y, std::size_t yb, std::size_t ye) {
+        return xe - xb == ye - yb && std::equal(x.ids.begin() + xb, x.ids.begin() + xe, y.ids.begin() + yb);
+    }
+
+public:
+    /**
+     * @brief Merges @p ours and @p theirs, both derived from @p base.
+     * @param base Common ancestor content (empty for files added on both sides).
+     * @param ours Content on the current branch.
+     * @param theirs Content being merged in.
+     * @param their_label Text after the closing `>>>>>>>` marker.
+     * @return Merged text and the number of conflicting regions.
+     */
+    static Diff3Result merge(std::string_view base, std::string_view ours, std::string_view theirs,
+                             const std::string& their_label) {
+        LineTable table;
+        LineSeq b = table.split(base);
+        LineSeq o = table.split(ours);
+        LineSeq t = table.split(theirs);
+        std::vector<DiffHunk> ho = LineDiff::hunks(b.ids, o.ids);
+        std::vector<DiffHunk> ht = LineDiff::hunks(b.ids, t.ids);
+
+        Diff3Result result;
+        result.text.reserve(std::max(ours.size(), theirs.size()));
+        std::size_t io = 0, it = 0, pos = 0;
+
+        while (io < ho.size() || it < ht.size()) {
+            bool ours_first = it == ht.size() || (io < ho.size() && ho[io].a_begin <= ht[it].a_begin);
+            const std::size_t lo = ours_first ? ho[io].a_begin : ht[it].a_begin;
+            std::size_t hi = lo;
+            const std::size_t o_first = io, t_first = it;
+
+            // Grow the region until no hunk of either side overlaps or touches it.
+            for (bool grew = true; grew;) {
+                grew = false;
+                if (io < ho.size() && ho[io].a_begin <= hi) {
+                    hi = std::max(hi, ho[io++].a_end);
+                    grew = true;
+                }
+                if (it < ht.size() && ht[it].a_begin <= hi) {
+                    hi = std::max(hi, ht[it++].a_end);
+                    grew = true;
+                }
+            }
+
+            append_lines(result.text, b, pos, lo);
+            pos = hi;
+
+            std::size_t ob, oe, tb, te;
+            side_range(ho, o_first, io, lo, hi, ob, oe);
+            side_range(ht, t_first, it, lo, hi, tb, te);
+
+            if (t_first == it) {
+                append_lines(result.text, o, ob, oe);
+            } else if (o_first == io || same_lines(o, ob, oe, t, tb, te)) {
+                append_lines(result.text, t, tb, te);
+            } else {
+                // Lines both sides agree on at the edges stay outside the markers.
+                std::size_t head = 0, tail = 0;
+                while (ob + head < oe && tb + head < te && o.ids[ob + head] == t.ids[tb + head]) ++head;
+                while (oe - tail > ob + head && te - tail > tb + head && o.ids[oe - tail - 1] == t.ids[te - tail - 1]) ++tail;
+
+                ++result.conflicts;
+                append_lines(result.text, o, ob, ob + head);
+                result.text.append("<<<<<<< HEAD\n");
+                append_lines(result.text, o, ob + head, oe - tail, true);
+                result.text.append("=======\n");
+                append_lines(result.text, t, tb + head, te - tail, true);
+                result.text.append(">>>>>>> ").append(their_label).append("\n");
+                append_lines(result.text, o, oe - tail, oe);
+            }
+        }
+        append_lines(result.text, b, pos, b.lines.size());
+        return result;
+    }
+};
+
+} // namespace core
@@ -0,0 +1,90 @@
+/**
+ * @file FileStat.h
+ * @brief Cached file-system metadata used to detect unchanged files.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.0
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <sys/stat.h>
+#include "BinaryIO.h"
+
+namespace core {
+
+/**
+ * @brief Subset of stat(2) data compared to decide whether a file changed.
+ * * A default-constructed FileStat is "unknown" and never matches
+ * * If the size, modification time, change time and inode are all equal, the
+ *   file is assumed unchanged and is not re-read or rehashed
+ */
+struct FileStat {
+    std::int64_t mtime_ns = 0;
+    std::int64_t ctime_ns = 0;
+    std::uint64_t size = 0;
+    std::uint64_t ino = 0;
+    std::uint32_t mode = 0;
+
+    /**
+     * @brief Reads metadata for a path (symlinks are not followed).
+     * @param path File path.
+     * @param[out] out Receives the metadata.
+     * @return False if the file does not exist or cannot be examined.
+     */
+    static bool from_path(const std::string& path, FileStat& out) {
+        struct stat st;
+        if (::lstat(path.c_str(), &st) != 0) return false;
+        out = from_stat(st);
+        return true;
+    }
+
+    /**
+     * @brief Converts an already obtained stat buffer.
+     */
+    static FileStat from_stat(const struct stat& st) {
+        FileStat out;
+        out.mtime_ns = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+        out.ctime_ns = static_cast<std::int64_t>(st.st_ctim.tv_sec) * 1000000000 + st.st_ctim.tv_nsec;
+        out.size = static_cast<std::uint64_t>(st.st_size);
+        out.ino = static_cast<std::uint64_t>(st.st_ino);
+        out.mode = static_cast<std::uint32_t>(st.st_mode);
+        return out;
+    }
+
+    bool is_known() const { return mtime_ns != 0 || ino != 0; }
+
+    bool matches(const FileStat& o) const {
+        return is_known() && mtime_ns == o.mtime_ns && ctime_ns == o.ctime_ns &&
+               size == o.size && ino == o.ino && mode == o.mode;
+    }
+
+    /**
+     * @brief Appends the 36-byte on-disk form.
+     */
+    void encode(std::string& out) const {
+        binary_io::put_u64(out, static_cast<std::uint64_t>(mtime_ns));
+        binary_io::put_u64(out, static_cast<std::uint64_t>(ctime_ns));
+        binary_io::put_u64(out, size);
+        binary_io::put_u64(out, ino);
+        binary_io::put_u32(out, mode);
+    }
+
+    /**
+     * @brief Reads the on-disk form written by encode().
+     */
+    static FileStat decode(binary_io::ByteReader& in) {
+        FileStat st;
+        st.mtime_ns = static_cast<std::int64_t>(in.u64());
+        st.ctime_ns = static_cast<std::int64_t>(in.u64());
+        st.size = in.u64();
+        st.ino = in.u64();
+        st.mode = in.u32();
+        return st;
+    }
+};
+
+} // namespace core
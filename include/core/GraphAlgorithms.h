@@ -4,9 +4,9 @@
  *
  * @author Umut Ertuğrul Daşgın
  * @note Documentation maintained by Deniz Kayra Aydın / Ömer Kağan Zafer.
- * @version 1.1
+ * @version 1.2
  * @date 2025-12-25
- * @lastModified 2026-01-10
+ * @lastModified 2026-10-14
  */
 
 
@@ -14,9 +14,9 @@
 
 #include <string>
 #include "../data_structures/Stack.h"
-#include "../data_structures/Queue.h"
 #include "../data_structures/HashTable.h"
 #include "../entities/Commit.h"
+#include "../entities/ObjectId.h"
 
 namespace core {
 
@@ -24,6 +24,7 @@ namespace core {
  * @brief Static utility algorithms for commit graphs.
  * * Operates on commit DAG structures
  * * Contains no state and owns no memory
+ * * Merge-base and reachability queries are answered by CommitGraph
  */
 class GraphAlgorithms {
 public:
@@ -41,7 +42,7 @@ public:
 
         if (!start) return history;
 
-        data_structures::HashTable<std::string, bool> visited;
+        data_structures::HashTable<entities::ObjectId, bool> visited;
         data_structures::Stack<entities::Commit*> st;
 
         st.push(start);
@@ -54,97 +55,18 @@ public:
             history.push(curr);
 
             if (curr->get_parent1()) {
-                std::string p1_id = curr->get_parent1()->get_id();
-                if (!visited.contains(p1_id)) {
-                    st.push(curr->get_parent1());
-                    visited.put(p1_id, true);
-                }
+                const entities::ObjectId& p1_id = curr->get_parent1()->get_id();
+                if (visited.insert(p1_id, true)) st.push(curr->get_parent1());
             }
 
             if (curr->get_parent2()) {
-                std::string p2_id = curr->get_parent2()->get_id();
-                if (!visited.contains(p2_id)) {
-                    st.push(curr->get_parent2());
-                    visited.put(p2_id, true);
-                }
+                const entities::ObjectId& p2_id = curr->get_parent2()->get_id();
+                if (visited.insert(p2_id, true)) st.push(curr->get_parent2());
             }
         }
 
         return history;
     }
-
-    /**
-     * @brief Finds the nearest common ancestor of two commits.
-     * @param c1 First commit.
-     * @param c2 Second commit.
-     * @return Merge base commit or nullptr.
-     */
-    static entities::Commit*
-    find_merge_base(entities::Commit* c1, entities::Commit* c2) {
-
-        if (!c1 || !c2) return nullptr;
-        if (c1->get_id() == c2->get_id()) return c1;
-
-        data_structures::HashTable<std::string, bool> ancestors1;
-        data_structures::Queue<entities::Commit*> q;
-
-        q.enqueue(c1);
-        ancestors1.put(c1->get_id(), true);
-
-        while (!q.empty()) {
-            entities::Commit* curr = q.front();
-            q.dequeue();
-
-            if (curr->get_parent1()) {
-                std::string p1 = curr->get_parent1()->get_id();
-                if (!ancestors1.contains(p1)) {
-                    ancestors1.put(p1, true);
-                    q.enqueue(curr->get_parent1());
-                }
-            }
-
-            if (curr->get_parent2()) {
-                std::string p2 = curr->get_parent2()->get_id();
-                if (!ancestors1.contains(p2)) {
-                    ancestors1.put(p2, true);
-                    q.enqueue(curr->get_parent2());
-                }
-            }
-        }
-
-        data_structures::Queue<entities::Commit*> q2;
-        data_structures::HashTable<std::string, bool> visited2;
-
-        q2.enqueue(c2);
-        visited2.put(c2->get_id(), true);
-
-        while (!q2.empty()) {
-            entities::Commit* curr = q2.front();
-            q2.dequeue();
-
-            if (ancestors1.contains(curr->get_id())) {
-                return curr;
-            }
-
-            if (curr->get_parent1()) {
-                std::string p1 = curr->get_parent1()->get_id();
-                if (!visited2.contains(p1)) {
-                    visited2.put(p1, true);
-                    q2.enqueue(curr->get_parent1());
-                }
-            }
-
-            if (curr->get_parent2()) {
-                std::string p2 = curr->get_parent2()->get_id();
-                if (!visited2.contains(p2)) {
-                    visited2.put(p2, true);
-                    q2.enqueue(curr->get_parent2());
-                }
-            }
-        }
-
-        return nullptr;
-    }
 };
 
 } // namespace core
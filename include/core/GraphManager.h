@@ -2,66 +2,453 @@
  * @file GraphManager.h
  * @brief Manages the storage and lifecycle of commit objects and blob data.
  * @details Responsible for owning dynamically allocated commits, indexing them for 
- * fast retrieval, and handling deduplicated content storage.
+ * fast retrieval, and handling deduplicated content storage. Commits and blobs
+ * are persisted through an ObjectStore; commits are loaded lazily on lookup.
+ * Blob content may be stored compressed or as a delta against an earlier
+ * version, and is decoded only when read. Ancestry queries are answered from
+ * a persisted commit graph with generation numbers; reachability queries
+ * use optional bitmaps for selected commits.
+ *
+ * The manager is driven by one thread. After every commit, flush and
+ * repack it publishes a ReadSnapshot, which other threads obtain with
+ * snapshot() and then query without locks (taking the snapshot briefly
+ * holds a mutex, see ReadSnapshot).
  *
  * @author Umut Ertuğrul Daşgın
  * @note Documentation maintained by Deniz Kayra Aydın.
- * @version 1.1
+ * @version 1.11
  * @date 2025-12-25
- * @lastModified 2026-01-10
+ * @lastModified 2026-10-14
  */
 
 #pragma once
 
 #include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <cstdio>
+#include "ObjectStore.h"
+#include "ReadSnapshot.h"
+#include "Stats.h"
+#include "BinaryIO.h"
+#include "MerkleTree.h"
+#include "CommitGraph.h"
+#include "BitmapIndex.h"
 #include "../data_structures/HashTable.h"
 #include "../data_structures/DoublyLinkedList.h"
 #include "../entities/Commit.h"
+#include "../entities/ObjectId.h"
 
 namespace core {
 
+/**
+ * @brief Outcome of GraphManager::repack().
+ */
+struct RepackStats {
+    std::size_t objects = 0;          ///< Objects in the new pack
+    std::size_t deltas = 0;           ///< Blobs given a delta base
+    std::uint64_t bytes_before = 0;   ///< Pack size before repacking
+    std::uint64_t bytes_after = 0;    ///< Pack size after repacking
+    std::size_t removed = 0;          ///< Unreachable objects dropped (gc only)
+};
+
 /**
  * @brief Centralized controller for commit lifecycle and content deduplication.
  * * Implements two core architectural patterns:
  * 1. Object Ownership: Managed via DoublyLinkedList to ensure safe memory deallocation.
  * 2. Content-Addressable Storage (CAS): Maps unique content hashes to data strings.
+ * * commit_map_ caches commits already loaded from (or written to) the object store
+ * * commit_graph_ indexes ancestry for merge-base and reachability queries
+ * * bitmaps_ short-cuts reachability below selected commits; loaded on first use
+ * * published_ is the latest ReadSnapshot, replaced with std::atomic_store
+ *   (guarded by a library mutex, not lock-free)
+ * * Also serves as the TreeStore for directory tree objects
  */
-class GraphManager {
+class GraphManager : public entities::CommitResolver, public TreeStore {
 private:
-    data_structures::HashTable<std::string, entities::Commit*> commit_map_;
+    ObjectStore object_store_;
+    CommitGraph commit_graph_;
+    std::string commit_graph_path_;
+    BitmapIndex bitmaps_;
+    std::string bitmaps_path_;
+    bool bitmaps_loaded_ = false;
+    data_structures::HashTable<entities::ObjectId, entities::Commit*, CountedProbes> commit_map_;
     data_structures::DoublyLinkedList<entities::Commit*> managed_commits_;
-    data_structures::HashTable<std::string, std::string> blob_storage_;
+    std::shared_ptr<const ReadSnapshot> published_;
+
+    /**
+     * @brief Makes everything stored so far visible to snapshot() readers.
+     */
+    void publish() {
+        std::atomic_store(&published_, std::shared_ptr<const ReadSnapshot>(
+            std::make_shared<ReadSnapshot>(object_store_.snapshot(), commit_graph_.snapshot())));
+    }
+
+    static void put_id(std::string& out, const entities::ObjectId& id) {
+        out.append(reinterpret_cast<const char*>(id.data()), entities::ObjectId::size());
+    }
+
+    /**
+     * @brief Serializes a commit into its object payload.
+     * @details The file list is not part of the record; it is stored once
+     * as the tree objects reachable from the root tree id.
+     */
+    static std::string encode_commit(const entities::Commit& c) {
+        std::string out;
+        binary_io::put_string(out, c.get_message());
+        binary_io::put_string(out, c.get_author());
+        binary_io::put_u64(out, static_cast<std::uint64_t>(c.get_time()));
+        put_id(out, c.get_tree_hash());
+        put_id(out, c.get_parent1_id());
+        put_id(out, c.get_parent2_id());
+        return out;
+    }
+
+    /**
+     * @brief Rebuilds a commit from its object payload.
+     */
+    entities::Commit* decode_commit(const entities::ObjectId& id, const std::string& payload) {
+        CommitInfo c = CommitInfo::decode(id, payload);
+        return new entities::Commit(id, std::move(c.message), std::move(c.author), c.time, c.tree,
+                                    c.parent1, c.parent2, this);
+    }
+
+    void cache_commit(entities::Commit* commit) {
+        commit_map_.put(commit->get_id(), commit);
+        managed_commits_.push_back(commit);
+    }
+
+    const BitmapIndex& bitmaps() {
+        if (!bitmaps_loaded_) {
+            bitmaps_.load(bitmaps_path_, commit_graph_);
+            bitmaps_loaded_ = true;
+        }
+        return bitmaps_;
+    }
+
+    entities::ObjectId root_tree(std::uint32_t pos) {
+        entities::Commit* c = get_commit(commit_graph_.id(pos));
+        if (!c) throw std::runtime_error("Missing commit object: " + commit_graph_.id(pos).to_hex());
+        return c->get_tree_hash();
+    }
+
+    std::vector<std::uint32_t> positions_of(const std::vector<entities::Commit*>& commits) {
+        std::vector<std::uint32_t> out;
+        out.reserve(commits.size());
+        for (entities::Commit* c : commits) {
+            if (c) out.push_back(commit_graph_.ensure(c));
+        }
+        return out;
+    }
+
+    ReachSet reach(const std::vector<entities::Commit*>& tips, bool with_objects) {
+        std::vector<std::uint32_t> starts = positions_of(tips);
+        return bitmaps().reach(commit_graph_, starts, with_objects, *this,
+                               [this](std::uint32_t pos) { return root_tree(pos); });
+    }
+
+    /**
+     * @brief Picks a delta base for every blob reachable from @p tips.
+     * @details Blobs are found by walking root trees, newest commit first,
+     * loading each tree id once: a subtree left unchanged by a commit was
+     * already walked for a newer one, so the walk costs one visit per
+     * distinct tree rather than one per file per commit. A blob thus gets
+     * the path and time of the newest commit holding it. Every blob is
+     * grouped with the other versions of its path, newest first, and tried
+     * against up to @p window preceding versions; it keeps the base giving
+     * the smallest delta while the chain stays within @p max_depth.
+     * @param deltas Incremented for every blob given a base.
+     * @return Blob id → chosen base.
+     */
+    data_structures::HashTable<entities::ObjectId, entities::ObjectId>
+    choose_delta_bases(const std::vector<entities::Commit*>& tips, std::size_t window, int max_depth,
+                       std::size_t& deltas) {
+        struct Version {
+            std::uint32_t path_id;
+            std::time_t time;
+            entities::ObjectId id;
+        };
+
+        data_structures::HashTable<entities::ObjectId, bool> visited;
+        std::vector<entities::Commit*> commits;
+        for (entities::Commit* c : tips) {
+            if (c && visited.insert(c->get_id(), true)) commits.push_back(c);
+        }
+        for (std::size_t i = 0; i < commits.size(); ++i) {
+            for (entities::Commit* p : {commits[i]->get_parent1(), commits[i]->get_parent2()}) {
+                if (p && visited.insert(p->get_id(), true)) commits.push_back(p);
+            }
+        }
+        std::sort(commits.begin(), commits.end(), [](const entities::Commit* a, const entities::Commit* b) {
+            if (a->get_time() != b->get_time()) return a->get_time() > b->get_time();
+            return a->get_id() < b->get_id();
+        });
+
+        entities::PathPool& paths = entities::PathPool::instance();
+        data_structures::HashTable<entities::ObjectId, bool> seen;   // trees and blobs
+        std::vector<Version> versions;
+        std::vector<std::pair<entities::ObjectId, std::string>> trees;   // id, path prefix
+        for (entities::Commit* c : commits) {
+            const entities::ObjectId& root = c->get_tree_hash();
+            if (root.is_null() || !seen.insert(root, true)) continue;
+            trees.emplace_back(root, std::string());
+            while (!trees.empty()) {
+                std::pair<entities::ObjectId, std::string> tree = std::move(trees.back());
+                trees.pop_back();
+                for (const TreeEntry& e : MerkleTree::load_entries(*this, tree.first)) {
+                    if (!seen.insert(e.id, true)) continue;
+                    if (e.is_tree()) {
+                        trees.emplace_back(e.id, tree.second + e.name + "/");
+                    } else {
+                        versions.push_back(Version{paths.intern(tree.second + e.name), c->get_time(), e.id});
+                    }
+                }
+            }
+        }
+
+        std::sort(versions.begin(), versions.end(), [&paths](const Version& a, const Version& b) {
+            if (a.path_id != b.path_id) return paths.path(a.path_id) < paths.path(b.path_id);
+            if (a.time != b.time) return a.time > b.time;
+            return a.id < b.id;
+        });
+
+        struct Candidate {
+            BlobView content;
+            entities::ObjectId id;
+            int depth;
+        };
+        data_structures::HashTable<entities::ObjectId, entities::ObjectId> bases(versions.size());
+        std::deque<Candidate> recent;
+        for (std::size_t i = 0; i < versions.size(); ++i) {
+            if (i > 0 && versions[i].path_id != versions[i - 1].path_id) recent.clear();
+
+            BlobView content = get_blob_view(versions[i].id);
+            const Candidate* best = nullptr;
+            std::size_t best_size = content.size();
+            for (const Candidate& cand : recent) {
+                if (cand.depth >= max_depth) continue;
+                std::string delta = DeltaCodec::encode(cand.content.view(), content.view(), best_size - 1);
+                if (!delta.empty() && delta.size() < best_size) {
+                    best = &cand;
+                    best_size = delta.size();
+                }
+            }
+
+            int depth = 0;
+            if (best && best_size < content.size() / 2) {
+                bases.put(versions[i].id, best->id);
+                depth = best->depth + 1;
+                ++deltas;
+            }
+            recent.push_back(Candidate{std::move(content), versions[i].id, depth});
+            if (recent.size() > window) recent.pop_front();
+        }
+
+        return bases;
+    }
 
 public:
-    GraphManager() = default;
+    /**
+     * @brief Opens the object store rooted at the given repository directory.
+     * @param repo_dir Repository metadata directory (e.g. ".tri").
+     */
+    explicit GraphManager(const std::string& repo_dir = ".tri")
+        : object_store_(repo_dir + "/objects"), commit_graph_path_(repo_dir + "/objects/commit-graph"),
+          bitmaps_path_(repo_dir + "/objects/bitmaps") {
+        commit_graph_.load(commit_graph_path_);
+        publish();
+    }
 
     /**
      * @brief Destructor ensures all managed Commit objects are properly deallocated.
      */
     ~GraphManager() {
+        try {
+            commit_graph_.save(commit_graph_path_);
+        } catch (...) {
+            // The graph is rebuilt from the commits on the next run.
+        }
         for (auto it = managed_commits_.begin(); it != managed_commits_.end(); ++it) {
             delete *it;
         }
     }
 
+    GraphManager(const GraphManager&) = delete;
+    GraphManager& operator=(const GraphManager&) = delete;
+
     /**
-     * @brief Takes ownership of a dynamically allocated Commit.
+     * @brief Takes ownership of a dynamically allocated Commit and persists it.
      * @param commit Pointer to the commit object.
      * @pre commit must not be nullptr.
      */
     void add_commit(entities::Commit* commit) {
         if (!commit) return; 
-        commit_map_.put(commit->get_id(), commit);
-        managed_commits_.push_back(commit);
+        cache_commit(commit);
+        object_store_.put(ObjectType::COMMIT, commit->get_id(), encode_commit(*commit));
+        commit_graph_.ensure(commit);
+        publish();
+    }
+
+    /**
+     * @brief Returns the latest published snapshot; safe to call from any thread.
+     * @details The snapshot reflects the last commit, flush or repack made
+     * by the owning thread. Hold it for as long as a consistent view is
+     * needed and take a new one to see later changes. std::atomic_load on a
+     * shared_ptr takes one of libstdc++'s internal mutexes for the copy, so
+     * this call is short but not lock-free; queries on the result are.
+     */
+    std::shared_ptr<const ReadSnapshot> snapshot() const { return std::atomic_load(&published_); }
+
+    /**
+     * @brief Returns the commit graph, with every commit added so far indexed.
+     */
+    const CommitGraph& commit_graph() const { return commit_graph_; }
+
+    /**
+     * @brief Checks whether @p ancestor is reachable from @p descendant.
+     * @details A commit counts as its own ancestor; nullptr is an ancestor of nothing.
+     */
+    bool is_ancestor(entities::Commit* ancestor, entities::Commit* descendant) {
+        if (!ancestor || !descendant) return false;
+        return commit_graph_.is_ancestor(commit_graph_.ensure(ancestor), commit_graph_.ensure(descendant));
+    }
+
+    /**
+     * @brief Finds every best common ancestor of two commits.
+     * @return Merge bases, best first; empty if the histories are unrelated.
+     * @see CommitGraph::merge_bases()
+     */
+    std::vector<entities::Commit*> merge_bases(entities::Commit* c1, entities::Commit* c2) {
+        Stats::ScopedTimer timer(Timer::MERGE_BASE);
+        std::vector<entities::Commit*> out;
+        if (!c1 || !c2) return out;
+        for (std::uint32_t pos : commit_graph_.merge_bases(commit_graph_.ensure(c1), commit_graph_.ensure(c2))) {
+            if (entities::Commit* c = get_commit(commit_graph_.id(pos))) out.push_back(c);
+        }
+        return out;
+    }
+
+    /**
+     * @brief Returns the CommitGraph position of a commit, indexing it if needed.
+     */
+    std::uint32_t position(entities::Commit* commit) { return commit_graph_.ensure(commit); }
+
+    /**
+     * @brief Returns the positions of every commit reachable from @p tips.
+     * @details Walks the graph down to the nearest commits with a bitmap;
+     * the result is indexed by CommitGraph position.
+     */
+    data_structures::Bitmap reachable_commits(const std::vector<entities::Commit*>& tips) {
+        return reach(tips, false).commits;
+    }
+
+    /**
+     * @brief Lists every commit, tree and blob reachable from @p tips.
+     * @throws std::runtime_error if a reachable commit or tree is missing.
+     */
+    std::vector<entities::ObjectId> reachable_objects(const std::vector<entities::Commit*>& tips) {
+        ReachSet r = reach(tips, true);
+        std::vector<entities::ObjectId> out;
+        out.reserve(r.objects.count() + r.extra_objects.size());
+        const BitmapIndex& index = bitmaps();
+        r.objects.for_each([&](std::size_t n) { out.push_back(index.object(static_cast<std::uint32_t>(n))); });
+        out.insert(out.end(), r.extra_objects.begin(), r.extra_objects.end());
+        return out;
+    }
+
+    /**
+     * @brief Rebuilds the reachability bitmaps and writes them to disk.
+     * @details Bitmaps are built for @p tips and for every 64th commit of
+     * the graph, so a walk from any commit reaches a bitmap within a few
+     * dozen steps along first parents.
+     * @return Number of commits given a bitmap.
+     * @throws std::runtime_error if an object is missing or the file cannot
+     * be written.
+     */
+    std::size_t build_bitmaps(const std::vector<entities::Commit*>& tips) {
+        std::vector<std::uint32_t> selected = positions_of(tips);
+        for (std::uint32_t pos = 63; pos < commit_graph_.size(); pos += 64) selected.push_back(pos);
+
+        bitmaps_.build(commit_graph_, selected, *this, [this](std::uint32_t pos) { return root_tree(pos); });
+        bitmaps_loaded_ = true;
+        commit_graph_.save(commit_graph_path_);   // the bitmaps refer to these positions
+        bitmaps_.save(bitmaps_path_);
+        return bitmaps_.size();
+    }
+
+    /**
+     * @brief Finds a known commit by a unique prefix of its hex id.
+     * @return The commit, or nullptr if no indexed commit matches.
+     * @throws std::runtime_error if the prefix is ambiguous.
+     */
+    entities::Commit* find_commit_by_prefix(const std::string& prefix) {
+        std::uint32_t match = CommitGraph::kNone;
+        for (std::uint32_t pos = 0; pos < commit_graph_.size(); ++pos) {
+            if (commit_graph_.id(pos).to_hex().compare(0, prefix.size(), prefix) != 0) continue;
+            if (match != CommitGraph::kNone) throw std::runtime_error("Ambiguous commit prefix: " + prefix);
+            match = pos;
+        }
+        return match == CommitGraph::kNone ? nullptr : get_commit(commit_graph_.id(match));
+    }
+
+    /**
+     * @brief Finds the nearest common ancestor of two commits.
+     * @return Best merge base, or nullptr if the histories are unrelated.
+     */
+    entities::Commit* merge_base(entities::Commit* c1, entities::Commit* c2) {
+        std::vector<entities::Commit*> bases = merge_bases(c1, c2);
+        return bases.empty() ? nullptr : bases.front();
     }
 
     /**
      * @brief Retrieves a commit using its unique identifier.
+     * @details Commits not yet in memory are loaded from the object store;
+     * their parents are resolved on first access.
      * @param id The unique hash of the commit.
      * @return Pointer to the commit if found; otherwise @c nullptr.
      */
-    entities::Commit* get_commit(const std::string& id) {
-        return commit_map_.contains(id) ? commit_map_.get(id) : nullptr;
+    entities::Commit* get_commit(const entities::ObjectId& id) {
+        if (entities::Commit** cached = commit_map_.find(id)) return *cached;
+
+        std::string payload;
+        ObjectType type;
+        if (!object_store_.get(id, payload, &type) || type != ObjectType::COMMIT) return nullptr;
+
+        entities::Commit* commit = decode_commit(id, payload);
+        cache_commit(commit);
+        return commit;
+    }
+
+    /**
+     * @brief CommitResolver hook used by lazily loaded commits.
+     */
+    entities::Commit* resolve_commit(const entities::ObjectId& id) override {
+        return get_commit(id);
+    }
+
+    /**
+     * @brief CommitResolver hook that expands a commit's root tree.
+     */
+    entities::Manifest resolve_manifest(const entities::ObjectId& tree_id) override {
+        return MerkleTree::load_manifest(*this, tree_id);
+    }
+
+    /**
+     * @brief Loads a stored tree object.
+     */
+    bool load_tree(const entities::ObjectId& id, std::string& payload) override {
+        ObjectType type;
+        return object_store_.get(id, payload, &type) && type == ObjectType::TREE;
+    }
+
+    /**
+     * @brief Stores a tree object (deduplicated by id).
+     */
+    void store_tree(const entities::ObjectId& id, const std::string& payload) override {
+        object_store_.put(ObjectType::TREE, id, payload);
     }
 
     /**
@@ -69,11 +456,189 @@ public:
      * @note If the hash already exists, the storage operation is skipped (Deduplication).
      * @param hash Unique key representing the content.
      * @param content The actual data to store.
+     * @param base Previous version of the same file, used as a delta base
+     * when that saves space (may be the null id).
+     */
+    void save_blob(const entities::ObjectId& hash, const std::string& content,
+                   const entities::ObjectId& base = entities::ObjectId()) {
+        object_store_.put(ObjectType::BLOB, hash, content, base);
+    }
+
+    /**
+     * @brief Checks whether an object is stored, without reading it.
+     */
+    bool has_object(const entities::ObjectId& id) const { return object_store_.contains(id); }
+
+    /**
+     * @brief Captures the stored objects for lookups from other threads.
+     * @see ObjectStore::snapshot()
+     */
+    ObjectStore::Snapshot object_snapshot() { return object_store_.snapshot(); }
+
+    /**
+     * @brief Starts a blob write whose encoding may run on another thread.
+     * @see ObjectStore::prepare()
      */
-    void save_blob(const std::string& hash, const std::string& content) {
-        if (!blob_storage_.contains(hash)) {
-            blob_storage_.put(hash, content);
+    PendingWrite prepare_blob(const entities::ObjectId& base = entities::ObjectId()) const {
+        return object_store_.prepare(ObjectType::BLOB, base);
+    }
+
+    /**
+     * @brief Appends encoded writes in one call; durable after flush().
+     * @see ObjectStore::write_batch()
+     */
+    void write_objects(const std::vector<PendingWrite>& batch) { object_store_.write_batch(batch); }
+
+    /**
+     * @brief Starts a blob that is written piece by piece.
+     * @see ObjectStore::BlobWriter
+     */
+    ObjectStore::BlobWriter stream_blob() { return ObjectStore::BlobWriter(object_store_); }
+
+    /**
+     * @brief Sets the longest delta chain that new blobs may create.
+     */
+    void set_max_delta_depth(int depth) { object_store_.set_max_delta_depth(depth); }
+
+    /**
+     * @brief Enables (average > 0) or disables content-defined chunking of large blobs.
+     * @see ObjectStore::set_chunking()
+     */
+    void set_chunking(std::size_t average) { object_store_.set_chunking(average); }
+
+    /**
+     * @brief Tells whether a new blob of @p size bytes would be chunked.
+     */
+    bool chunks(std::uint64_t size) const { return object_store_.chunks(size); }
+
+    /**
+     * @brief Rewrites the object store with delta bases chosen over full history.
+     *
+     * @details Every blob reachable from @p tips is grouped with the other
+     * versions of its path, newest first. Each version is tried against up
+     * to @p window preceding versions and keeps the base giving the smallest
+     * delta, provided the chain stays within @p max_depth. Newer versions
+     * therefore tend to be stored whole and read fastest.
+     *
+     * @param tips Commits whose history is examined (nullptr entries are ignored).
+     * @param window Number of candidate bases tried per blob.
+     * @param max_depth Longest delta chain allowed.
+     * @return Object and size counts.
+     */
+    RepackStats repack(const std::vector<entities::Commit*>& tips, std::size_t window, int max_depth) {
+        RepackStats stats;
+        stats.bytes_before = object_store_.pack_size();
+        data_structures::HashTable<entities::ObjectId, entities::ObjectId> bases =
+            choose_delta_bases(tips, window, max_depth, stats.deltas);
+
+        object_store_.set_max_delta_depth(max_depth);
+        stats.bytes_after = object_store_.repack(bases);
+        stats.objects = object_store_.size();
+        publish();
+        return stats;
+    }
+
+    /**
+     * @brief Drops every object unreachable from @p tips and repacks the rest.
+     *
+     * @details Reachable commits, trees and blobs are marked with
+     * reachable_objects(), so history below commits with bitmaps is not
+     * walked. The survivors, plus @p keep (e.g. staged blobs), are written to
+     * one new pack with delta bases chosen as in repack(): commits first,
+     * newest first, then trees and blobs in the order they were discovered,
+     * which groups each tree with the files below it. The commit graph is
+     * re-indexed over the surviving commits, unreachable commits are evicted
+     * from memory, and existing bitmaps are rebuilt for the new positions.
+     *
+     * @param tips Commits to keep with their history (nullptr entries are ignored).
+     * @param keep Further objects to keep if stored.
+     * @param window Number of candidate bases tried per blob.
+     * @param max_depth Longest delta chain allowed.
+     * @return Object and size counts, including the number of objects removed.
+     * @throws std::runtime_error if a reachable object is missing.
+     */
+    RepackStats gc(const std::vector<entities::Commit*>& tips, const std::vector<entities::ObjectId>& keep,
+                   std::size_t window, int max_depth) {
+        object_store_.flush();
+        const bool had_bitmaps = bitmaps().size() > 0;
+        std::vector<entities::ObjectId> live = reachable_objects(tips);
+
+        auto commits_end = std::stable_partition(live.begin(), live.end(), [this](const entities::ObjectId& id) {
+            return commit_graph_.find(id) != CommitGraph::kNone;
+        });
+        std::sort(live.begin(), commits_end, [this](const entities::ObjectId& a, const entities::ObjectId& b) {
+            return commit_graph_.find(a) > commit_graph_.find(b);
+        });
+        data_structures::HashTable<entities::ObjectId, bool> marked(live.size() + keep.size());
+        for (const auto& id : live) marked.put(id, true);
+        for (const auto& id : keep) {
+            if (object_store_.contains(id) && marked.insert(id, true)) live.push_back(id);
+        }
+
+        RepackStats stats;
+        stats.bytes_before = object_store_.pack_size();
+        std::size_t before = object_store_.size();
+        data_structures::HashTable<entities::ObjectId, entities::ObjectId> bases =
+            choose_delta_bases(tips, window, max_depth, stats.deltas);
+
+        object_store_.set_max_delta_depth(max_depth);
+        stats.bytes_after = object_store_.repack(bases, &live);
+        stats.objects = object_store_.size();
+        stats.removed = before > stats.objects ? before - stats.objects : 0;
+
+        // Positions change, so the graph and the bitmaps are rebuilt.
+        commit_graph_.clear();
+        for (entities::Commit* c : tips) commit_graph_.ensure(c);
+        data_structures::DoublyLinkedList<entities::Commit*> survivors;
+        commit_map_.clear();
+        for (auto it = managed_commits_.begin(); it != managed_commits_.end(); ++it) {
+            if (commit_graph_.find((*it)->get_id()) != CommitGraph::kNone) {
+                survivors.push_back(*it);
+                commit_map_.put((*it)->get_id(), *it);
+            } else {
+                delete *it;
+            }
+        }
+        managed_commits_ = std::move(survivors);
+        commit_graph_.save(commit_graph_path_);
+
+        if (had_bitmaps) {
+            build_bitmaps(tips);
+        } else {
+            bitmaps_.clear();
+            std::remove(bitmaps_path_.c_str());
+        }
+        publish();
+        return stats;
+    }
+
+    /**
+     * @brief Selects the codec, level and dictionary for blobs stored from now on.
+     * @see ObjectStore::set_compression()
+     */
+    void set_compression(Codec codec, int level, const entities::ObjectId& dict_id = entities::ObjectId()) {
+        object_store_.set_compression(codec, level, dict_id);
+    }
+
+    /**
+     * @brief Trains a compression dictionary from blobs and stores it.
+     * @param blob_ids Blobs to sample.
+     * @param capacity Maximum dictionary size in bytes.
+     * @return Id of the stored dictionary, or the null id if the samples
+     * had nothing in common.
+     */
+    entities::ObjectId train_dictionary(const std::vector<entities::ObjectId>& blob_ids,
+                                        std::size_t capacity = 16 * 1024) {
+        std::vector<BlobView> blobs;
+        std::vector<std::string_view> samples;
+        blobs.reserve(blob_ids.size());
+        samples.reserve(blob_ids.size());
+        for (const auto& id : blob_ids) {
+            blobs.push_back(get_blob_view(id));
+            samples.push_back(blobs.back().view());
         }
+        std::string dict = LzCodec::train_dictionary(samples, capacity);
+        return dict.empty() ? entities::ObjectId() : object_store_.put_dictionary(dict);
     }
 
     /**
@@ -81,8 +646,41 @@ public:
      * @param hash Unique key for the content.
      * @return The data string if found; otherwise an empty string.
      */
-    std::string get_blob_content(const std::string& hash) const {
-        return blob_storage_.contains(hash) ? blob_storage_.get(hash) : "";
+    std::string get_blob_content(const entities::ObjectId& hash) const {
+        std::string content;
+        return object_store_.get(hash, content) ? content : "";
+    }
+
+    /**
+     * @brief Returns a zero-copy view of stored blob content.
+     * @param hash Unique key for the content.
+     * @return View into the object store; empty if the blob is unknown.
+     */
+    BlobView get_blob_view(const entities::ObjectId& hash) const {
+        BlobView view;
+        object_store_.get_view(hash, view);
+        return view;
+    }
+
+    /**
+     * @brief Locates stored blob content without decoding it.
+     * @details The result may be opened later, on any thread.
+     * @param hash Unique key for the content.
+     * @return Packed payload; empty if the blob is unknown.
+     */
+    PackedObject get_blob_packed(const entities::ObjectId& hash) const {
+        PackedObject obj;
+        object_store_.get_packed(hash, obj);
+        return obj;
+    }
+
+    /**
+     * @brief Writes pending object index entries to disk.
+     */
+    void flush() {
+        object_store_.flush();
+        commit_graph_.save(commit_graph_path_);
+        publish();
     }
 };
 
@@ -0,0 +1,132 @@
+/**
+ * @file MappedFile.h
+ * @brief RAII wrapper around a read-only memory mapping of a file.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.1
+ * @date 2026-10-14
+ * @lastModified 2026-10-14
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace core {
+
+/**
+ * @brief Read-only, whole-file memory mapping.
+ * * Move-only; the mapping is released on destruction
+ * * An empty or missing file yields an unmapped object (data() == nullptr)
+ * * The descriptor stays open with the mapping so callers can copy ranges
+ *   of the file in-kernel
+ */
+class MappedFile {
+private:
+    void* data_;
+    std::size_t size_;
+    int fd_;
+
+public:
+    MappedFile() : data_(nullptr), size_(0), fd_(-1) {}
+
+    ~MappedFile() { reset(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+        : data_(other.data_), size_(other.size_), fd_(other.fd_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.fd_ = -1;
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this == &other) return *this;
+        reset();
+        data_ = other.data_;
+        size_ = other.size_;
+        fd_ = other.fd_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.fd_ = -1;
+        return *this;
+    }
+
+    /**
+     * @brief Maps the given file into memory.
+     * @param path File to map.
+     * @return True if the file exists, is non-empty and was mapped.
+     */
+    bool open(const std::string& path) {
+        reset();
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        return map(fd);
+    }
+
+    /**
+     * @brief Maps the file behind an already open descriptor.
+     * @details The mapping holds a duplicate of @p fd, so it always shows
+     * the file the caller opened, even after its path was replaced.
+     * @param fd Readable descriptor; not consumed.
+     * @return True if the file is non-empty and was mapped.
+     */
+    bool open(int fd) {
+        reset();
+
+        int own = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+        if (own < 0) return false;
+        return map(own);
+    }
+
+private:
+    /**
+     * @brief Maps the whole of @p fd, taking ownership of it.
+     */
+    bool map(int fd) {
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+
+        void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size),
+                         PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+
+        data_ = p;
+        size_ = static_cast<std::size_t>(st.st_size);
+        fd_ = fd;
+        return true;
+    }
+
+public:
+    /**
+     * @brief Releases the mapping and descriptor, if any.
+     */
+    void reset() noexcept {
+        if (data_) ::munmap(data_, size_);
+        if (fd_ >= 0) ::close(fd_);
+        data_ = nullptr;
+        size_ = 0;
+        fd_ = -1;
+    }
+
+    const unsigned char* data() const { return static_cast<const unsigned char*>(data_); }
+    std::size_t size() const { return size_; }
+    int fd() const { return fd_; }
+    bool is_open() const { return data_ != nullptr; }
+};
+
+} // namespace core
@@ -4,13 +4,22 @@
  *
  * @details This file contains the definition of the MergeEngine class and
  * supporting logic required to perform commit merge operations
- * within the repository system.
+ * within the repository system. When two commits have several best common
+ * ancestors (criss-cross history), those are first merged into a virtual
+ * base, as in a recursive merge. Files changed on both sides are merged
+ * line by line (see Diff3.h).
+ *
+ * The three snapshots are compared as Merkle trees, walked in lockstep: a
+ * subtree whose id is the same on two sides is resolved without being
+ * loaded, so the cost of a merge follows the directories that changed
+ * rather than the number of files. The result is the list of changes to
+ * apply to "ours".
  *
  * @author Umut Ertuğrul Daşgın
  * @note Documentation maintained by Deniz Kayra Aydın.
- * @version 1.1
+ * @version 1.5
  * @date 2025-12-25
- * @lastModified 2026-01-10
+ * @lastModified 2026-10-14
  */
 
 
@@ -18,14 +27,29 @@
 
 #include <string>
 #include <iostream> 
+#include <vector>
 #include "GraphAlgorithms.h"
 #include "GraphManager.h"
+#include "MerkleTree.h"
+#include "Diff.h"
+#include "Diff3.h"
 #include "../entities/Commit.h"
 #include "../entities/File.h"
-#include "../data_structures/DoublyLinkedList.h"
-#include "../data_structures/HashTable.h"
+#include "../entities/ObjectId.h"
+#include "../entities/Manifest.h"
 
 namespace core {
+    /**
+    * @brief One path whose merged version differs from "ours".
+    */
+    struct MergeChange {
+        std::string path;
+        entities::ObjectId id;                          ///< Merged version; null if the path is deleted
+        std::uint32_t mode = entities::kModeRegular;
+        bool merged = false;                            ///< True if content was produced by the merge
+        std::string content;                            ///< Merged content (conflict markers included), if merged
+    };
+
     /**
     * @brief Provides functionality for merging commits using a 3-way merge algorithm.
     *
@@ -46,139 +70,385 @@ namespace core {
         /**
         * @brief Merges two commits using a 3-way merge strategy.
         *
-        * @details This class provides an abstract representation of Git-like branch and HEAD management.
+        * @details The base is taken from the commit graph's best common
+        * ancestors; if there are several, they are merged into a virtual base
+        * first.
         *
         * @param[in] ours Pointer to the current branch commit.
         * @param[in] theirs Pointer to the commit being merged into the current branch.
         * @param[in] graph_mgr Reference to the GraphManager used for retrieving blob contents.
         * @param[out] out_conflict_msg Accumulates human-readable conflict descriptions.
         *
-        * @return A list of merged files representing the merge result.
+        * @return Changes that turn the snapshot of @p ours into the merge result.
         *
         * @pre ours != nullptr
         * @pre theirs != nullptr
-        * @post Returned file list represents the merged state of the two commits.
+        * @post Applying the returned changes to @p ours yields the merged state.
         */
 
-        data_structures::DoublyLinkedList<entities::File> merge_commits(
+        std::vector<MergeChange> merge_commits(
             entities::Commit* ours, 
             entities::Commit* theirs, 
             GraphManager& graph_mgr,
             std::string& out_conflict_msg) 
         {
-            data_structures::DoublyLinkedList<entities::File> result_files;
-
-            entities::Commit* base = GraphAlgorithms::find_merge_base(ours, theirs);
-            
-            auto map_ours   = create_file_map(ours);
-            auto map_theirs = create_file_map(theirs);
-            auto map_base   = create_file_map(base);
-
-            data_structures::HashTable<std::string, bool> all_paths;
-            
-            auto add_paths = [&](const data_structures::DoublyLinkedList<entities::File>& list) {
-                for(auto it = list.begin(); it != list.end(); ++it) {
-                    all_paths.put(it->get_path(), true);
+            std::vector<entities::Commit*> bases = graph_mgr.merge_bases(ours, theirs);
+            Snapshot base = base_snapshot(bases, graph_mgr, 0);
+
+            std::vector<MergeChange> changes;
+            Context ctx{graph_mgr, theirs->get_id().short_hex(), out_conflict_msg, changes};
+            merge_snapshots(bases.empty() ? nullptr : &base, snapshot_of(ours), snapshot_of(theirs), ctx);
+            return changes;
+        }
+
+    private:
+        static constexpr int kMaxVirtualDepth = 8;   ///< Deeper criss-cross nesting falls back to one base
+
+        /**
+        * @brief Files of one merge side and, if known, their root tree.
+        */
+        struct Snapshot {
+            entities::Manifest files;
+            entities::ObjectId tree;
+            bool has_tree = true;   ///< False if @c files is not described by @c tree
+        };
+
+        /**
+        * @brief Version of a path on one side (null id: absent).
+        */
+        struct Version {
+            entities::ObjectId id;
+            std::uint32_t mode = entities::kModeRegular;
+
+            bool operator==(const Version& o) const { return id == o.id && (id.is_null() || mode == o.mode); }
+            bool operator!=(const Version& o) const { return !(*this == o); }
+        };
+
+        /**
+        * @brief State shared by one merge.
+        */
+        struct Context {
+            GraphManager& graph;
+            std::string their_label;
+            std::string& conflict_msg;
+            std::vector<MergeChange>& changes;
+        };
+
+        static Snapshot snapshot_of(const entities::Commit* c) {
+            Snapshot s;
+            s.files = c->get_files();
+            s.tree = c->get_tree_hash();
+            s.has_tree = s.files.empty() || !s.tree.is_null();
+            return s;
+        }
+
+        /**
+        * @brief Builds the snapshot to use as the base of a merge.
+        *
+        * @details A single merge base is used as is. Several are folded into a
+        * virtual base by merging them pairwise, each pair against its own
+        * merge bases; conflicting paths keep their conflict text, so both
+        * versions still count as changes against the virtual base.
+        *
+        * @param[in] bases Best common ancestors, best first.
+        * @param[in] graph_mgr Provides ancestry and blob storage.
+        * @param[in] depth Current nesting of virtual bases.
+        * @return Base snapshot (empty if @p bases is empty).
+        */
+
+        static Snapshot base_snapshot(const std::vector<entities::Commit*>& bases,
+                                      GraphManager& graph_mgr, int depth) {
+            if (bases.empty()) return Snapshot();
+            if (bases.size() == 1 || depth >= kMaxVirtualDepth) return snapshot_of(bases[0]);
+
+            Snapshot merged = snapshot_of(bases[0]);
+            for (std::size_t i = 1; i < bases.size(); ++i) {
+                std::vector<entities::Commit*> inner = graph_mgr.merge_bases(bases[0], bases[i]);
+                Snapshot inner_base = base_snapshot(inner, graph_mgr, depth + 1);
+
+                std::string ignored;
+                std::vector<MergeChange> changes;
+                Context ctx{graph_mgr, "merged common ancestors", ignored, changes};
+                merge_snapshots(inner.empty() ? nullptr : &inner_base, merged, snapshot_of(bases[i]), ctx);
+
+                std::vector<entities::ManifestEntry> entries;
+                entries.reserve(changes.size());
+                for (const MergeChange& c : changes) {
+                    if (c.merged) graph_mgr.save_blob(c.id, c.content);
+                    entries.emplace_back(c.path, c.id, c.mode);
                 }
-            };
+                if (merged.has_tree) merged.tree = MerkleTree::update(graph_mgr, merged.tree, entries);
+                merged.files = merged.files.with_changes(std::move(entries));
+            }
+            return merged;
+        }
 
-            add_paths(ours->get_files());
-            add_paths(theirs->get_files());
-            if(base) add_paths(base->get_files());
+        /**
+        * @brief Three-way merge of two snapshots against a base snapshot.
+        *
+        * @details Walks the trees when all three sides have one, and falls
+        * back to comparing the manifests path by path otherwise.
+        *
+        * @param[in] base Base snapshot, or nullptr if the histories are unrelated.
+        * @param[in] ours Snapshot of the current branch.
+        * @param[in] theirs Snapshot being merged in.
+        * @param[in,out] ctx Receives changes and conflict descriptions.
+        */
 
-            const auto& our_files_list = ours->get_files();
-            for (auto it = our_files_list.begin(); it != our_files_list.end(); ++it) {
-                std::string path = it->get_path();
-                std::string hash_ours = it->get_hash();
-                
-                std::string hash_theirs = "";
-                if (map_theirs.contains(path)) hash_theirs = map_theirs.get(path);
-
-                std::string hash_base = "";
-                if (map_base.contains(path)) hash_base = map_base.get(path);
-
-                if (hash_theirs == "") {
-                    if (hash_base == "") {
-                        result_files.push_back(*it);
-                    } else if (hash_base == hash_ours) { } else {
-                        out_conflict_msg += "CONFLICT (Modify/Delete): " + path + "\n";
-                        result_files.push_back(*it);
-                    }
-                } 
-                else if (hash_ours == hash_theirs) {
-                    result_files.push_back(*it);
+        static void merge_snapshots(const Snapshot* base, const Snapshot& ours, const Snapshot& theirs,
+                                    Context& ctx) {
+            if ((!base || base->has_tree) && ours.has_tree && theirs.has_tree) {
+                merge_trees(base ? base->tree : entities::ObjectId(), ours.tree, theirs.tree, "", ctx);
+            } else {
+                merge_manifests(base ? &base->files : nullptr, ours.files, theirs.files, ctx);
+            }
+        }
+
+        /**
+        * @brief Merges three versions of a directory.
+        *
+        * @details Entries are matched by name across the three trees. An entry
+        * that is identical on two sides is settled at once, even if it is a
+        * whole subtree; only directories that differ on all three sides are
+        * loaded and walked.
+        *
+        * @param[in] base,ours,theirs Tree ids (null: the directory is absent).
+        * @param[in] prefix Path of the directory including its trailing '/'.
+        * @param[in,out] ctx Receives changes and conflict descriptions.
+        */
+
+        static void merge_trees(const entities::ObjectId& base, const entities::ObjectId& ours,
+                                const entities::ObjectId& theirs, const std::string& prefix, Context& ctx) {
+            if (ours == theirs || base == theirs) return;   // "ours" already is the result
+            if (base == ours) {
+                diff_trees(ours, theirs, prefix, ctx);
+                return;
+            }
+
+            std::vector<TreeEntry> b = MerkleTree::load_entries(ctx.graph, base);
+            std::vector<TreeEntry> o = MerkleTree::load_entries(ctx.graph, ours);
+            std::vector<TreeEntry> t = MerkleTree::load_entries(ctx.graph, theirs);
+            std::size_t ib = 0, io = 0, it = 0;
+
+            while (ib < b.size() || io < o.size() || it < t.size()) {
+                const std::string* name = nullptr;
+                for (const std::string* n : {ib < b.size() ? &b[ib].name : nullptr,
+                                             io < o.size() ? &o[io].name : nullptr,
+                                             it < t.size() ? &t[it].name : nullptr}) {
+                    if (n && (!name || *n < *name)) name = n;
+                }
+                const TreeEntry* be = (ib < b.size() && b[ib].name == *name) ? &b[ib] : nullptr;
+                const TreeEntry* oe = (io < o.size() && o[io].name == *name) ? &o[io] : nullptr;
+                const TreeEntry* te = (it < t.size() && t[it].name == *name) ? &t[it] : nullptr;
+                std::string path = prefix + *name;
+                if (be) ++ib;
+                if (oe) ++io;
+                if (te) ++it;
+
+                if (same(oe, te) || same(be, te)) continue;
+                if (same(be, oe)) {
+                    take_theirs(oe, te, path, ctx);
+                    continue;
                 }
-                else {
-                    if (hash_ours == hash_base) {
-                        entities::File file_from_theirs(path, "");
-                        file_from_theirs.set_hash_manual(hash_theirs);
-                        result_files.push_back(file_from_theirs);
-                    }
-                    else if (hash_theirs == hash_base) {
-                        result_files.push_back(*it);
-                    }
-                    else {
-                        out_conflict_msg += "CONFLICT (Content): " + path + "\n";
-
-                        std::string content_ours = graph_mgr.get_blob_content(hash_ours);
-                        std::string content_theirs = graph_mgr.get_blob_content(hash_theirs);
-
-                        std::string conflict_text = 
-                            "<<<<<<< HEAD\n" + content_ours + "\n" +
-                            "=======\n" + content_theirs + "\n" +
-                            ">>>>>>> " + theirs->get_id().substr(0,7) + "\n";
-
-                        entities::File conflict_file(path, conflict_text);
-                        
-                        result_files.push_back(conflict_file);
-                    }
+
+                bool any_file = (be && !be->is_tree()) || (oe && !oe->is_tree()) || (te && !te->is_tree());
+                bool any_dir = (be && be->is_tree()) || (oe && oe->is_tree()) || (te && te->is_tree());
+                if (!any_file) {
+                    merge_trees(id_of(be), id_of(oe), id_of(te), path + "/", ctx);
+                } else if (!any_dir) {
+                    merge_path(path, version_of(be), version_of(oe), version_of(te), ctx);
+                } else {
+                    // A file on one side is a directory on another: compare path by path.
+                    entities::Manifest mb = expand(be, path, ctx);
+                    merge_manifests(&mb, expand(oe, path, ctx), expand(te, path, ctx), ctx);
                 }
             }
+        }
 
-            const auto& their_files_list = theirs->get_files();
-            for (auto it = their_files_list.begin(); it != their_files_list.end(); ++it) {
-                std::string path = it->get_path();
-                
-                if (map_ours.contains(path)) continue;
+        /**
+        * @brief Records the changes that turn tree @p from into tree @p to,
+        * skipping subtrees the two share.
+        */
 
-                std::string hash_base = "";
-                if (map_base.contains(path)) hash_base = map_base.get(path);
+        static void diff_trees(const entities::ObjectId& from, const entities::ObjectId& to,
+                               const std::string& prefix, Context& ctx) {
+            if (from == to) return;
+            std::vector<TreeEntry> a = MerkleTree::load_entries(ctx.graph, from);
+            std::vector<TreeEntry> b = MerkleTree::load_entries(ctx.graph, to);
+            std::size_t ia = 0, ib = 0;
+            while (ia < a.size() || ib < b.size()) {
+                const TreeEntry* ae = nullptr;
+                const TreeEntry* be = nullptr;
+                if (ib == b.size() || (ia < a.size() && a[ia].name <= b[ib].name)) ae = &a[ia];
+                if (ia == a.size() || (ib < b.size() && b[ib].name <= a[ia].name)) be = &b[ib];
+                std::string path = prefix + (ae ? ae->name : be->name);
+                if (ae) ++ia;
+                if (be) ++ib;
+                if (!same(ae, be)) take_theirs(ae, be, path, ctx);
+            }
+        }
 
-                if (hash_base == "") {
-                    result_files.push_back(*it);
-                } else {
-                    if (it->get_hash() == hash_base) { } else {
-                        out_conflict_msg += "CONFLICT (Delete/Modify): " + path + "\n";
-                        result_files.push_back(*it);
-                    }
+        /**
+        * @brief Replaces our entry at @p path (file or directory) by theirs.
+        */
+
+        static void take_theirs(const TreeEntry* oe, const TreeEntry* te, const std::string& path, Context& ctx) {
+            if (oe && te && oe->is_tree() && te->is_tree()) {
+                diff_trees(oe->id, te->id, path + "/", ctx);
+                return;
+            }
+            if (oe && !(te && !te->is_tree() && !oe->is_tree())) {
+                for (const auto& e : expand(oe, path, ctx)) ctx.changes.push_back(change_to(e.get_path(), entities::ObjectId()));
+            }
+            if (te) {
+                for (const auto& e : expand(te, path, ctx)) {
+                    ctx.changes.push_back(change_to(e.get_path(), e.get_hash(), e.get_mode()));
                 }
             }
+        }
 
-            return result_files;
+        /**
+        * @brief Three-way merge of two manifests against a base manifest,
+        * path by path.
+        *
+        * @param[in] base Base snapshot, or nullptr if the histories are unrelated.
+        * @param[in] ours Snapshot of the current branch.
+        * @param[in] theirs Snapshot being merged in.
+        * @param[in,out] ctx Receives changes and conflict descriptions.
+        */
+
+        static void merge_manifests(
+            const entities::Manifest* base,
+            const entities::Manifest& ours,
+            const entities::Manifest& theirs,
+            Context& ctx)
+        {
+            for (auto it = ours.begin(); it != ours.end(); ++it) {
+                std::string path = it->get_path();
+                merge_path(path, lookup(base, path), Version{it->get_hash(), it->get_mode()},
+                           lookup(&theirs, path), ctx);
+            }
+            for (auto it = theirs.begin(); it != theirs.end(); ++it) {
+                std::string path = it->get_path();
+                if (ours.find(path)) continue;
+                merge_path(path, lookup(base, path), Version(), Version{it->get_hash(), it->get_mode()}, ctx);
+            }
         }
 
-    private:
-        
         /**
-        * @brief Creates a mapping from file paths to their content hashes for a commit.
+        * @brief Merges the three versions of one path.
         *
-        * @details This helper function extracts all files from the given commit and stores
-        * their paths and corresponding content hashes in a hash table to enable
-        * fast lookup during the merge process.
+        * @details A side that left the path as in the base yields to the
+        * other. When both changed it, a deletion on either side is a
+        * conflict that keeps the modified version, and two edits are merged
+        * line by line.
+        */
+
+        static void merge_path(const std::string& path, const Version& base, const Version& ours,
+                               const Version& theirs, Context& ctx) {
+            if (ours == theirs || base == theirs) return;
+            if (base == ours) {
+                ctx.changes.push_back(change_to(path, theirs.id, theirs.mode));
+            } else if (theirs.id.is_null()) {
+                ctx.conflict_msg += "CONFLICT (Modify/Delete): " + path + "\n";
+            } else if (ours.id.is_null()) {
+                ctx.conflict_msg += "CONFLICT (Delete/Modify): " + path + "\n";
+                ctx.changes.push_back(change_to(path, theirs.id, theirs.mode));
+            } else {
+                entities::File merged = merge_contents(path, base.id, ours.id, theirs.id,
+                                                       ctx.graph, ctx.their_label, ctx.conflict_msg);
+                MergeChange c = change_to(path, merged.get_hash(), (ours.mode == base.mode) ? theirs.mode : ours.mode);
+                c.merged = true;
+                c.content = merged.release_content();
+                ctx.changes.push_back(std::move(c));
+            }
+        }
+
+        /**
+        * @brief Merges two versions of a file that both changed it.
+        *
+        * @details Text files go through a line-level three-way merge, so
+        * changes to different parts of the file combine cleanly and only
+        * overlapping edits end up between conflict markers. Binary files
+        * conflict as a whole.
         *
-        * @param[in] c Pointer to the commit whose files will be mapped.
-        * @return A hash table mapping file paths to content hashes.
+        * @return The merged file, carrying its content.
         */
 
-        data_structures::HashTable<std::string, std::string> create_file_map(entities::Commit* c) {
-            data_structures::HashTable<std::string, std::string> map;
-            if (!c) return map;
+        static entities::File merge_contents(const std::string& path,
+                                             const entities::ObjectId& hash_base,
+                                             const entities::ObjectId& hash_ours,
+                                             const entities::ObjectId& hash_theirs,
+                                             GraphManager& graph_mgr,
+                                             const std::string& their_label,
+                                             std::string& out_conflict_msg) {
+            std::string content_base = hash_base.is_null() ? "" : graph_mgr.get_blob_content(hash_base);
+            std::string content_ours = graph_mgr.get_blob_content(hash_ours);
+            std::string content_theirs = graph_mgr.get_blob_content(hash_theirs);
 
-            const auto& files = c->get_files();
-            for (auto it = files.begin(); it != files.end(); ++it) {
-                map.put(it->get_path(), it->get_hash());
+            if (LineDiff::is_binary(content_base) || LineDiff::is_binary(content_ours) ||
+                LineDiff::is_binary(content_theirs)) {
+                out_conflict_msg += "CONFLICT (Binary): " + path + "\n";
+                std::string text;
+                text.reserve(content_ours.size() + content_theirs.size() + their_label.size() + 32);
+                text.append("<<<<<<< HEAD\n").append(content_ours).append("\n=======\n");
+                text.append(content_theirs).append("\n>>>>>>> ").append(their_label).append("\n");
+                return entities::File(path, std::move(text));
             }
-            return map;
+
+            Diff3Result merged = Diff3::merge(content_base, content_ours, content_theirs, their_label);
+            if (merged.conflicts > 0) {
+                out_conflict_msg += "CONFLICT (Content): " + path + " (" +
+                                    std::to_string(merged.conflicts) + " region(s))\n";
+            }
+            return entities::File(path, std::move(merged.text));
+        }
+
+        /**
+        * @brief Looks up a path in a snapshot.
+        *
+        * @param[in] files Snapshot to search (may be nullptr).
+        * @param[in] path File path.
+        * @return Version of the path, null if it is absent.
+        */
+
+        static Version lookup(const entities::Manifest* files, const std::string& path) {
+            if (!files) return Version();
+            const entities::ManifestEntry* e = files->find(path);
+            return e ? Version{e->get_hash(), e->get_mode()} : Version();
+        }
+
+        static MergeChange change_to(const std::string& path, const entities::ObjectId& id,
+                                     std::uint32_t mode = entities::kModeRegular) {
+            MergeChange c;
+            c.path = path;
+            c.id = id;
+            c.mode = mode;
+            return c;
+        }
+
+        static bool same(const TreeEntry* a, const TreeEntry* b) {
+            if (!a || !b) return a == b;
+            return a->id == b->id && a->mode == b->mode;
+        }
+
+        static entities::ObjectId id_of(const TreeEntry* e) {
+            return e ? e->id : entities::ObjectId();
+        }
+
+        static Version version_of(const TreeEntry* e) {
+            return e ? Version{e->id, e->mode} : Version();
+        }
+
+        /**
+        * @brief Lists the files an entry stands for: itself, or everything below it.
+        */
+
+        static entities::Manifest expand(const TreeEntry* e, const std::string& path, Context& ctx) {
+            std::vector<entities::ManifestEntry> entries;
+            if (e && e->is_tree()) MerkleTree::flatten(ctx.graph, e->id, path + "/", entries);
+            else if (e) entries.emplace_back(path, e->id, e->mode);
+            return entities::Manifest::from_entries(std::move(entries));
         }
     };
-}
\ No newline at end of file
+}
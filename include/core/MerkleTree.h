@@ -2,26 +2,40 @@
  * @file MerkleTree.h
  * @brief Defines Merkle tree structures for content hashing.
  *
+ * @details Snapshots are hashed as a hierarchy of directory trees built
+ * from the path components of each file. Every directory is a
+ * content-addressed tree object listing its children by name, so a
+ * directory whose contents did not change keeps its id across commits and
+ * can be reused without being rebuilt.
+ *
+ * Tree payload (little-endian): u32 entry count, then per entry
+ * `[u32 name length][name][u32 mode][ObjectId]`, ordered by name.
+ *
  * @author Umut Ertuğrul Daşgın
  * @note Documentation maintained by Deniz Kayra Aydın / Ömer Kağan Zafer.
- * @version 1.1
+ * @version 1.3
  * @date 2025-12-25
- * @lastModified 2026-01-10
+ * @lastModified 2026-10-14
  */
 
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <iostream>
-#include <sstream>
-#include <iomanip>
 #include <vector>
-#include <functional>
-#include "../data_structures/DoublyLinkedList.h"
-#include "../entities/File.h"
+#include <algorithm>
+#include <stdexcept>
+#include "BinaryIO.h"
+#include "../entities/Manifest.h"
+#include "../entities/ObjectId.h"
+#include "../crypto/Sha256.h"
 
 namespace core {
 
+/// Mode recorded for directory entries.
+constexpr std::uint32_t kModeTree = 0040000;
+
 /**
  * @brief Identifies the type of a Merkle tree node.
  */
@@ -30,6 +44,37 @@ enum NodeType {
     TREE
 };
 
+/**
+ * @brief One child of a stored tree object.
+ */
+struct TreeEntry {
+    std::string name;
+    std::uint32_t mode;
+    entities::ObjectId id;
+
+    bool is_tree() const { return mode == kModeTree; }
+};
+
+/**
+ * @brief Persistence hook for tree objects.
+ * * Implemented by the component that owns the object store (core::GraphManager)
+ */
+class TreeStore {
+public:
+    virtual ~TreeStore() = default;
+
+    /**
+     * @brief Loads a tree payload.
+     * @return False if no tree with that id is stored.
+     */
+    virtual bool load_tree(const entities::ObjectId& id, std::string& payload) = 0;
+
+    /**
+     * @brief Stores a tree payload under its id (no-op if already present).
+     */
+    virtual void store_tree(const entities::ObjectId& id, const std::string& payload) = 0;
+};
+
 /**
  * @brief Represents a node in the Merkle tree.
  * * BLOB nodes represent file content
@@ -39,16 +84,18 @@ enum NodeType {
 struct MerkleNode {
 
     std::string name;
-    std::string hash;
+    entities::ObjectId hash;
     NodeType type;
-    data_structures::DoublyLinkedList<MerkleNode*> children;
+    std::uint32_t mode;
+    std::vector<MerkleNode*> children;
 
     /**
      * @brief Creates a node with a name and type.
      * @param n Node name.
      * @param t Node type.
      */
-    MerkleNode(std::string n, NodeType t) : name(n), type(t) {}
+    MerkleNode(std::string n, NodeType t)
+        : name(std::move(n)), type(t), mode(t == TREE ? kModeTree : entities::kModeRegular) {}
 
     /**
      * @brief Releases all owned child nodes.
@@ -64,19 +111,22 @@ struct MerkleNode {
  * @brief Builds a Merkle tree from staged files.
  * * Owns the root node
  * * Produces deterministic hashes
+ * * update() derives a new root from a stored one, touching only the
+ *   directories on changed paths
  */
 class MerkleTree {
 public:
     MerkleNode* root;
 
     /**
-     * @brief Constructs a tree from staged files.
+     * @brief Constructs a tree from a snapshot manifest.
      * @param staged_files Files to include in the tree.
+     * @param store If given, every tree object is written to it.
      */
-    explicit MerkleTree(const data_structures::DoublyLinkedList<entities::File>& staged_files) {
-        root = new MerkleNode("root", TREE);
+    explicit MerkleTree(const entities::Manifest& staged_files, TreeStore* store = nullptr) {
+        root = new MerkleNode("", TREE);
         build_from_staging(staged_files);
-        calculate_hashes_recursive(root);
+        calculate_hashes_recursive(root, store);
     }
 
     /**
@@ -86,91 +136,267 @@ public:
         delete root;
     }
 
+    MerkleTree(const MerkleTree&) = delete;
+    MerkleTree& operator=(const MerkleTree&) = delete;
+
     /**
      * @brief Returns the root hash.
-     * @return Root hash or empty string.
+     * @return Root hash or the null id if the snapshot is empty.
+     */
+    entities::ObjectId get_root_hash() const {
+        return root && !root->children.empty() ? root->hash : entities::ObjectId();
+    }
+
+    /**
+     * @brief Serializes tree entries (already ordered by name).
+     */
+    static std::string encode_tree(const std::vector<TreeEntry>& entries) {
+        std::string out;
+        binary_io::put_u32(out, static_cast<std::uint32_t>(entries.size()));
+        for (const TreeEntry& e : entries) {
+            binary_io::put_string(out, e.name);
+            binary_io::put_u32(out, e.mode);
+            out.append(reinterpret_cast<const char*>(e.id.data()), entities::ObjectId::size());
+        }
+        return out;
+    }
+
+    /**
+     * @brief Parses a tree payload.
+     */
+    static std::vector<TreeEntry> decode_tree(const std::string& payload) {
+        binary_io::ByteReader in(payload);
+        std::vector<TreeEntry> entries(in.u32());
+        for (TreeEntry& e : entries) {
+            e.name = in.string();
+            e.mode = in.u32();
+            e.id = entities::ObjectId::from_bytes(in.raw(entities::ObjectId::size()));
+        }
+        return entries;
+    }
+
+    /**
+     * @brief Computes the id of a tree payload.
+     */
+    static entities::ObjectId hash_tree(const std::string& payload) {
+        return entities::ObjectId(crypto::Sha256().update("tree ").update(payload).finish());
+    }
+
+    /**
+     * @brief Derives a new root tree from a stored one.
+     *
+     * @details Only directories that contain a changed path are loaded,
+     * rewritten and rehashed; every other subtree keeps its stored id. A
+     * change carrying the null id removes its path, and directories left
+     * empty disappear.
+     *
+     * @param store Tree storage (read for @p base, written for new trees).
+     * @param base Root tree to start from (null for an empty snapshot).
+     * @param changes Changed entries in any order.
+     * @return New root tree id, or the null id if the snapshot is empty.
+     * @throws std::runtime_error if a referenced tree is missing.
      */
-    std::string get_root_hash() const {
-        return root ? root->hash : "";
+    static entities::ObjectId update(TreeStore& store, const entities::ObjectId& base,
+                                     std::vector<entities::ManifestEntry> changes) {
+        std::stable_sort(changes.begin(), changes.end(),
+            [](const entities::ManifestEntry& a, const entities::ManifestEntry& b) {
+                return a.get_path() < b.get_path();
+            });
+        return update_dir(store, base, changes, 0, changes.size(), 0);
+    }
+
+    /**
+     * @brief Expands a stored tree into a manifest.
+     * @throws std::runtime_error if a referenced tree is missing.
+     */
+    static entities::Manifest load_manifest(TreeStore& store, const entities::ObjectId& root_id) {
+        std::vector<entities::ManifestEntry> entries;
+        if (!root_id.is_null()) flatten(store, root_id, "", entries);
+        return entities::Manifest::from_entries(std::move(entries));
+    }
+
+    /**
+     * @brief Loads the entries of a stored tree.
+     * @return Entries ordered by name; empty for the null id.
+     * @throws std::runtime_error if the tree is missing.
+     */
+    static std::vector<TreeEntry> load_entries(TreeStore& store, const entities::ObjectId& id) {
+        std::vector<TreeEntry> entries;
+        if (id.is_null()) return entries;
+
+        std::string payload;
+        if (!store.load_tree(id, payload)) {
+            throw std::runtime_error("Missing tree object: " + id.to_hex());
+        }
+        return decode_tree(payload);
+    }
+
+    /**
+     * @brief Appends every file below a stored tree, in path order.
+     * @param prefix Path of the tree including its trailing '/' ("" for a root).
+     * @throws std::runtime_error if a referenced tree is missing.
+     */
+    static void flatten(TreeStore& store, const entities::ObjectId& id, const std::string& prefix,
+                        std::vector<entities::ManifestEntry>& out) {
+        for (const TreeEntry& e : load_entries(store, id)) {
+            if (e.is_tree()) flatten(store, e.id, prefix + e.name + "/", out);
+            else out.emplace_back(prefix + e.name, e.id, e.mode);
+        }
     }
 
 private:
+
     /**
-     * @brief Computes a hash from input data.
-     * @param input Data to hash.
-     * @return Hexadecimal hash string.
+     * @brief Rewrites one directory.
+     *
+     * @details changes[begin, end) all lie below this directory, whose path
+     * prefix (including the trailing '/') is @p prefix_len characters long.
+     * Changes to a subdirectory are contiguous because they share a prefix.
      */
-    std::string calculate_hash(const std::string& input) {
-        std::hash<std::string> hasher;
-        std::size_t hash_val = hasher(input);
-        std::stringstream ss;
-        ss << std::hex << std::setw(16) << std::setfill('0') << hash_val;
-        return ss.str();
+    static entities::ObjectId update_dir(TreeStore& store, const entities::ObjectId& base,
+                                         const std::vector<entities::ManifestEntry>& changes,
+                                         std::size_t begin, std::size_t end, std::size_t prefix_len) {
+        std::vector<TreeEntry> entries = load_entries(store, base);
+
+        auto slot = [&entries](std::string_view name) {
+            return std::lower_bound(entries.begin(), entries.end(), name,
+                [](const TreeEntry& e, std::string_view n) { return std::string_view(e.name) < n; });
+        };
+
+        std::size_t i = begin;
+        while (i < end) {
+            std::string_view rest = std::string_view(changes[i].get_path()).substr(prefix_len);
+            std::size_t slash = rest.find('/');
+            std::string_view name = rest.substr(0, slash);
+
+            entities::ObjectId id;
+            std::uint32_t mode;
+            std::size_t next = i + 1;
+
+            if (slash == std::string_view::npos) {
+                id = changes[i].get_hash();
+                mode = changes[i].get_mode();
+                // Only the last change to a path counts.
+                while (next < end && changes[next].get_path() == changes[i].get_path()) {
+                    id = changes[next].get_hash();
+                    mode = changes[next].get_mode();
+                    ++next;
+                }
+            } else {
+                std::string_view dir = rest.substr(0, slash + 1);
+                while (next < end &&
+                       std::string_view(changes[next].get_path()).substr(prefix_len, dir.size()) == dir) {
+                    ++next;
+                }
+                auto it = slot(name);
+                entities::ObjectId child_base =
+                    (it != entries.end() && it->name == name && it->is_tree()) ? it->id : entities::ObjectId();
+                id = update_dir(store, child_base, changes, i, next, prefix_len + slash + 1);
+                mode = kModeTree;
+            }
+
+            auto it = slot(name);
+            bool exists = it != entries.end() && it->name == name;
+            if (id.is_null()) {
+                if (exists) entries.erase(it);
+            } else if (exists) {
+                it->id = id;
+                it->mode = mode;
+            } else {
+                entries.insert(it, TreeEntry{std::string(name), mode, id});
+            }
+            i = next;
+        }
+
+        if (entries.empty()) return entities::ObjectId();
+
+        std::string payload = encode_tree(entries);
+        entities::ObjectId id = hash_tree(payload);
+        store.store_tree(id, payload);
+        return id;
     }
 
     /**
-     * @brief Creates blob nodes from staged files.
-     * @param files Staged files.
+     * @brief Creates the directory hierarchy from snapshot files.
+     *
+     * @details The manifest is ordered by full path, so all files below a
+     * directory are contiguous; a stack of open directories is enough to
+     * place every file without searching siblings.
+     *
+     * @param files Snapshot files.
      */
-    void build_from_staging(const data_structures::DoublyLinkedList<entities::File>& files) {
+    void build_from_staging(const entities::Manifest& files) {
+        std::vector<MerkleNode*> open_dirs{root};
+        std::vector<std::string_view> open_names;
+
         for (auto it = files.begin(); it != files.end(); ++it) {
+            std::string_view path = it->get_path();
 
-            MerkleNode* file_node = new MerkleNode(it->get_path(), BLOB);
+            std::vector<std::string_view> parts;
+            std::size_t start = 0;
+            for (std::size_t slash; (slash = path.find('/', start)) != std::string_view::npos; start = slash + 1) {
+                parts.push_back(path.substr(start, slash - start));
+            }
 
-            std::string header =
-                "blob " + std::to_string(it->get_content().size()) + '\0';
-            file_node->hash = calculate_hash(header + it->get_content());
+            std::size_t common = 0;
+            while (common < parts.size() && common < open_names.size() && parts[common] == open_names[common]) {
+                ++common;
+            }
+            open_dirs.resize(common + 1);
+            open_names.resize(common);
 
-            root->children.push_back(file_node);
-        }
+            for (std::size_t d = common; d < parts.size(); ++d) {
+                MerkleNode* dir = new MerkleNode(std::string(parts[d]), TREE);
+                open_dirs.back()->children.push_back(dir);
+                open_dirs.push_back(dir);
+                open_names.push_back(parts[d]);
+            }
+
+            MerkleNode* file_node = new MerkleNode(std::string(path.substr(start)), BLOB);
+
+            // Snapshot entries carry only their content hash, not their content.
+            file_node->hash = it->get_hash();
+            file_node->mode = it->get_mode();
 
-        sort_children_by_name(root->children);
+            open_dirs.back()->children.push_back(file_node);
+        }
     }
 
     /**
      * @brief Computes hashes bottom-up.
      * @param node Current tree node.
+     * @param store Receives each tree object, if given.
      */
-    void calculate_hashes_recursive(MerkleNode* node) {
+    void calculate_hashes_recursive(MerkleNode* node, TreeStore* store) {
         if (!node) return;
         if (node->type == BLOB) return;
 
-        std::string combined_content = "tree ";
+        sort_children_by_name(node->children);
+
+        std::vector<TreeEntry> entries;
+        entries.reserve(node->children.size());
         for (auto it = node->children.begin(); it != node->children.end(); ++it) {
-            calculate_hashes_recursive(*it);
-            combined_content += (*it)->hash + (*it)->name;
+            calculate_hashes_recursive(*it, store);
+            entries.push_back(TreeEntry{(*it)->name, (*it)->mode, (*it)->hash});
         }
 
-        node->hash = calculate_hash(combined_content);
+        std::string payload = encode_tree(entries);
+        node->hash = hash_tree(payload);
+        if (store && !entries.empty()) store->store_tree(node->hash, payload);
     }
 
     /**
      * @brief Sorts child nodes by name.
+     * @details Siblings arrive in full-path order, which already is name
+     * order unless a name is a prefix of another ("a/" sorts after "a.txt").
+     * The common, already-ordered case is detected in one linear pass;
+     * otherwise the children are sorted in O(n log n).
      * @param kids Child node list.
      */
-    void sort_children_by_name(
-        data_structures::DoublyLinkedList<MerkleNode*>& kids
-    ) {
-        if (kids.empty()) return;
-
-        bool swapped;
-        do {
-            swapped = false;
-            auto it = kids.begin();
-            auto next_it = kids.begin();
-            ++next_it;
-
-            while (next_it != kids.end()) {
-                if ((*it)->name > (*next_it)->name) {
-                    MerkleNode* temp = *it;
-                    *it = *next_it;
-                    *next_it = temp;
-                    swapped = true;
-                }
-                ++it;
-                ++next_it;
-            }
-        } while (swapped);
+    static void sort_children_by_name(std::vector<MerkleNode*>& kids) {
+        auto by_name = [](const MerkleNode* a, const MerkleNode* b) { return a->name < b->name; };
+        if (std::is_sorted(kids.begin(), kids.end(), by_name)) return;
+        std::sort(kids.begin(), kids.end(), by_name);
     }
 };
 
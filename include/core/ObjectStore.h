@@ -0,0 +1,1455 @@
+/**
+ * @file ObjectStore.h
+ * @brief Persistent, content-addressed object store backed by a pack file.
+ *
+ * @details Objects (blobs, trees, commits) are appended to a single pack file under
+ * the repository directory. A sorted key→offset index is kept next to it and
+ * memory-mapped on open, so lookups are a binary search over the mapping and
+ * never require loading the whole repository into memory.
+ *
+ * On-disk layout (all integers little-endian):
+ * - `pack`     : "TRIPACK1" followed by records
+ *                `[u8 type][u8 key_len][ObjectId][u64 size][payload]`
+ * - `pack.idx` : "TRIIDX01", u64 entry count, u64 indexed pack length,
+ *                then entries `[ObjectId][u64 offset]` sorted by id
+ *
+ * Records appended after the last index write are tracked in memory and are
+ * recovered by scanning the pack tail when the store is reopened.
+ *
+ * A record whose type byte has the high bit (kEncodedFlag) set stores an
+ * encoded payload, prefixed by `[u8 codec][u8 level][u8 flags][u64 raw size]`,
+ * then the ObjectId of the dictionary it was compressed with if flags bit 0
+ * is set, and the ObjectId of its delta base if flags bit 1 is set. For
+ * deltas the level byte holds the chain depth (1 = the base is stored whole).
+ * Records without the flag hold the raw payload, so packs written before
+ * compression existed remain readable.
+ *
+ * Blobs too large to buffer are written through a BlobWriter, which
+ * streams the payload into the pack first and fills in the record header,
+ * whose key and size are only known at the end, last. With compression
+ * enabled such a payload is a sequence of LZ frames (Codec::LZ_FRAMES).
+ * An interrupted stream leaves a header of zeros, which recovery treats as
+ * a torn tail.
+ *
+ * With chunking enabled (set_chunking()), large blobs are split at FastCDC
+ * boundaries into CHUNK objects addressed by their content, and the blob
+ * record (Codec::CHUNKED) lists them as `[ObjectId chunk][u32 size]`
+ * entries. Versions of a file that change by insertions share most of
+ * their chunks, and a chunk already stored is not written again. Chunked
+ * blobs decode like any other, so readers need not know about chunking.
+ *
+ * Reads are served from a shared memory mapping of the pack; get_view()
+ * hands out BlobViews into it without copying the payload. Encoded payloads
+ * are decoded only when their bytes are requested.
+ *
+ * Several processes may share a store. Every write (appending records,
+ * streaming a blob, rewriting the index, repacking) holds an exclusive
+ * flock(2) on `pack.lock` and, on taking it, catches up with what other
+ * processes wrote: the pack size and index are re-read, and a pack
+ * replaced by another process's repack is reopened. Appends therefore
+ * always land at the real end of the pack and an index rewrite includes
+ * every record before it. The kernel drops the lock if its holder dies,
+ * so a crash leaves no stale lock behind. Reads take no lock and see other
+ * processes' objects from the next write on.
+ *
+ * The store itself is used by one thread. snapshot() captures an immutable
+ * read view that any number of threads may query while the owner keeps
+ * writing; it shares the current mappings instead of copying them.
+ *
+ * Blob reads and writes, and payload bytes copied by get(), are counted
+ * in Stats.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.12
+ * @date 2026-10-14
+ * @lastModified 2026-10-14
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <stdexcept>
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <sys/uio.h>
+#include <climits>
+#include "BinaryIO.h"
+#include "MappedFile.h"
+#include "BlobView.h"
+#include "Compression.h"
+#include "Delta.h"
+#include "Chunker.h"
+#include "Stats.h"
+#include "../data_structures/HashTable.h"
+#include "../entities/ObjectId.h"
+#include "../crypto/Sha256.h"
+
+namespace core {
+
+/**
+ * @brief Kind of object stored in the pack.
+ */
+enum class ObjectType : std::uint8_t {
+    BLOB = 1,
+    COMMIT = 2,
+    TREE = 3,
+    DICTIONARY = 4,  ///< Compression dictionary referenced by encoded records
+    CHUNK = 5        ///< Piece of a chunked blob
+};
+
+/**
+ * @brief A stored payload that has not necessarily been decoded yet.
+ * @details Resolving one is cheap and must happen on the thread that owns
+ * the ObjectStore; open() only touches the captured bytes and dictionary,
+ * so it may run on any thread.
+ */
+struct PackedObject {
+    BlobView stored;                            ///< Payload bytes as stored in the pack
+    Codec codec = Codec::NONE;
+    std::uint64_t raw_size = 0;                 ///< Size once decoded
+    std::shared_ptr<const std::string> dict;    ///< Dictionary used for encoding, if any
+    std::shared_ptr<const PackedObject> base;   ///< Delta base, already resolved
+    std::shared_ptr<const std::vector<PackedObject>> parts;   ///< Chunks of a chunked blob, resolved
+
+    PackedObject() = default;
+
+    /**
+     * @brief Wraps bytes that need no decoding.
+     */
+    PackedObject(BlobView raw) : stored(std::move(raw)), raw_size(stored.size()) {}
+
+    /**
+     * @brief Returns the decoded payload.
+     * @throws std::runtime_error if the stored bytes are corrupt.
+     */
+    BlobView open() const {
+        if (codec == Codec::NONE) return stored;
+        std::string out;
+        if (codec == Codec::CHUNKED) {
+            out.reserve(static_cast<std::size_t>(raw_size));
+            for (const PackedObject& part : *parts) out.append(part.open().view());
+            if (out.size() != raw_size) throw std::runtime_error("ObjectStore: chunked blob size mismatch");
+        } else if (codec == Codec::DELTA) {
+            BlobView from = base->open();
+            DeltaCodec::apply(from.view(), stored.view(), static_cast<std::size_t>(raw_size), out);
+        } else if (codec == Codec::LZ_FRAMES) {
+            LzCodec::decompress_frames(stored.view(), static_cast<std::size_t>(raw_size),
+                                       dict ? std::string_view(*dict) : std::string_view(), out);
+        } else {
+            LzCodec::decompress(stored.view(), static_cast<std::size_t>(raw_size),
+                                dict ? std::string_view(*dict) : std::string_view(), out);
+        }
+        return BlobView::adopt(std::move(out));
+    }
+};
+
+/**
+ * @brief An object on its way into the pack.
+ * @details ObjectStore::prepare() captures the store's encoding settings and
+ * resolves the delta base on the owning thread. The caller then fills in
+ * the key and payload, and encode() does the CPU-heavy part (compression
+ * and delta search) on any thread. ObjectStore::write_batch() appends the
+ * results on the owning thread.
+ */
+struct PendingWrite {
+    static constexpr std::size_t kMinEncodeSize = 64;   ///< Smaller blobs are never worth encoding
+
+    ObjectType type = ObjectType::BLOB;
+    entities::ObjectId key;
+    std::string data;                      ///< Raw payload owned by the write
+    std::string_view source;               ///< Caller-owned raw payload, used if data is empty; must outlive the write
+
+    Codec codec = Codec::NONE;             ///< Settings captured by prepare()
+    int level = 0;
+    entities::ObjectId dict_id;
+    std::shared_ptr<const std::string> dict;
+    entities::ObjectId base_id;            ///< Usable delta base, or the null id
+    PackedObject base;
+    int base_depth = 0;
+
+    std::string header;                    ///< Encoding prefix (empty: the raw payload is written)
+    std::string body;                      ///< Encoded payload
+
+    /**
+     * @brief Returns the raw payload.
+     */
+    std::string_view payload() const { return data.empty() ? source : std::string_view(data); }
+
+    /**
+     * @brief Returns the bytes written after the header.
+     */
+    std::string_view stored() const { return header.empty() ? payload() : std::string_view(body); }
+
+    /**
+     * @brief Picks the smallest of the raw payload, its compression and a
+     * delta against the base.
+     * @details The raw payload is released once an encoding wins; a raw
+     * payload is written from where it is, without a copy.
+     * @throws std::runtime_error if the base is corrupt.
+     */
+    void encode() {
+        const std::string_view raw = payload();
+        std::size_t best_size = raw.size();
+        auto make_header = [&](Codec c, int lvl, bool with_dict, const entities::ObjectId* base_key) {
+            std::string hdr;
+            hdr.push_back(static_cast<char>(c));
+            hdr.push_back(static_cast<char>(lvl));
+            hdr.push_back(static_cast<char>((with_dict ? 1 : 0) | (base_key ? 2 : 0)));
+            binary_io::put_u64(hdr, raw.size());
+            if (with_dict) hdr.append(reinterpret_cast<const char*>(dict_id.data()), entities::ObjectId::kSize);
+            if (base_key) hdr.append(reinterpret_cast<const char*>(base_key->data()), entities::ObjectId::kSize);
+            return hdr;
+        };
+
+        header.clear();
+        body.clear();
+        if ((type == ObjectType::BLOB || type == ObjectType::CHUNK) && codec == Codec::LZ &&
+            raw.size() >= kMinEncodeSize) {
+            std::string packed = LzCodec::compress(raw, level, dict ? std::string_view(*dict) : std::string_view());
+            std::string hdr = make_header(Codec::LZ, level, dict != nullptr, nullptr);
+            if (hdr.size() + packed.size() < best_size) {
+                best_size = hdr.size() + packed.size();
+                header = std::move(hdr);
+                body = std::move(packed);
+            }
+        }
+
+        if (type == ObjectType::BLOB && !base_id.is_null() && base_id != key && raw.size() >= kMinEncodeSize) {
+            std::string hdr = make_header(Codec::DELTA, base_depth + 1, false, &base_id);
+            if (hdr.size() < best_size) {
+                std::string delta = DeltaCodec::encode(base.open().view(), raw, best_size - hdr.size() - 1);
+                if (!delta.empty()) {
+                    best_size = hdr.size() + delta.size();
+                    header = std::move(hdr);
+                    body = std::move(delta);
+                }
+            }
+        }
+
+        if (!header.empty()) {
+            data = std::string();
+            source = std::string_view();
+        }
+        base = PackedObject();
+    }
+};
+
+/**
+ * @brief Append-only pack file with a sorted, memory-mapped index.
+ * * put() appends a record and remembers its offset until the next index flush
+ * * prepare() / write_batch() split put() so that encoding can run on worker
+ *   threads and many records share one write call and one flush()
+ * * get()/contains() are O(log n) over the index plus O(1) over pending records
+ * * Blobs are compressed with the configured codec when that saves space;
+ *   other object kinds are always stored raw
+ * * A blob given a base (normally the previous version of the same path) is
+ *   stored as a delta when that is smaller still; chains are capped at
+ *   max_delta_depth() so a read applies a bounded number of deltas
+ */
+class ObjectStore {
+public:
+    static constexpr std::size_t kKeySize = entities::ObjectId::kSize;
+    static constexpr std::size_t kRecordHeader = 2 + kKeySize + 8;
+    static constexpr std::size_t kIndexHeader = 8 + 8 + 8;
+    static constexpr std::size_t kIndexEntry = kKeySize + 8;
+    static constexpr std::size_t kFlushThreshold = 4096;  ///< Pending records before the index is rewritten
+    static constexpr std::uint8_t kEncodedFlag = 0x80;    ///< Type-byte bit marking an encoded payload
+    static constexpr std::size_t kEncodedHeader = 3 + 8;
+    static constexpr std::size_t kMinCompressSize = PendingWrite::kMinEncodeSize;
+    static constexpr int kDefaultMaxDeltaDepth = 10;
+    static constexpr int kMaxDeltaDepth = 64;              ///< Hard limit; deeper chains are treated as corrupt
+    static constexpr std::size_t kChunkEntry = kKeySize + 4;   ///< `[ObjectId][u32 size]` in a chunk list
+
+private:
+    std::string dir_;
+    std::string pack_path_;
+    std::string index_path_;
+    std::string lock_path_;
+    int pack_fd_;
+    std::uint64_t pack_size_;
+    int lock_fd_ = -1;
+    int lock_depth_ = 0;             ///< Nesting of WriteLocks; the flock is held while positive
+    struct stat pack_stat_ {};       ///< Identity of the open pack
+    struct stat index_stat_ {};      ///< Identity of the loaded index
+
+    mutable std::shared_ptr<MappedFile> pack_map_;   ///< Shared with outstanding BlobViews
+
+    std::shared_ptr<MappedFile> index_map_;   ///< Shared with outstanding Snapshots
+    std::size_t index_count_;
+    std::uint64_t indexed_pack_size_;
+
+    data_structures::HashTable<entities::ObjectId, std::uint64_t, CountedProbes> pending_;
+    std::vector<std::pair<entities::ObjectId, std::uint64_t>> pending_order_;
+
+    Codec codec_ = Codec::NONE;
+    int level_ = LzCodec::kMinLevel;
+    int max_delta_depth_ = kDefaultMaxDeltaDepth;
+    entities::ObjectId dict_id_;
+    std::shared_ptr<const std::string> dict_;   ///< Dictionary for new blobs (null if none)
+    mutable data_structures::HashTable<entities::ObjectId, std::shared_ptr<const std::string>> dicts_;
+    bool streaming_ = false;   ///< A BlobWriter owns the pack tail
+    std::size_t chunk_average_ = 0;   ///< FastCDC average chunk size for new blobs (0 = off)
+
+    static constexpr const char* kPackMagic = "TRIPACK1";
+    static constexpr const char* kIndexMagic = "TRIIDX01";
+
+    void pread_exact(void* buf, std::size_t n, std::uint64_t off) const {
+        char* p = static_cast<char*>(buf);
+        while (n > 0) {
+            ssize_t r = ::pread(pack_fd_, p, n, static_cast<off_t>(off));
+            if (r < 0 && errno == EINTR) continue;
+            if (r <= 0) throw std::runtime_error("ObjectStore: short read from " + pack_path_);
+            p += r;
+            n -= static_cast<std::size_t>(r);
+            off += static_cast<std::uint64_t>(r);
+        }
+    }
+
+    /**
+     * @brief Returns a mapping that covers [0, end) of the pack, remapping if it grew.
+     * @details Maps the open descriptor rather than the path, so offsets
+     * from the loaded index are never applied to a pack another process
+     * has since renamed into place.
+     */
+    const MappedFile& mapping_covering(std::uint64_t end) const {
+        if (!pack_map_ || pack_map_->size() < end) {
+            auto fresh = std::make_shared<MappedFile>();
+            if (!fresh->open(pack_fd_) || fresh->size() < end) {
+                throw std::runtime_error("ObjectStore: cannot map " + pack_path_);
+            }
+            pack_map_ = std::move(fresh);
+        }
+        return *pack_map_;
+    }
+
+    void pwrite_exact(const void* buf, std::size_t n, std::uint64_t off) {
+        const char* p = static_cast<const char*>(buf);
+        while (n > 0) {
+            ssize_t w = ::pwrite(pack_fd_, p, n, static_cast<off_t>(off));
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) throw std::runtime_error("ObjectStore: write failed on " + pack_path_);
+            p += w;
+            n -= static_cast<std::size_t>(w);
+            off += static_cast<std::uint64_t>(w);
+        }
+    }
+
+    /**
+     * @brief Writes scattered buffers contiguously at @p off.
+     * @details Used so large payloads reach the pack without being copied
+     * into a record buffer first.
+     */
+    void pwritev_exact(std::vector<iovec>& iov, std::uint64_t off) {
+        std::size_t first = 0;
+        while (first < iov.size()) {
+            int count = static_cast<int>(std::min<std::size_t>(iov.size() - first, IOV_MAX));
+            ssize_t w = ::pwritev(pack_fd_, iov.data() + first, count, static_cast<off_t>(off));
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) throw std::runtime_error("ObjectStore: write failed on " + pack_path_);
+            off += static_cast<std::uint64_t>(w);
+            for (std::size_t left = static_cast<std::size_t>(w); left > 0;) {
+                if (left >= iov[first].iov_len) {
+                    left -= iov[first].iov_len;
+                    ++first;
+                } else {
+                    iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + left;
+                    iov[first].iov_len -= left;
+                    left = 0;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Binary-searches a mapped index of @p count entries for a key.
+     * @return Pack offset or UINT64_MAX if absent.
+     */
+    static std::uint64_t index_lookup(const MappedFile* map, std::size_t count, const entities::ObjectId& key) {
+        if (count == 0) return UINT64_MAX;
+
+        const unsigned char* entries = map->data() + kIndexHeader;
+        std::size_t lo = 0, hi = count;
+        while (lo < hi) {
+            std::size_t mid = lo + (hi - lo) / 2;
+            const unsigned char* e = entries + mid * kIndexEntry;
+            int c = std::memcmp(e, key.data(), kKeySize);
+            if (c == 0) return binary_io::load_u64(e + kKeySize);
+            if (c < 0) lo = mid + 1;
+            else hi = mid;
+        }
+        return UINT64_MAX;
+    }
+
+    std::uint64_t find_offset(const entities::ObjectId& key) const {
+        if (const std::uint64_t* off = pending_.find(key)) return *off;
+        return index_lookup(index_map_.get(), index_count_, key);
+    }
+
+    /**
+     * @brief Returns a mapping covering [0, end) of the pack, shared with the caller.
+     */
+    std::shared_ptr<MappedFile> mapping(std::uint64_t end) const {
+        mapping_covering(end);
+        return pack_map_;
+    }
+
+    /**
+     * @brief Loads (and caches) a dictionary object.
+     * @throws std::runtime_error if the dictionary is missing.
+     */
+    std::shared_ptr<const std::string> dictionary(const entities::ObjectId& id) const {
+        if (auto* cached = dicts_.find(id)) return *cached;
+        PackedObject obj;
+        ObjectType type;
+        if (!get_packed(id, obj, &type) || type != ObjectType::DICTIONARY) {
+            throw std::runtime_error("ObjectStore: missing dictionary " + id.short_hex());
+        }
+        auto dict = std::make_shared<const std::string>(obj.stored.to_string());
+        dicts_.put(id, dict);
+        return dict;
+    }
+
+    /**
+     * @brief Number of deltas applied to read @p key (0 if stored whole).
+     */
+    int delta_depth(const entities::ObjectId& key) const {
+        std::uint64_t off = find_offset(key);
+        if (off == UINT64_MAX) return 0;
+        if (!(mapping_covering(off + kRecordHeader).data()[off] & kEncodedFlag)) return 0;
+        const unsigned char* codec = mapping_covering(off + kRecordHeader + 2).data() + off + kRecordHeader;
+        return codec[0] == static_cast<std::uint8_t>(Codec::DELTA) ? codec[1] : 0;
+    }
+
+    /**
+     * @brief Reads an object's kind from its record header, decoding nothing.
+     * @return False if the object is not stored.
+     */
+    bool stored_type(const entities::ObjectId& key, ObjectType& type) const {
+        std::uint64_t off = find_offset(key);
+        if (off == UINT64_MAX) return false;
+        type = static_cast<ObjectType>(mapping_covering(off + kRecordHeader).data()[off] & ~kEncodedFlag);
+        return true;
+    }
+
+    /**
+     * @brief get_packed() with a count of delta bases already followed.
+     */
+    bool get_packed_at(const entities::ObjectId& key, PackedObject& out, ObjectType* type, int hops) const {
+        return read_packed(*this, key, out, type, hops);
+    }
+
+    /**
+     * @brief Locates and parses a record through @p src.
+     * @details Shared by the store and its Snapshots. @p src supplies
+     * `find_offset(key)`, `mapping(end)` and `dictionary(id)`.
+     * @throws std::runtime_error if the record found holds another key.
+     */
+    template <typename Source>
+    static bool read_packed(const Source& src, const entities::ObjectId& key, PackedObject& out,
+                            ObjectType* type, int hops) {
+        std::uint64_t off = src.find_offset(key);
+        if (off == UINT64_MAX) return false;
+
+        std::shared_ptr<MappedFile> map = src.mapping(off + kRecordHeader);
+        const unsigned char* hdr = map->data() + off;
+        if (hdr[1] != kKeySize || std::memcmp(hdr + 2, key.data(), kKeySize) != 0) {
+            throw std::runtime_error("ObjectStore: record at offset " + std::to_string(off) +
+                                     " does not hold " + key.short_hex());
+        }
+        std::uint8_t type_byte = hdr[0];
+        std::uint64_t size = binary_io::load_u64(hdr + 2 + kKeySize);
+        std::uint64_t payload = off + kRecordHeader;
+        if (type) *type = static_cast<ObjectType>(type_byte & ~kEncodedFlag);
+        if (hops == 0 && (type_byte & ~kEncodedFlag) == static_cast<std::uint8_t>(ObjectType::BLOB)) {
+            Stats::count(Counter::BLOBS_READ);
+        }
+
+        if (map->size() < payload + size) map = src.mapping(payload + size);
+        const unsigned char* p = map->data() + payload;
+
+        out = PackedObject();
+        if (type_byte & kEncodedFlag) {
+            if (size < kEncodedHeader) throw std::runtime_error("ObjectStore: corrupt record " + key.short_hex());
+            out.codec = static_cast<Codec>(p[0]);
+            bool has_dict = p[2] & 1;
+            bool has_base = p[2] & 2;
+            out.raw_size = binary_io::load_u64(p + 3);
+            std::uint64_t skip = kEncodedHeader + (has_dict ? kKeySize : 0) + (has_base ? kKeySize : 0);
+            bool known = ((out.codec == Codec::LZ || out.codec == Codec::LZ_FRAMES) && !has_base) ||
+                         (out.codec == Codec::DELTA && has_base) ||
+                         (out.codec == Codec::CHUNKED && !has_base && !has_dict);
+            if (!known || size < skip) {
+                throw std::runtime_error("ObjectStore: unsupported encoding in " + key.short_hex());
+            }
+            if (has_dict) out.dict = src.dictionary(entities::ObjectId::from_bytes(p + kEncodedHeader));
+            if (has_base) {
+                if (hops >= kMaxDeltaDepth) throw std::runtime_error("ObjectStore: delta chain too deep at " + key.short_hex());
+                entities::ObjectId base_id = entities::ObjectId::from_bytes(p + skip - kKeySize);
+                auto base = std::make_shared<PackedObject>();
+                if (!read_packed(src, base_id, *base, nullptr, hops + 1)) {
+                    throw std::runtime_error("ObjectStore: missing delta base of " + key.short_hex());
+                }
+                out.base = std::move(base);
+            }
+            payload += skip;
+            size -= skip;
+            p += skip;
+            if (out.codec == Codec::CHUNKED) {
+                if (size % kChunkEntry) throw std::runtime_error("ObjectStore: corrupt chunk list in " + key.short_hex());
+                auto parts = std::make_shared<std::vector<PackedObject>>(static_cast<std::size_t>(size / kChunkEntry));
+                for (std::size_t i = 0; i < parts->size(); ++i) {
+                    const unsigned char* e = p + i * kChunkEntry;
+                    ObjectType part_type;
+                    if (!read_packed(src, entities::ObjectId::from_bytes(e), (*parts)[i], &part_type, hops + 1) ||
+                        part_type != ObjectType::CHUNK || (*parts)[i].codec == Codec::CHUNKED ||
+                        (*parts)[i].raw_size != binary_io::load_u32(e + kKeySize)) {
+                        throw std::runtime_error("ObjectStore: missing or damaged chunk of " + key.short_hex());
+                    }
+                }
+                out.parts = std::move(parts);
+            }
+        }
+        int fd = map->fd();
+        out.stored = BlobView(std::move(map), reinterpret_cast<const char*>(p),
+                              static_cast<std::size_t>(size), fd, payload);
+        if (out.codec == Codec::NONE) out.raw_size = size;
+        return true;
+    }
+
+    static void append_record_header(std::string& out, std::uint8_t type_byte, const entities::ObjectId& key,
+                                     std::string_view prefix, std::size_t data_size) {
+        out.push_back(static_cast<char>(type_byte));
+        out.push_back(static_cast<char>(kKeySize));
+        out.append(reinterpret_cast<const char*>(key.data()), kKeySize);
+        binary_io::put_u64(out, prefix.size() + data_size);
+        out.append(prefix);
+    }
+
+    /**
+     * @brief Maps the index file, discarding it if it is malformed.
+     */
+    void load_index() {
+        index_count_ = 0;
+        indexed_pack_size_ = 8;
+        index_stat_ = {};
+        ::stat(index_path_.c_str(), &index_stat_);
+        index_map_ = std::make_shared<MappedFile>();
+        if (!index_map_->open(index_path_)) {
+            index_map_.reset();
+            return;
+        }
+
+        const unsigned char* p = index_map_->data();
+        if (index_map_->size() < kIndexHeader || std::memcmp(p, kIndexMagic, 8) != 0) {
+            index_map_.reset();
+            return;
+        }
+
+        std::uint64_t count = binary_io::load_u64(p + 8);
+        std::uint64_t covered = binary_io::load_u64(p + 16);
+        if (index_map_->size() != kIndexHeader + count * kIndexEntry || covered > pack_size_) {
+            index_map_.reset();
+            return;
+        }
+
+        index_count_ = static_cast<std::size_t>(count);
+        indexed_pack_size_ = covered;
+    }
+
+    /**
+     * @brief Registers records written after the last index flush.
+     *
+     * @details A torn record at the end of the pack (interrupted write) is
+     * truncated away so subsequent appends start from a clean boundary.
+     */
+    void recover_tail() {
+        std::uint64_t off = indexed_pack_size_;
+        unsigned char hdr[kRecordHeader];
+
+        while (off < pack_size_) {
+            if (pack_size_ - off < kRecordHeader) break;
+            pread_exact(hdr, kRecordHeader, off);
+
+            std::size_t key_len = hdr[1];
+            std::uint64_t size = binary_io::load_u64(hdr + 2 + kKeySize);
+            if (key_len != kKeySize || pack_size_ - off - kRecordHeader < size) break;
+
+            entities::ObjectId key = entities::ObjectId::from_bytes(hdr + 2);
+            if (pending_.insert(key, off)) pending_order_.emplace_back(key, off);
+            off += kRecordHeader + size;
+        }
+
+        if (off < pack_size_) {
+            if (::ftruncate(pack_fd_, static_cast<off_t>(off)) != 0) {
+                throw std::runtime_error("ObjectStore: cannot truncate torn pack " + pack_path_);
+            }
+            pack_size_ = off;
+        }
+    }
+
+    static bool same_file(const struct stat& a, const struct stat& b) {
+        return a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+    }
+
+    /**
+     * @brief Catches up with writes other processes made since this one
+     * last held the lock.
+     * @details A pack replaced by a repack is reopened; a pack that grew or
+     * an index that was rewritten is re-read, and the unindexed tail, this
+     * process's own records included, is registered again.
+     */
+    void refresh() {
+        struct stat pack;
+        if (pack_fd_ < 0 || ::stat(pack_path_.c_str(), &pack) != 0 || !same_file(pack, pack_stat_)) {
+            if (pack_fd_ >= 0) ::close(pack_fd_);
+            pack_fd_ = -1;
+            index_map_.reset();
+            open_pack();
+            return;
+        }
+        struct stat index = {};
+        ::stat(index_path_.c_str(), &index);
+        bool index_unchanged = same_file(index, index_stat_) && index.st_size == index_stat_.st_size &&
+                               index.st_mtime == index_stat_.st_mtime;
+        if (static_cast<std::uint64_t>(pack.st_size) == pack_size_ && index_unchanged) return;
+
+        pack_size_ = static_cast<std::uint64_t>(pack.st_size);
+        pending_.clear();
+        pending_order_.clear();
+        load_index();
+        recover_tail();
+    }
+
+    void lock() {
+        if (lock_depth_++ > 0) return;
+        while (::flock(lock_fd_, LOCK_EX) != 0) {
+            if (errno == EINTR) continue;
+            lock_depth_ = 0;
+            throw std::runtime_error("ObjectStore: cannot lock " + lock_path_);
+        }
+        try {
+            refresh();
+        } catch (...) {
+            unlock();
+            throw;
+        }
+    }
+
+    void unlock() {
+        if (--lock_depth_ == 0) ::flock(lock_fd_, LOCK_UN);
+    }
+
+    /**
+     * @brief Holds the store's write lock for a scope.
+     * * Nests: only the outermost lock takes the flock and refreshes
+     */
+    class WriteLock {
+    private:
+        ObjectStore* store_;
+
+    public:
+        explicit WriteLock(ObjectStore& store) : store_(&store) { store.lock(); }
+        ~WriteLock() { release(); }
+
+        WriteLock(const WriteLock&) = delete;
+        WriteLock& operator=(const WriteLock&) = delete;
+
+        void release() {
+            if (store_) store_->unlock();
+            store_ = nullptr;
+        }
+    };
+
+public:
+    /**
+     * @brief Opens (or creates) the object store in the given directory.
+     * @details Tail recovery runs under the write lock, so a record another
+     * process is still streaming is not mistaken for a torn one.
+     * @param dir Directory holding `pack`, `pack.idx` and `pack.lock`.
+     * @throws std::runtime_error if the pack cannot be opened or locked, or
+     * is not a pack file.
+     */
+    explicit ObjectStore(const std::string& dir)
+        : dir_(dir), pack_fd_(-1), pack_size_(0), index_count_(0), indexed_pack_size_(8) {
+        std::filesystem::create_directories(dir);
+        pack_path_ = dir + "/pack";
+        index_path_ = dir + "/pack.idx";
+        lock_path_ = dir + "/pack.lock";
+        lock_fd_ = ::open(lock_path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (lock_fd_ < 0) throw std::runtime_error("ObjectStore: cannot open " + lock_path_);
+        try {
+            WriteLock lock(*this);
+        } catch (...) {
+            ::close(lock_fd_);
+            throw;
+        }
+    }
+
+private:
+    /**
+     * @brief Opens the pack and index files and recovers unindexed records.
+     */
+    void open_pack() {
+        pack_size_ = 0;
+        index_count_ = 0;
+        indexed_pack_size_ = 8;
+        pack_map_.reset();
+        pending_.clear();
+        pending_order_.clear();
+
+        pack_fd_ = ::open(pack_path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (pack_fd_ < 0) throw std::runtime_error("ObjectStore: cannot open " + pack_path_);
+
+        ::fstat(pack_fd_, &pack_stat_);
+        pack_size_ = static_cast<std::uint64_t>(pack_stat_.st_size);
+
+        if (pack_size_ == 0) {
+            pwrite_exact(kPackMagic, 8, 0);
+            pack_size_ = 8;
+        } else {
+            char magic[8] = {};
+            if (pack_size_ < 8) {
+                ::close(pack_fd_);
+                throw std::runtime_error("ObjectStore: not a pack file: " + pack_path_);
+            }
+            pread_exact(magic, 8, 0);
+            if (std::memcmp(magic, kPackMagic, 8) != 0) {
+                ::close(pack_fd_);
+                throw std::runtime_error("ObjectStore: not a pack file: " + pack_path_);
+            }
+        }
+
+        load_index();
+        recover_tail();
+    }
+
+public:
+    /**
+     * @brief Flushes pending index entries and closes the pack.
+     */
+    ~ObjectStore() {
+        try {
+            flush();
+        } catch (...) {
+            // Pending records remain recoverable from the pack tail.
+        }
+        if (pack_fd_ >= 0) ::close(pack_fd_);
+        ::close(lock_fd_);
+    }
+
+    ObjectStore(const ObjectStore&) = delete;
+    ObjectStore& operator=(const ObjectStore&) = delete;
+
+    /**
+     * @brief Writes one blob into the pack piece by piece.
+     * * Memory use is bounded by one frame (or a few maximum-size chunks),
+     *   whatever the blob size
+     * * No other object may be written until finish() or abort(); the
+     *   destructor aborts an unfinished blob
+     * * Streamed blobs are never stored as deltas
+     * * Holds the write lock from construction to finish() or abort(),
+     *   since the record grows at the end of the pack
+     * * With chunking enabled the blob is cut into CHUNK objects as it
+     *   arrives; chunks already stored are only referenced
+     */
+    class BlobWriter {
+    private:
+        ObjectStore* store_;
+        WriteLock lock_;           ///< Taken before start_ is read
+        std::uint64_t start_;      ///< Offset of the record being written
+        std::uint64_t cursor_;     ///< Where the next bytes go
+        std::uint64_t raw_size_ = 0;
+        std::string header_;       ///< Encoding prefix, or empty for a raw record
+        std::string pending_;      ///< Input not yet written
+        std::size_t pending_pos_ = 0;   ///< Start of the unwritten part of pending_ (chunked)
+        std::string frame_;
+        bool chunked_;
+        FastCdc cdc_;
+        std::string chunk_list_;
+        bool active_ = true;
+
+        void write_out(std::string_view piece) {
+            frame_.clear();
+            if (header_.empty()) {
+                store_->pwrite_exact(piece.data(), piece.size(), cursor_);
+                cursor_ += piece.size();
+                return;
+            }
+            LzCodec::append_frame(frame_, piece, store_->level_,
+                                  store_->dict_ ? std::string_view(*store_->dict_) : std::string_view());
+            store_->pwrite_exact(frame_.data(), frame_.size(), cursor_);
+            cursor_ += frame_.size();
+        }
+
+        void write_chunk(std::string_view piece) {
+            entities::ObjectId id(crypto::Sha256().update("chunk ").update_field(piece).finish());
+            chunk_list_.append(reinterpret_cast<const char*>(id.data()), kKeySize);
+            binary_io::put_u32(chunk_list_, static_cast<std::uint32_t>(piece.size()));
+            if (store_->contains(id)) return;
+
+            std::vector<PendingWrite> one(1, store_->prepare(ObjectType::CHUNK));
+            one[0].key = id;
+            one[0].source = piece;
+            one[0].encode();
+            store_->append_batch(one);
+        }
+
+        /**
+         * @brief Cuts and writes chunks while at least @p keep bytes would remain.
+         */
+        void cut_chunks(std::size_t keep) {
+            while (pending_.size() - pending_pos_ > keep) {
+                std::string_view rest(pending_.data() + pending_pos_, pending_.size() - pending_pos_);
+                std::size_t n = cdc_.cut(rest);
+                write_chunk(rest.substr(0, n));
+                pending_pos_ += n;
+            }
+        }
+
+    public:
+        explicit BlobWriter(ObjectStore& store)
+            : store_(&store), lock_(store), start_(store.pack_size_), chunked_(store.chunk_average_ != 0),
+              cdc_(chunked_ ? store.chunk_average_ : FastCdc::kDefaultAverage) {
+            if (store.streaming_) throw std::runtime_error("ObjectStore: a blob is already being streamed");
+            if (chunked_) {
+                header_.push_back(static_cast<char>(Codec::CHUNKED));
+                header_.push_back(0);
+                header_.push_back(0);
+                binary_io::put_u64(header_, 0);   // raw size, patched in finish()
+            } else if (store.codec_ == Codec::LZ) {
+                header_.push_back(static_cast<char>(Codec::LZ_FRAMES));
+                header_.push_back(static_cast<char>(store.level_));
+                header_.push_back(static_cast<char>(store.dict_ ? 1 : 0));
+                binary_io::put_u64(header_, 0);
+                if (store.dict_) header_.append(reinterpret_cast<const char*>(store.dict_id_.data()), kKeySize);
+            }
+            cursor_ = chunked_ ? start_ : start_ + kRecordHeader + header_.size();
+            pending_.reserve(chunked_ ? 4 * cdc_.max_size() : LzCodec::kFrameSize);
+            store.streaming_ = true;
+        }
+
+        BlobWriter(const BlobWriter&) = delete;
+        BlobWriter& operator=(const BlobWriter&) = delete;
+
+        ~BlobWriter() {
+            try {
+                abort();
+            } catch (...) {
+                // The torn tail is truncated when the pack is next opened.
+            }
+        }
+
+        /**
+         * @brief Appends bytes of the payload.
+         * @throws std::runtime_error if the pack cannot be written.
+         */
+        void write(std::string_view data) {
+            raw_size_ += data.size();
+            if (chunked_) {
+                // Cut points need max_size() bytes of lookahead; the buffer is
+                // compacted only when full, so each byte is moved about once.
+                const std::size_t capacity = 4 * cdc_.max_size();
+                while (!data.empty()) {
+                    if (pending_pos_ > 0 && pending_.size() + data.size() > capacity) {
+                        pending_.erase(0, pending_pos_);
+                        pending_pos_ = 0;
+                    }
+                    std::size_t take = std::min(data.size(), capacity - pending_.size());
+                    pending_.append(data.data(), take);
+                    data.remove_prefix(take);
+                    cut_chunks(cdc_.max_size() - 1);
+                }
+                return;
+            }
+            while (!data.empty()) {
+                if (pending_.empty() && data.size() >= LzCodec::kFrameSize) {
+                    write_out(data.substr(0, LzCodec::kFrameSize));
+                    data.remove_prefix(LzCodec::kFrameSize);
+                    continue;
+                }
+                std::size_t take = std::min(data.size(), LzCodec::kFrameSize - pending_.size());
+                pending_.append(data.data(), take);
+                data.remove_prefix(take);
+                if (pending_.size() == LzCodec::kFrameSize) {
+                    write_out(pending_);
+                    pending_.clear();
+                }
+            }
+        }
+
+        /**
+         * @brief Returns the payload bytes written so far.
+         */
+        std::uint64_t size() const { return raw_size_; }
+
+        /**
+         * @brief Completes the record under @p key.
+         * @details The record header goes last, so the blob only becomes
+         * visible (also to crash recovery) once all of it is in the pack.
+         * @return False if the key was already stored; the new copy is dropped.
+         * @throws std::runtime_error if the pack cannot be written.
+         */
+        bool finish(const entities::ObjectId& key) {
+            if (!active_) throw std::runtime_error("ObjectStore: blob stream already finished");
+            if (store_->contains(key)) {
+                abort();
+                return false;
+            }
+            std::string raw;
+            binary_io::put_u64(raw, raw_size_);
+            if (!header_.empty()) header_.replace(3, 8, raw);
+
+            if (chunked_) {
+                cut_chunks(0);
+                std::vector<PendingWrite> list(1);
+                list[0].key = key;
+                list[0].header = std::move(header_);
+                list[0].body = std::move(chunk_list_);
+                store_->append_batch(list);
+            } else {
+                if (!pending_.empty()) write_out(pending_);
+                std::string head;
+                std::uint8_t type_byte = static_cast<std::uint8_t>(ObjectType::BLOB) | (header_.empty() ? 0 : kEncodedFlag);
+                std::size_t body = static_cast<std::size_t>(cursor_ - start_ - kRecordHeader - header_.size());
+                append_record_header(head, type_byte, key, header_, body);
+                store_->pwrite_exact(head.data(), head.size(), start_);
+
+                store_->pending_.put(key, start_);
+                store_->pending_order_.emplace_back(key, start_);
+                store_->pack_size_ = cursor_;
+                Stats::count(Counter::BLOBS_WRITTEN);
+            }
+            pending_ = std::string();
+            frame_ = std::string();
+            store_->streaming_ = false;
+            active_ = false;
+            if (store_->pending_order_.size() >= kFlushThreshold) store_->flush();
+            lock_.release();
+            return true;
+        }
+
+        /**
+         * @brief Discards everything written so far.
+         */
+        void abort() {
+            if (!active_) return;
+            active_ = false;
+            store_->streaming_ = false;
+            // Chunks already written are complete records; gc drops them if unused.
+            bool truncated = chunked_ || cursor_ <= start_ ||
+                             ::ftruncate(store_->pack_fd_, static_cast<off_t>(start_)) == 0;
+            lock_.release();
+            if (!truncated) throw std::runtime_error("ObjectStore: cannot truncate " + store_->pack_path_);
+        }
+    };
+
+    /**
+     * @brief Checks whether an object with this key is stored.
+     */
+    bool contains(const entities::ObjectId& key) const {
+        return find_offset(key) != UINT64_MAX;
+    }
+
+    /**
+     * @brief Appends an object unless the key is already present.
+     * @param type Object kind.
+     * @param key Content address.
+     * @param data Object payload.
+     */
+    void put(ObjectType type, const entities::ObjectId& key, const std::string& data) {
+        put(type, key, data, entities::ObjectId());
+    }
+
+    /**
+     * @brief Appends an object, delta-encoding it against @p base when worthwhile.
+     *
+     * @details The smallest of the raw payload, the compressed payload and a
+     * delta against @p base is stored. A delta is only considered for blobs
+     * whose base is a stored blob with a chain shorter than max_delta_depth().
+     *
+     * @param type Object kind.
+     * @param key Content address.
+     * @param data Object payload.
+     * @param base Suggested delta base, or the null id.
+     */
+    void put(ObjectType type, const entities::ObjectId& key, const std::string& data,
+             const entities::ObjectId& base) {
+        if (contains(key)) return;
+        if (type == ObjectType::BLOB && chunks(data.size())) {
+            BlobWriter writer(*this);
+            writer.write(data);
+            writer.finish(key);
+            return;
+        }
+
+        std::vector<PendingWrite> batch(1, prepare(type, base));
+        batch[0].key = key;
+        batch[0].source = data;
+        batch[0].encode();
+        write_batch(batch);
+        if (pending_order_.size() >= kFlushThreshold) flush();
+    }
+
+    /**
+     * @brief Starts a write with the current encoding settings.
+     * @details A delta base is kept only if it is a stored blob whose chain
+     * is shorter than max_delta_depth(); it stays readable while the write
+     * is encoded elsewhere.
+     * @param type Object kind.
+     * @param base Suggested delta base, or the null id.
+     */
+    PendingWrite prepare(ObjectType type, const entities::ObjectId& base = entities::ObjectId()) const {
+        PendingWrite w;
+        w.type = type;
+        if (type != ObjectType::BLOB && type != ObjectType::CHUNK) return w;
+        w.codec = codec_;
+        w.level = level_;
+        w.dict_id = dict_id_;
+        w.dict = dict_;
+        if (type != ObjectType::BLOB || base.is_null()) return w;
+
+        ObjectType base_type;
+        int depth = delta_depth(base);
+        if (depth < max_delta_depth_ && get_packed(base, w.base, &base_type) && base_type == ObjectType::BLOB) {
+            w.base_id = base;
+            w.base_depth = depth;
+        } else {
+            w.base = PackedObject();
+        }
+        return w;
+    }
+
+    /**
+     * @brief Appends encoded writes with a single write call.
+     * @details Keys already stored, or repeated in @p batch, are skipped.
+     * The records become durable with the next flush().
+     * @param batch Writes whose encode() has run.
+     * @throws std::runtime_error if the pack cannot be written.
+     */
+    void write_batch(const std::vector<PendingWrite>& batch) {
+        if (streaming_) throw std::runtime_error("ObjectStore: write while a blob is being streamed");
+        append_batch(batch);
+    }
+
+private:
+    void append_batch(const std::vector<PendingWrite>& batch) {
+        WriteLock lock(*this);
+        // Record headers go into one buffer; payloads are written from where they are.
+        std::string heads;
+        std::vector<std::pair<std::size_t, std::string_view>> records;   // header offset, payload
+        std::uint64_t off = pack_size_;
+        for (const PendingWrite& w : batch) {
+            if (contains(w.key)) continue;
+            std::uint8_t type_byte = static_cast<std::uint8_t>(w.type) | (w.header.empty() ? 0 : kEncodedFlag);
+            std::string_view stored = w.stored();
+            if (w.type == ObjectType::BLOB) Stats::count(Counter::BLOBS_WRITTEN);
+            pending_.put(w.key, off);
+            pending_order_.emplace_back(w.key, off);
+            records.emplace_back(heads.size(), stored);
+            append_record_header(heads, type_byte, w.key, w.header, stored.size());
+            off += kRecordHeader + w.header.size() + stored.size();
+        }
+        if (records.empty()) return;
+
+        std::vector<iovec> iov;
+        iov.reserve(records.size() * 2);
+        for (std::size_t r = 0; r < records.size(); ++r) {
+            std::size_t end = r + 1 < records.size() ? records[r + 1].first : heads.size();
+            iov.push_back(iovec{const_cast<char*>(heads.data() + records[r].first), end - records[r].first});
+            if (!records[r].second.empty()) {
+                iov.push_back(iovec{const_cast<char*>(records[r].second.data()), records[r].second.size()});
+            }
+        }
+        pwritev_exact(iov, pack_size_);
+        pack_size_ = off;
+    }
+
+public:
+
+    /**
+     * @brief Sets the longest delta chain new records may create.
+     * @param depth Maximum depth (0 disables deltas).
+     */
+    void set_max_delta_depth(int depth) { max_delta_depth_ = std::clamp(depth, 0, kMaxDeltaDepth); }
+    int max_delta_depth() const { return max_delta_depth_; }
+
+    /**
+     * @brief Selects how blobs written from now on are encoded.
+     *
+     * @details Existing records keep the encoding they were written with;
+     * every record names its own codec, so stores may mix them freely.
+     *
+     * @param codec Codec for new blobs.
+     * @param level Compression level (LzCodec::kMinLevel..kMaxLevel).
+     * @param dict_id Stored dictionary to compress against, or the null id.
+     * @throws std::runtime_error if @p dict_id is not a stored dictionary.
+     */
+    void set_compression(Codec codec, int level, const entities::ObjectId& dict_id = entities::ObjectId()) {
+        codec_ = codec;
+        level_ = std::clamp(level, LzCodec::kMinLevel, LzCodec::kMaxLevel);
+        dict_id_ = dict_id;
+        dict_ = dict_id.is_null() ? nullptr : dictionary(dict_id);
+    }
+
+    /**
+     * @brief Enables content-defined chunking for large blobs written from now on.
+     * @details Blobs of at least eight average chunk sizes are split with
+     * FastCDC; smaller ones are stored as before.
+     * @param average Average chunk size (see FastCdc), or 0 to disable.
+     * @throws std::runtime_error if @p average is not a valid chunk size.
+     */
+    void set_chunking(std::size_t average) {
+        if (average) (void)FastCdc(average);
+        chunk_average_ = average;
+    }
+
+    std::size_t chunking() const { return chunk_average_; }
+
+    /**
+     * @brief Tells whether a new blob of @p size bytes would be chunked.
+     */
+    bool chunks(std::uint64_t size) const { return chunk_average_ && size >= 8 * std::uint64_t(chunk_average_); }
+
+    /**
+     * @brief Stores a compression dictionary and returns its id.
+     * @param bytes Dictionary content (see LzCodec::train_dictionary()).
+     */
+    entities::ObjectId put_dictionary(const std::string& bytes) {
+        entities::ObjectId id(crypto::Sha256().update("dict ").update_field(bytes).finish());
+        put(ObjectType::DICTIONARY, id, bytes);
+        return id;
+    }
+
+    /**
+     * @brief Returns a zero-copy view of an object payload.
+     * @details The view points into the memory-mapped pack and keeps that
+     * mapping alive, so it stays valid after further appends or remaps.
+     * @param key Content key.
+     * @param[out] out Receives the view.
+     * @param[out] type Optional; receives the object kind.
+     * @return True if the object exists.
+     */
+    bool get_view(const entities::ObjectId& key, BlobView& out, ObjectType* type = nullptr) const {
+        PackedObject obj;
+        if (!get_packed(key, obj, type)) return false;
+        out = obj.open();
+        return true;
+    }
+
+    /**
+     * @brief Locates an object payload without decoding it.
+     * @details Use PackedObject::open() to obtain the bytes, possibly later
+     * or on another thread.
+     * @param key Content key.
+     * @param[out] out Receives the stored payload and how to decode it.
+     * @param[out] type Optional; receives the object kind.
+     * @return True if the object exists.
+     * @throws std::runtime_error if the record header is corrupt.
+     */
+    bool get_packed(const entities::ObjectId& key, PackedObject& out, ObjectType* type = nullptr) const {
+        return get_packed_at(key, out, type, 0);
+    }
+
+
+    /**
+     * @brief Reads an object payload into a string.
+     * @param key Content key.
+     * @param[out] out Receives the payload.
+     * @param[out] type Optional; receives the object kind.
+     * @return True if the object exists.
+     */
+    bool get(const entities::ObjectId& key, std::string& out, ObjectType* type = nullptr) const {
+        BlobView view;
+        if (!get_view(key, view, type)) return false;
+        out.assign(view.data(), view.size());
+        Stats::count(Counter::BYTES_COPIED, view.size());
+        return true;
+    }
+
+    /**
+     * @brief Immutable view of the objects stored when it was taken.
+     * * Holds its own references to the pack and index mappings, so appends,
+     *   index rewrites, repacks and even closing the store leave it intact
+     * * Every method is const and may be called from any number of threads
+     */
+    class Snapshot {
+    private:
+        friend class ObjectStore;
+        using Dictionaries = data_structures::HashTable<entities::ObjectId, std::shared_ptr<const std::string>>;
+        using Recent = std::vector<std::pair<entities::ObjectId, std::uint64_t>>;
+
+        std::shared_ptr<MappedFile> pack_;
+        std::uint64_t end_ = 0;
+        std::shared_ptr<MappedFile> index_;
+        std::size_t index_count_ = 0;
+        std::shared_ptr<const Recent> recent_ = std::make_shared<const Recent>();   ///< Unindexed records, sorted
+        std::shared_ptr<const Dictionaries> dicts_ = std::make_shared<const Dictionaries>();
+
+    public:
+        std::uint64_t find_offset(const entities::ObjectId& key) const {
+            auto it = std::lower_bound(recent_->begin(), recent_->end(), key,
+                                       [](const auto& e, const entities::ObjectId& k) { return e.first < k; });
+            if (it != recent_->end() && it->first == key) return it->second;
+            return index_lookup(index_.get(), index_count_, key);
+        }
+
+        std::shared_ptr<MappedFile> mapping(std::uint64_t end) const {
+            if (!pack_ || end > end_ || end > pack_->size()) {
+                throw std::runtime_error("ObjectStore: record beyond the end of the snapshot");
+            }
+            return pack_;
+        }
+
+        /**
+         * @brief Returns a dictionary cached when the snapshot was taken, or loads it.
+         */
+        std::shared_ptr<const std::string> dictionary(const entities::ObjectId& id) const {
+            if (auto* cached = dicts_->find(id)) return *cached;
+            PackedObject obj;
+            ObjectType type;
+            if (!get_packed(id, obj, &type) || type != ObjectType::DICTIONARY) {
+                throw std::runtime_error("ObjectStore: missing dictionary " + id.short_hex());
+            }
+            return std::make_shared<const std::string>(obj.stored.to_string());
+        }
+
+        bool contains(const entities::ObjectId& key) const { return find_offset(key) != UINT64_MAX; }
+
+        /**
+         * @see ObjectStore::get_packed()
+         */
+        bool get_packed(const entities::ObjectId& key, PackedObject& out, ObjectType* type = nullptr) const {
+            return read_packed(*this, key, out, type, 0);
+        }
+
+        /**
+         * @see ObjectStore::get()
+         */
+        bool get(const entities::ObjectId& key, std::string& out, ObjectType* type = nullptr) const {
+            PackedObject obj;
+            if (!get_packed(key, obj, type)) return false;
+            BlobView view = obj.open();
+            out.assign(view.data(), view.size());
+            Stats::count(Counter::BYTES_COPIED, view.size());
+            return true;
+        }
+    };
+
+    /**
+     * @brief Captures the objects stored so far for lock-free reading.
+     * @details Costs one remap if the pack grew and a sort of the records
+     * written since the last flush(); nothing else is copied. If another
+     * process has replaced the pack, the new pack and its index are loaded
+     * first, so the snapshot's mapping and index always describe one file.
+     */
+    Snapshot snapshot() {
+        struct stat pack;
+        if (lock_depth_ == 0 && (::stat(pack_path_.c_str(), &pack) != 0 || !same_file(pack, pack_stat_))) {
+            WriteLock relock(*this);   // refresh() reopens the pack and re-reads the index
+        }
+        Snapshot snap;
+        snap.end_ = pack_size_;
+        snap.pack_ = mapping(pack_size_);
+        snap.index_ = index_map_;
+        snap.index_count_ = index_count_;
+        if (!pending_order_.empty()) {
+            auto recent = std::make_shared<Snapshot::Recent>(pending_order_);
+            std::sort(recent->begin(), recent->end());
+            snap.recent_ = std::move(recent);
+        }
+        if (dicts_.size()) snap.dicts_ = std::make_shared<const Snapshot::Dictionaries>(dicts_);
+        return snap;
+    }
+
+    /**
+     * @brief Lists the ids of all stored objects (indexed first, then pending).
+     */
+    std::vector<entities::ObjectId> object_ids() const {
+        std::vector<entities::ObjectId> ids;
+        ids.reserve(size());
+        const unsigned char* entries = index_count_ ? index_map_->data() + kIndexHeader : nullptr;
+        for (std::size_t i = 0; i < index_count_; ++i) {
+            ids.push_back(entities::ObjectId::from_bytes(entries + i * kIndexEntry));
+        }
+        for (const auto& p : pending_order_) ids.push_back(p.first);
+        return ids;
+    }
+
+    /**
+     * @brief Rewrites the pack, re-encoding blobs against the given bases.
+     *
+     * @details Every object is decoded and written to a fresh pack in a
+     * temporary directory; blobs listed in @p bases are offered that base
+     * (which is written first), all others are stored without a delta. The
+     * new pack then replaces the old one: the old index is removed first, so
+     * an interrupted swap leaves a pack that is re-indexed by scanning.
+     * Outstanding BlobViews stay valid.
+     *
+     * With @p keep the pass also collects garbage: only the listed objects
+     * are written, in the given order, and the only dictionary carried over
+     * is the one new blobs are compressed with (everything is re-encoded, so
+     * older dictionaries are no longer referenced). A preferred base that is
+     * not kept is ignored.
+     *
+     * @param bases Blob id → preferred delta base.
+     * @param keep Objects to retain in write order, or nullptr to keep all.
+     * @return Size of the new pack in bytes.
+     * @throws std::runtime_error if the new pack cannot be written or installed.
+     */
+    std::uint64_t repack(const data_structures::HashTable<entities::ObjectId, entities::ObjectId>& bases,
+                         const std::vector<entities::ObjectId>* keep = nullptr) {
+        WriteLock lock(*this);
+        flush();
+        std::string tmp_dir = dir_ + "/repack.tmp";
+        std::filesystem::remove_all(tmp_dir);
+
+        std::vector<entities::ObjectId> ids = keep ? *keep : object_ids();
+        data_structures::HashTable<entities::ObjectId, bool> kept(keep ? keep->size() : 0);
+        if (keep) {
+            for (const auto& id : *keep) kept.put(id, true);
+        }
+        std::uint64_t new_size;
+        {
+            ObjectStore fresh(tmp_dir);
+            fresh.set_max_delta_depth(max_delta_depth_);
+
+            std::string data;
+            ObjectType type;
+            if (keep) {
+                if (!dict_id_.is_null() && get(dict_id_, data, &type)) fresh.put(type, dict_id_, data);
+            } else {
+                // Only the header's type byte is read; other records are not decoded.
+                for (const auto& id : ids) {
+                    if (stored_type(id, type) && type == ObjectType::DICTIONARY && get(id, data, &type)) {
+                        fresh.put(type, id, data);
+                    }
+                }
+            }
+            fresh.set_compression(codec_, level_, dict_id_);
+            fresh.set_chunking(chunk_average_);
+
+            // States: absent = not written, false = being written, true = written.
+            data_structures::HashTable<entities::ObjectId, bool> done(ids.size());
+            std::vector<entities::ObjectId> chain;
+            for (const auto& start : ids) {
+                if (done.contains(start)) continue;
+                // Follow the preferred bases down, then write from the bottom up.
+                chain.clear();
+                for (entities::ObjectId id = start; !done.contains(id);) {
+                    chain.push_back(id);
+                    done.put(id, false);
+                    const entities::ObjectId* b = bases.find(id);
+                    if (!b || !contains(*b) || (keep && !kept.contains(*b))) break;
+                    id = *b;
+                }
+                for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+                    if (!get(*it, data, &type)) continue;
+                    const entities::ObjectId* b = bases.find(*it);
+                    bool usable = b && fresh.contains(*b);
+                    fresh.put(type, *it, data, usable ? *b : entities::ObjectId());
+                    done.put(*it, true);
+                }
+            }
+            fresh.flush();
+            new_size = fresh.pack_size_;
+        }
+
+        ::close(pack_fd_);
+        pack_fd_ = -1;
+        index_map_.reset();
+        std::filesystem::remove(index_path_);
+        std::filesystem::rename(tmp_dir + "/pack", pack_path_);
+        std::filesystem::rename(tmp_dir + "/pack.idx", index_path_);
+        std::filesystem::remove_all(tmp_dir);
+        dicts_.clear();
+        open_pack();
+        return new_size;
+    }
+
+    /**
+     * @brief Returns the current size of the pack file in bytes.
+     */
+    std::uint64_t pack_size() const { return pack_size_; }
+
+    /**
+     * @brief Returns the number of stored objects.
+     */
+    std::size_t size() const { return index_count_ + pending_order_.size(); }
+
+    /**
+     * @brief Merges pending records into the sorted index and rewrites it atomically.
+     *
+     * @details The new index is written to a temporary file, synced and renamed
+     * over the old one; the pack is synced first so the index never refers to
+     * data that is not durable.
+     */
+    void flush() {
+        if (pending_order_.empty()) return;
+        WriteLock lock(*this);
+        if (pending_order_.empty()) return;   // another process indexed them
+
+        ::fsync(pack_fd_);
+
+        std::vector<std::pair<entities::ObjectId, std::uint64_t>> fresh = pending_order_;
+        std::sort(fresh.begin(), fresh.end());
+
+        std::string out;
+        out.reserve(kIndexHeader + (index_count_ + fresh.size()) * kIndexEntry);
+        out.append(kIndexMagic, 8);
+        binary_io::put_u64(out, index_count_ + fresh.size());
+        binary_io::put_u64(out, pack_size_);
+
+        const unsigned char* old = index_count_ ? index_map_->data() + kIndexHeader : nullptr;
+        std::size_t i = 0, j = 0;
+        while (i < index_count_ || j < fresh.size()) {
+            bool take_old = j == fresh.size() ||
+                (i < index_count_ && std::memcmp(old + i * kIndexEntry, fresh[j].first.data(), kKeySize) < 0);
+            if (take_old) {
+                out.append(reinterpret_cast<const char*>(old + i * kIndexEntry), kIndexEntry);
+                ++i;
+            } else {
+                out.append(reinterpret_cast<const char*>(fresh[j].first.data()), kKeySize);
+                binary_io::put_u64(out, fresh[j].second);
+                ++j;
+            }
+        }
+
+        std::string tmp = index_path_ + ".tmp";
+        int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw std::runtime_error("ObjectStore: cannot write " + tmp);
+        std::size_t done = 0;
+        while (done < out.size()) {
+            ssize_t w = ::write(fd, out.data() + done, out.size() - done);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) {
+                ::close(fd);
+                throw std::runtime_error("ObjectStore: cannot write " + tmp);
+            }
+            done += static_cast<std::size_t>(w);
+        }
+        ::fsync(fd);
+        ::close(fd);
+
+        index_map_.reset();
+        if (std::rename(tmp.c_str(), index_path_.c_str()) != 0) {
+            load_index();
+            throw std::runtime_error("ObjectStore: cannot replace " + index_path_);
+        }
+
+        pending_.clear();
+        pending_order_.clear();
+        load_index();
+    }
+};
+
+} // namespace core
@@ -0,0 +1,77 @@
+/**
+ * @file Pager.h
+ * @brief Streams long command output through an external pager.
+ *
+ * @details The pager command is taken from `TRI_PAGER`, then `PAGER`, and
+ * defaults to `less -FRX` (quit if one screen, keep colors, leave the
+ * output on screen). An empty value or `cat` disables paging. Output is
+ * only paged when standard output is a terminal.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.0
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <iostream>
+#include <unistd.h>
+
+namespace core {
+
+/**
+ * @brief Output sink that is a pager process or standard output.
+ * * write() reports when the reader went away (the user quit the pager), so
+ *   producers can stop early instead of computing output nobody reads
+ * * The pager is waited for when the object is destroyed
+ */
+class Pager {
+private:
+    FILE* pipe_ = nullptr;
+    void (*previous_sigpipe_)(int) = SIG_DFL;
+
+public:
+    /**
+     * @brief Starts the pager if @p enable is set and stdout is a terminal.
+     */
+    explicit Pager(bool enable) {
+        if (!enable || !::isatty(STDOUT_FILENO)) return;
+
+        const char* cmd = std::getenv("TRI_PAGER");
+        if (!cmd) cmd = std::getenv("PAGER");
+        if (!cmd) cmd = "less -FRX";
+        if (!*cmd || std::string(cmd) == "cat") return;
+
+        std::cout.flush();
+        previous_sigpipe_ = std::signal(SIGPIPE, SIG_IGN);   // a closed pager must not kill us
+        pipe_ = ::popen(cmd, "w");
+        if (!pipe_) std::signal(SIGPIPE, previous_sigpipe_);
+    }
+
+    Pager(const Pager&) = delete;
+    Pager& operator=(const Pager&) = delete;
+
+    ~Pager() {
+        if (!pipe_) return;
+        ::pclose(pipe_);
+        std::signal(SIGPIPE, previous_sigpipe_);
+    }
+
+    /**
+     * @brief Writes @p text and hands it to the reader right away.
+     * @return False once the output can no longer be delivered.
+     */
+    bool write(const std::string& text) {
+        if (!pipe_) {
+            std::cout << text << std::flush;
+            return static_cast<bool>(std::cout);
+        }
+        return std::fwrite(text.data(), 1, text.size(), pipe_) == text.size() && std::fflush(pipe_) == 0;
+    }
+};
+
+} // namespace core
@@ -0,0 +1,206 @@
+/**
+ * @file ReadSnapshot.h
+ * @brief Immutable, thread-safe view of the history and objects of a repository.
+ *
+ * @details GraphManager is driven by a single thread and hands out mutable,
+ * lazily resolved Commit objects. For read-heavy services it also publishes
+ * a ReadSnapshot after every commit and flush: an ObjectStore::Snapshot of
+ * the pack and index mappings plus a CommitGraphView of the append-only
+ * commit graph. Nothing a published snapshot refers to is ever modified,
+ * so queries on it take no locks and never wait for a committer, and an
+ * old snapshot is freed when its last reader drops it (reference-counted
+ * reclamation, in the style of RCU).
+ *
+ * Publishing and taking a snapshot are not lock-free: they use
+ * std::atomic_store / std::atomic_load on a shared_ptr, which libstdc++
+ * implements with a small pool of mutexes picked by address. Taking a
+ * snapshot therefore holds such a mutex for one reference-count increment,
+ * and may briefly wait for a concurrent publish or another reader. Readers
+ * that run many queries should take one snapshot and reuse it.
+ *
+ * Queries return plain values (CommitInfo, strings, ids) rather than Commit
+ * pointers, so no lazily filled state is shared between threads.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.1
+ * @date 2026-10-14
+ * @lastModified 2026-10-14
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <queue>
+#include <ctime>
+#include <cstdint>
+#include <stdexcept>
+#include "ObjectStore.h"
+#include "BinaryIO.h"
+#include "CommitGraph.h"
+#include "../data_structures/HashTable.h"
+#include "../entities/ObjectId.h"
+
+namespace core {
+
+/**
+ * @brief Decoded fields of a commit object.
+ */
+struct CommitInfo {
+    entities::ObjectId id;
+    std::string message;
+    std::string author;
+    std::time_t time = 0;
+    entities::ObjectId tree;
+    entities::ObjectId parent1;   ///< Null for a root commit
+    entities::ObjectId parent2;   ///< Null unless a merge
+
+    /**
+     * @brief Parses a commit object payload.
+     * @throws std::runtime_error if the payload is truncated.
+     */
+    static CommitInfo decode(const entities::ObjectId& id, std::string_view payload) {
+        binary_io::ByteReader in(payload.data(), payload.size());
+        CommitInfo c;
+        c.id = id;
+        c.message = in.string();
+        c.author = in.string();
+        c.time = static_cast<std::time_t>(in.u64());
+        c.tree = entities::ObjectId::from_bytes(in.raw(entities::ObjectId::size()));
+        c.parent1 = entities::ObjectId::from_bytes(in.raw(entities::ObjectId::size()));
+        c.parent2 = entities::ObjectId::from_bytes(in.raw(entities::ObjectId::size()));
+        return c;
+    }
+};
+
+/**
+ * @brief Read-only repository state as of one publication.
+ * * Every method is const and safe to call from any number of threads
+ * * Commits and objects added after the snapshot was published are not visible
+ * * Ancestry queries need the commits to be in the commit graph, which holds
+ *   every commit added through GraphManager
+ */
+class ReadSnapshot {
+private:
+    ObjectStore::Snapshot objects_;
+    CommitGraphView graph_;
+
+    std::uint32_t position(const entities::ObjectId& id) const {
+        std::uint32_t pos = graph_.find(id);
+        if (pos == CommitGraph::kNone) throw std::runtime_error("Commit not in the commit graph: " + id.short_hex());
+        return pos;
+    }
+
+public:
+    ReadSnapshot(ObjectStore::Snapshot objects, CommitGraphView graph)
+        : objects_(std::move(objects)), graph_(std::move(graph)) {}
+
+    /**
+     * @brief Returns the commit graph as of this snapshot.
+     */
+    const CommitGraphView& commit_graph() const { return graph_; }
+
+    /**
+     * @brief Reads and decodes a commit.
+     * @return False if no commit with this id is stored.
+     */
+    bool get_commit(const entities::ObjectId& id, CommitInfo& out) const {
+        std::string payload;
+        ObjectType type;
+        if (!objects_.get(id, payload, &type) || type != ObjectType::COMMIT) return false;
+        out = CommitInfo::decode(id, payload);
+        return true;
+    }
+
+    /**
+     * @brief Returns stored blob content, or "" if the blob is unknown.
+     */
+    std::string get_blob_content(const entities::ObjectId& id) const {
+        std::string content;
+        return objects_.get(id, content) ? content : "";
+    }
+
+    /**
+     * @brief Returns a zero-copy view of a blob; empty if the blob is unknown.
+     */
+    BlobView get_blob_view(const entities::ObjectId& id) const {
+        PackedObject obj;
+        return objects_.get_packed(id, obj) ? obj.open() : BlobView();
+    }
+
+    /**
+     * @brief Checks whether @p ancestor is reachable from @p descendant.
+     * @throws std::runtime_error if a commit is not in the commit graph.
+     */
+    bool is_ancestor(const entities::ObjectId& ancestor, const entities::ObjectId& descendant) const {
+        return graph_.is_ancestor(position(ancestor), position(descendant));
+    }
+
+    /**
+     * @brief Finds every best common ancestor of two commits, best first.
+     * @throws std::runtime_error if a commit is not in the commit graph.
+     * @see CommitGraphView::merge_bases()
+     */
+    std::vector<entities::ObjectId> merge_bases(const entities::ObjectId& a, const entities::ObjectId& b) const {
+        std::vector<entities::ObjectId> out;
+        for (std::uint32_t pos : graph_.merge_bases(position(a), position(b))) out.push_back(graph_.id(pos));
+        return out;
+    }
+
+    /**
+     * @brief Finds a best common ancestor, or the null id if the histories are unrelated.
+     * @throws std::runtime_error if a commit is not in the commit graph.
+     */
+    entities::ObjectId merge_base(const entities::ObjectId& a, const entities::ObjectId& b) const {
+        std::uint32_t pos = graph_.merge_base(position(a), position(b));
+        return pos == CommitGraph::kNone ? entities::ObjectId() : graph_.id(pos);
+    }
+
+    /**
+     * @brief Lists the history of @p tip newest first, like Repository::log().
+     * @details Commits are ordered by time, then generation, and only the
+     * commits returned (plus the parents queued behind them) are decoded.
+     * @param tip Starting commit.
+     * @param max_count Stop after this many commits (0 = no limit).
+     * @throws std::runtime_error if a commit is missing.
+     */
+    std::vector<CommitInfo> log(const entities::ObjectId& tip, std::size_t max_count = 0) const {
+        struct Item {
+            std::int64_t time;
+            std::uint32_t generation;
+            std::size_t index;
+        };
+        auto older = [](const Item& a, const Item& b) {
+            if (a.time != b.time) return a.time < b.time;
+            return a.generation < b.generation;
+        };
+
+        std::vector<CommitInfo> commits;
+        std::priority_queue<Item, std::vector<Item>, decltype(older)> queue(older);
+        data_structures::HashTable<entities::ObjectId, bool> seen;
+        auto push = [&](const entities::ObjectId& id) {
+            if (id.is_null() || !seen.insert(id, true)) return;
+            CommitInfo c;
+            if (!get_commit(id, c)) throw std::runtime_error("Missing commit object: " + id.to_hex());
+            std::uint32_t pos = graph_.find(id);
+            queue.push(Item{static_cast<std::int64_t>(c.time), pos == CommitGraph::kNone ? 0 : graph_.generation(pos),
+                            commits.size()});
+            commits.push_back(std::move(c));
+        };
+
+        std::vector<CommitInfo> out;
+        push(tip);
+        while (!queue.empty() && (!max_count || out.size() < max_count)) {
+            std::size_t i = queue.top().index;
+            queue.pop();
+            const entities::ObjectId p1 = commits[i].parent1, p2 = commits[i].parent2;
+            push(p1);
+            push(p2);
+            out.push_back(std::move(commits[i]));
+        }
+        return out;
+    }
+};
+
+} // namespace core
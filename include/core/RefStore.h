@@ -0,0 +1,410 @@
+/**
+ * @file RefStore.h
+ * @brief On-disk branch references: a packed-refs file plus loose refs.
+ *
+ * @details References live under the repository directory:
+ *
+ * - `HEAD`            : `ref: <branch>`, the checked-out branch
+ * - `refs/heads/<b>`  : loose ref, one commit id in hex
+ * - `packed-refs`     : `# tri packed-refs sorted` followed by
+ *                       `<commit-id> <branch>` lines sorted by name
+ *
+ * A loose ref overrides the packed entry of the same name. Lookups check the
+ * loose file and then binary-search the memory-mapped packed-refs file, so
+ * finding one branch among thousands reads a handful of lines.
+ *
+ * Every update touches one ref only. The writer creates `<ref>.lock` with
+ * O_EXCL, checks that the ref still has the value it expects, writes the new
+ * value into the lock file, syncs it and renames it over the ref. Processes
+ * updating different branches never contend; two updates of the same branch
+ * are serialized by the lock, and the loser of a race sees the value it
+ * expected is gone and fails instead of overwriting the winner.
+ *
+ * pack() folds loose refs into packed-refs under `packed-refs.lock`, then
+ * deletes each loose ref (under its own lock) that still has the packed value.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.0
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "MappedFile.h"
+#include "../entities/ObjectId.h"
+
+namespace core {
+
+/**
+ * @brief Branch tips and HEAD stored as files.
+ * * Reads never take locks; writers lock only the ref they change
+ * * Values are compared and swapped atomically with respect to other
+ *   RefStore writers, in this or any other process
+ */
+class RefStore {
+private:
+    static constexpr std::string_view kPackedHeader = "# tri packed-refs sorted\n";
+    static constexpr std::string_view kHeadPrefix = "ref: ";
+    static constexpr std::size_t kHexSize = 2 * entities::ObjectId::size();
+
+    /**
+     * @brief Exclusive `<path>.lock` file that replaces @p path on commit().
+     * @details The lock is removed on destruction unless it was committed.
+     */
+    class LockFile {
+    private:
+        std::string path_;
+        std::string lock_path_;
+        int fd_ = -1;
+
+    public:
+        /**
+         * @throws std::runtime_error if the lock exists or cannot be created.
+         */
+        explicit LockFile(std::string path) : path_(std::move(path)), lock_path_(path_ + ".lock") {
+            fd_ = ::open(lock_path_.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+            if (fd_ < 0 && errno == EEXIST) {
+                throw std::runtime_error("Cannot lock " + path_ + ": " + lock_path_ +
+                                         " exists (another process is updating it)");
+            }
+            if (fd_ < 0) throw std::runtime_error("Cannot create " + lock_path_);
+        }
+
+        ~LockFile() {
+            if (fd_ >= 0) {
+                ::close(fd_);
+                ::unlink(lock_path_.c_str());
+            }
+        }
+
+        LockFile(const LockFile&) = delete;
+        LockFile& operator=(const LockFile&) = delete;
+
+        /**
+         * @brief Writes @p content, syncs it and renames the lock over the file.
+         * @throws std::runtime_error on any write error; the file is untouched then.
+         */
+        void commit(std::string_view content) {
+            std::size_t done = 0;
+            while (done < content.size()) {
+                ssize_t w = ::write(fd_, content.data() + done, content.size() - done);
+                if (w < 0 && errno == EINTR) continue;
+                if (w <= 0) throw std::runtime_error("Cannot write " + lock_path_);
+                done += static_cast<std::size_t>(w);
+            }
+            if (::fsync(fd_) != 0) throw std::runtime_error("Cannot sync " + lock_path_);
+            ::close(fd_);
+            fd_ = -1;
+            if (std::rename(lock_path_.c_str(), path_.c_str()) != 0) {
+                ::unlink(lock_path_.c_str());
+                throw std::runtime_error("Cannot replace " + path_);
+            }
+        }
+    };
+
+    std::string dir_;
+    MappedFile packed_;
+    struct stat packed_stat_ {};   ///< Identity of the mapped packed-refs file
+
+    std::string loose_path(const std::string& name) const { return dir_ + "/refs/heads/" + name; }
+    std::string packed_path() const { return dir_ + "/packed-refs"; }
+    std::string head_path() const { return dir_ + "/HEAD"; }
+
+    /**
+     * @brief Maps packed-refs again if it was replaced since the last call.
+     * @return False if there is no packed-refs file.
+     */
+    bool map_packed() {
+        struct stat st;
+        if (::stat(packed_path().c_str(), &st) != 0) {
+            packed_.reset();
+            return false;
+        }
+        if (!packed_.is_open() || st.st_ino != packed_stat_.st_ino || st.st_dev != packed_stat_.st_dev ||
+            st.st_size != packed_stat_.st_size || st.st_mtim.tv_sec != packed_stat_.st_mtim.tv_sec ||
+            st.st_mtim.tv_nsec != packed_stat_.st_mtim.tv_nsec) {
+            packed_.open(packed_path());
+            packed_stat_ = st;
+        }
+        return packed_.is_open();
+    }
+
+    /**
+     * @brief Returns the mapped entries, without the header line.
+     * @throws std::runtime_error if the file does not start with the header.
+     */
+    std::string_view packed_body() const {
+        std::string_view all(reinterpret_cast<const char*>(packed_.data()), packed_.size());
+        if (all.substr(0, kPackedHeader.size()) != kPackedHeader) {
+            throw std::runtime_error("Corrupt packed-refs: missing header");
+        }
+        return all.substr(kPackedHeader.size());
+    }
+
+    /**
+     * @brief Splits one `<hex> <name>` line.
+     * @throws std::runtime_error if the line is malformed.
+     */
+    static std::string_view parse_line(std::string_view line, entities::ObjectId& id) {
+        if (line.size() <= kHexSize + 1 || line[kHexSize] != ' ' ||
+            !entities::ObjectId::parse_hex(line.substr(0, kHexSize), id)) {
+            throw std::runtime_error("Corrupt packed-refs line: " + std::string(line));
+        }
+        return line.substr(kHexSize + 1);
+    }
+
+    /**
+     * @brief Serializes refs sorted by name into the packed-refs format.
+     */
+    static std::string format_packed(const std::vector<std::pair<std::string, entities::ObjectId>>& refs) {
+        std::string out(kPackedHeader);
+        out.reserve(out.size() + refs.size() * (kHexSize + 32));
+        for (const auto& r : refs) {
+            out += r.second.to_hex();
+            out += ' ';
+            out += r.first;
+            out += '\n';
+        }
+        return out;
+    }
+
+    /**
+     * @brief Binary-searches packed-refs for @p name.
+     */
+    bool find_packed(const std::string& name, entities::ObjectId& out) {
+        if (!map_packed()) return false;
+        std::string_view body = packed_body();
+
+        // lo and hi are always at line starts (or the end).
+        std::size_t lo = 0, hi = body.size();
+        while (lo < hi) {
+            std::size_t start = lo + (hi - lo) / 2;
+            while (start > lo && body[start - 1] != '\n') --start;
+            std::size_t end = body.find('\n', start);
+            if (end == std::string_view::npos) end = body.size();
+
+            entities::ObjectId id;
+            int cmp = parse_line(body.substr(start, end - start), id).compare(name);
+            if (cmp == 0) {
+                out = id;
+                return true;
+            }
+            if (cmp < 0) lo = end + 1;
+            else hi = start;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Reads a loose ref.
+     * @throws std::runtime_error if the file exists but does not hold an id.
+     */
+    bool read_loose(const std::string& name, entities::ObjectId& out) const {
+        std::ifstream in(loose_path(name), std::ios::binary);
+        if (!in) return false;
+        std::string hex(kHexSize, '\0');
+        if (!in.read(&hex[0], static_cast<std::streamsize>(hex.size())) || !entities::ObjectId::parse_hex(hex, out)) {
+            throw std::runtime_error("Corrupt ref: " + loose_path(name));
+        }
+        return true;
+    }
+
+    /**
+     * @brief Lists the names of all loose refs.
+     */
+    std::vector<std::string> loose_names() const {
+        namespace fs = std::filesystem;
+        std::vector<std::string> names;
+        const fs::path root = dir_ + "/refs/heads";
+        std::error_code ec;
+        if (!fs::is_directory(root, ec)) return names;
+        for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+            if (!it->is_regular_file(ec)) continue;
+            std::string name = it->path().lexically_relative(root).generic_string();
+            if (valid_name(name)) names.push_back(std::move(name));
+        }
+        return names;
+    }
+
+public:
+    /**
+     * @brief Creates a store for the refs of the repository in @p repo_dir.
+     */
+    explicit RefStore(std::string repo_dir = ".tri") : dir_(std::move(repo_dir)) {}
+
+    RefStore(const RefStore&) = delete;
+    RefStore& operator=(const RefStore&) = delete;
+    RefStore(RefStore&&) = default;
+    RefStore& operator=(RefStore&&) = default;
+
+    /**
+     * @brief Checks that @p name can be used as a branch name.
+     * @details Names are `/`-separated components that are not empty, do not
+     * start with `.` and do not end with `.lock`; whitespace, control
+     * characters, `\` and `..` are not allowed.
+     */
+    static bool valid_name(std::string_view name) {
+        if (name.empty() || name == "HEAD" || name.find("..") != std::string_view::npos) return false;
+        std::size_t begin = 0;
+        while (begin <= name.size()) {
+            std::size_t end = name.find('/', begin);
+            if (end == std::string_view::npos) end = name.size();
+            std::string_view part = name.substr(begin, end - begin);
+            if (part.empty() || part[0] == '.') return false;
+            if (part.size() >= 5 && part.substr(part.size() - 5) == ".lock") return false;
+            begin = end + 1;
+        }
+        for (char c : name) {
+            if (static_cast<unsigned char>(c) <= ' ' || c == 0x7f || c == '\\') return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Reads the current value of a branch.
+     * @return False if the branch does not exist (or the name is invalid).
+     * @throws std::runtime_error if the ref files are damaged.
+     */
+    bool read(const std::string& name, entities::ObjectId& out) {
+        if (!valid_name(name)) return false;
+        return read_loose(name, out) || find_packed(name, out);
+    }
+
+    /**
+     * @brief Calls fn(name, id) for every branch, in name order.
+     * @throws std::runtime_error if the ref files are damaged.
+     */
+    template <typename F>
+    void for_each(F&& fn) {
+        std::vector<std::pair<std::string, entities::ObjectId>> refs;
+        if (map_packed()) {
+            std::string_view body = packed_body();
+            for (std::size_t start = 0; start < body.size();) {
+                std::size_t end = body.find('\n', start);
+                if (end == std::string_view::npos) end = body.size();
+                entities::ObjectId id;
+                std::string_view name = parse_line(body.substr(start, end - start), id);
+                refs.emplace_back(std::string(name), id);
+                start = end + 1;
+            }
+        }
+        for (const std::string& name : loose_names()) {
+            entities::ObjectId id;
+            if (!read_loose(name, id)) continue;   // packed and removed meanwhile
+            auto it = std::lower_bound(refs.begin(), refs.end(), name,
+                                       [](const auto& r, const std::string& n) { return r.first < n; });
+            if (it != refs.end() && it->first == name) it->second = id;
+            else refs.insert(it, {name, id});
+        }
+        for (const auto& r : refs) fn(r.first, r.second);
+    }
+
+    /**
+     * @brief Moves a branch from @p expected to @p value.
+     * @param name Branch to update.
+     * @param expected Value the branch must have now; the null id means the
+     * branch must not exist yet.
+     * @param value New value.
+     * @throws std::runtime_error if the name is invalid, the ref is locked by
+     * another writer, or its value is no longer @p expected.
+     */
+    void update(const std::string& name, const entities::ObjectId& expected, const entities::ObjectId& value) {
+        if (!valid_name(name)) throw std::runtime_error("Invalid branch name: " + name);
+
+        const std::string path = loose_path(name);
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+        LockFile lock(path);
+
+        entities::ObjectId current;
+        bool exists = read(name, current);
+        if (expected.is_null() ? exists : (!exists || current != expected)) {
+            throw std::runtime_error("Branch '" + name + "' was updated by another process (expected " +
+                                     (expected.is_null() ? std::string("no branch") : expected.short_hex()) +
+                                     ", found " + (exists ? current.short_hex() : std::string("no branch")) + ")");
+        }
+        lock.commit(value.to_hex() + "\n");
+    }
+
+    /**
+     * @brief Returns the branch HEAD names, or "" if HEAD is not set.
+     */
+    std::string read_head() const {
+        std::ifstream in(head_path());
+        std::string line;
+        if (!in || !std::getline(in, line) || line.compare(0, kHeadPrefix.size(), kHeadPrefix) != 0) return "";
+        return line.substr(kHeadPrefix.size());
+    }
+
+    /**
+     * @brief Points HEAD at a branch.
+     * @throws std::runtime_error if HEAD is locked or cannot be written.
+     */
+    void write_head(const std::string& name) {
+        LockFile lock(head_path());
+        lock.commit(std::string(kHeadPrefix) + name + "\n");
+    }
+
+    /**
+     * @brief Replaces packed-refs with the given refs.
+     * @details Used to import refs from another format; existing loose refs
+     * still take precedence.
+     * @throws std::runtime_error if packed-refs is locked or cannot be written.
+     */
+    void write_packed(std::vector<std::pair<std::string, entities::ObjectId>> refs) {
+        std::sort(refs.begin(), refs.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        refs.erase(std::unique(refs.begin(), refs.end(),
+                               [](const auto& a, const auto& b) { return a.first == b.first; }),
+                   refs.end());
+
+        for (const auto& r : refs) {
+            if (!valid_name(r.first)) throw std::runtime_error("Invalid branch name: " + r.first);
+        }
+        LockFile lock(packed_path());
+        lock.commit(format_packed(refs));
+    }
+
+    /**
+     * @brief Moves every loose ref into packed-refs.
+     * @details Loose refs that change while packing (or are locked by a
+     * writer) are left in place and keep overriding the packed value.
+     * @return Number of refs in packed-refs afterwards.
+     * @throws std::runtime_error if packed-refs is locked or cannot be written.
+     */
+    std::size_t pack() {
+        std::vector<std::pair<std::string, entities::ObjectId>> refs;
+        LockFile packed_lock(packed_path());
+        for_each([&](const std::string& name, const entities::ObjectId& id) { refs.emplace_back(name, id); });
+
+        packed_lock.commit(format_packed(refs));
+
+        for (const auto& r : refs) {
+            struct stat st;
+            if (::stat(loose_path(r.first).c_str(), &st) != 0) continue;
+            try {
+                LockFile lock(loose_path(r.first));
+                entities::ObjectId current;
+                if (read_loose(r.first, current) && current == r.second) ::unlink(loose_path(r.first).c_str());
+            } catch (const std::runtime_error&) {
+                // Being updated right now: the loose ref stays authoritative.
+            }
+        }
+        return refs.size();
+    }
+};
+
+} // namespace core
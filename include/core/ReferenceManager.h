@@ -7,11 +7,14 @@
  * (HEAD). It provides functionality for creating branches, switching
  * between them, and updating the HEAD reference as new commits are created.
  *
+ * Once open()ed, every change is written through to a RefStore as a
+ * single-ref compare-and-swap, and branches are read from it on first use.
+ *
  * @author Umut Ertuğrul Daşgın
  * @note Documentation maintained by Deniz Kayra Aydın.
- * @version 1.1
+ * @version 1.2
  * @date 2025-12-25
- * @lastModified 2026-01-10
+ * @lastModified 2026-10-14
  */
 
 
@@ -19,6 +22,12 @@
 
 #include <string>
 #include <stdexcept>
+#include <vector>
+#include <utility>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include "RefStore.h"
 #include "../data_structures/HashTable.h"
 #include "../data_structures/DoublyLinkedList.h"
 #include "../entities/Branch.h"
@@ -40,6 +49,58 @@ namespace core {
         data_structures::HashTable<std::string, entities::Branch*> branches_;
         data_structures::DoublyLinkedList<entities::Branch*> managed_branches_;
         entities::Branch* current_branch_;
+        RefStore store_;
+        entities::CommitResolver* resolver_ = nullptr;   ///< Set by open(); null keeps refs in memory only
+        bool all_loaded_ = false;
+
+        entities::Branch* add_branch(const std::string& name, entities::Commit* target_commit) {
+            entities::Branch* new_branch = new entities::Branch(name, target_commit);
+            branches_.put(name, new_branch);
+            managed_branches_.push_back(new_branch);
+            return new_branch;
+        }
+
+        /**
+        * @brief Re-reads a branch tip written by another process.
+        */
+        void refresh(entities::Branch* branch) {
+            entities::ObjectId id;
+            if (!resolver_ || !store_.read(branch->get_name(), id)) return;
+            entities::Commit* tip = branch->get_last_commit();
+            if (!tip || tip->get_id() != id) branch->set_last_commit(resolver_->resolve_commit(id));
+        }
+
+        /**
+        * @brief Imports the single-file refs format of earlier versions.
+        *
+        * @details The old `refs` file held `HEAD <branch>` and `<commit-id|-> <branch>`
+        * lines. Its branches become packed-refs, and the file is removed last so an
+        * interrupted import is simply repeated.
+        */
+        void import_legacy(const std::string& path) {
+            std::ifstream in(path);
+            if (!in) return;
+
+            std::vector<std::pair<std::string, entities::ObjectId>> refs;
+            std::string line, head;
+            while (std::getline(in, line)) {
+                std::istringstream ls(line);
+                std::string id, name;
+                if (!(ls >> id)) continue;
+                ls >> name;
+
+                entities::ObjectId tip;
+                if (id == "HEAD") head = name;
+                else if (!name.empty() && entities::ObjectId::parse_hex(id, tip)) refs.emplace_back(name, tip);
+            }
+            in.close();
+
+            store_.write_packed(std::move(refs));
+            if (!head.empty()) store_.write_head(head);
+            if (std::remove(path.c_str()) != 0) {
+                throw std::runtime_error("Cannot remove old refs file: " + path);
+            }
+        }
 
         public:
         /**
@@ -71,26 +132,29 @@ namespace core {
         * @param[in] name Name of the new branch.
         * @param[in] target_commit Commit that the new branch will point to.
         *
-        * @throws std::runtime_error if a branch with the same name already exists.
+        * @throws std::runtime_error if a branch with the same name already exists
+        * (in memory or on disk) or the name is not valid.
         *
-        * @pre target_commit != nullptr
+        * @pre target_commit != nullptr, except for the initial branch of an empty repository
         */
 
         void create_branch(const std::string& name, entities::Commit* target_commit) {
-            if (branches_.contains(name)) {
+            if (get_branch(name)) {
                 throw std::runtime_error("Branch already exists: " + name);
             }
+            if (!RefStore::valid_name(name)) {
+                throw std::runtime_error("Invalid branch name: " + name);
+            }
 
-            entities::Branch* new_branch = new entities::Branch(name, target_commit);
-
-            branches_.put(name, new_branch);
-            managed_branches_.push_back(new_branch);
+            if (resolver_ && target_commit) store_.update(name, entities::ObjectId(), target_commit->get_id());
+            add_branch(name, target_commit);
         }
         /**
         * @brief Changes the current HEAD to the specified branch.
         *
         * @details After a successful check the specified branch becomes the active
-        * branch and HEAD points to it.
+        * branch and HEAD points to it. The branch tip is re-read from disk first, so
+        * commits made by other processes are seen.
         *
         * @param[in] name Name of the branch to check out.
         *
@@ -98,43 +162,117 @@ namespace core {
         */
 
         void checkout_branch(const std::string name) {
-            if (!branches_.contains(name)) {
+            entities::Branch* branch = get_branch(name);
+            if (!branch) {
                 throw std::runtime_error("Branch not found: " + name);
             }
 
-            current_branch_ = branches_.get(name);
+            refresh(branch);
+            if (resolver_) store_.write_head(name);
+            current_branch_ = branch;
         }
         /**
         * @brief Updates the HEAD reference to point to a new commit.
         *
         * @details The currently active branch is updated to reference the given commit.
+        * On disk the branch only moves if it still points where this manager last saw
+        * it; otherwise the in-memory tip is refreshed and the update fails.
         *
         * @param[in] new_commit Commit that HEAD will point to.
         *
-        * @throws std::runtime_error if no branch is currently checked out.
+        * @throws std::runtime_error if no branch is currently checked out, or the
+        * branch was moved or is being moved by another process.
         *
         * @pre new_commit != nullptr
         */
 
         void update_head(entities::Commit* new_commit) {
-            if (current_branch_) {
-                current_branch_->set_last_commit(new_commit);
-            } else {
+            if (!current_branch_) {
                 throw std::runtime_error("HEAD is detached (No active branch)");
             }
+            if (resolver_) {
+                entities::Commit* old_tip = current_branch_->get_last_commit();
+                try {
+                    store_.update(current_branch_->get_name(),
+                                  old_tip ? old_tip->get_id() : entities::ObjectId(), new_commit->get_id());
+                } catch (const std::runtime_error&) {
+                    refresh(current_branch_);
+                    throw;
+                }
+            }
+            current_branch_->set_last_commit(new_commit);
         }
 
         entities::Branch* get_current_branch() const { return current_branch_; }
 
+        /**
+        * @brief Looks up a branch, reading it from disk on first use.
+        *
+        * @return The branch, or nullptr if it does not exist.
+        */
+
         entities::Branch* get_branch(const std::string& name) {
-            if (branches_.contains(name)) {
-                return branches_.get(name);
+            entities::Branch** branch = branches_.find(name);
+            if (branch) return *branch;
+
+            entities::ObjectId id;
+            if (!resolver_ || !store_.read(name, id)) return nullptr;
+            return add_branch(name, resolver_->resolve_commit(id));
+        }
+
+        /**
+        * @brief Returns every branch, reading all refs from disk on first use.
+        */
+
+        const data_structures::DoublyLinkedList<entities::Branch*>& get_all_branches() {
+            if (resolver_ && !all_loaded_) {
+                store_.for_each([this](const std::string& name, const entities::ObjectId& id) {
+                    if (!branches_.contains(name)) add_branch(name, resolver_->resolve_commit(id));
+                });
+                all_loaded_ = true;
             }
+            return managed_branches_;
+        }
 
-            return nullptr;
+        /**
+        * @brief Attaches the manager to the refs stored in @p repo_dir.
+        *
+        * @details Only HEAD is read here; other branches are looked up when first
+        * needed. A HEAD naming a branch without commits yields that branch, empty.
+        * Refs in the single-file format of earlier versions are converted first.
+        *
+        * @param[in] repo_dir Repository metadata directory.
+        * @param[in] resolver Used to resolve stored commit ids; must outlive the manager.
+        *
+        * @throws std::runtime_error if the refs cannot be read or converted.
+        */
+
+        void open(const std::string& repo_dir, entities::CommitResolver& resolver) {
+            store_ = RefStore(repo_dir);
+            resolver_ = &resolver;
+            all_loaded_ = false;
+
+            std::error_code ec;
+            if (std::filesystem::is_regular_file(repo_dir + "/refs", ec)) import_legacy(repo_dir + "/refs");
+
+            std::string head = store_.read_head();
+            if (!RefStore::valid_name(head)) return;
+            current_branch_ = get_branch(head);
+            if (!current_branch_) current_branch_ = add_branch(head, nullptr);
         }
 
-        const data_structures::DoublyLinkedList<entities::Branch*>& get_all_branches() const { return managed_branches_; }
+        /**
+        * @brief Moves all loose refs into the packed-refs file.
+        *
+        * @return Number of packed refs.
+        *
+        * @throws std::runtime_error if the manager is not open or packed-refs is locked.
+        */
+
+        std::size_t pack_refs() {
+            if (!resolver_) throw std::runtime_error("References are not stored on disk");
+            return store_.pack();
+        }
 
     };
 }
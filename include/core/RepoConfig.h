@@ -0,0 +1,120 @@
+/**
+ * @file RepoConfig.h
+ * @brief Per-repository settings stored as `key = value` lines.
+ *
+ * @details The file lives at `.tri/config`. Blank lines and lines starting
+ * with '#' are ignored; unknown keys are kept so newer settings survive
+ * older builds.
+ *
+ * Recognized keys:
+ * - `compression`            : `lz` (default) or `none`
+ * - `compression.level`      : 1 (fastest, default) to 9 (smallest)
+ * - `compression.dictionary` : hex id of a stored dictionary, or `none`
+ * - `delta.maxDepth`         : longest delta chain for new blobs, 0 to 64
+ *                              (default 10, 0 disables deltas)
+ * - `chunking`               : `fastcdc` to split large blobs into
+ *                              content-defined chunks, or `none` (default)
+ * - `chunking.averageSize`   : target chunk size in bytes, a power of two
+ *                              from 1024 to 262144 (default 65536)
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.1
+ * @date 2026-10-14
+ * @lastModified 2026-10-14
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include "../data_structures/HashTable.h"
+
+namespace core {
+
+/**
+ * @brief String key/value settings of a repository.
+ */
+class RepoConfig {
+private:
+    data_structures::HashTable<std::string, std::string> values_;
+
+    static std::string trim(const std::string& s) {
+        std::size_t b = s.find_first_not_of(" \t\r");
+        if (b == std::string::npos) return "";
+        std::size_t e = s.find_last_not_of(" \t\r");
+        return s.substr(b, e - b + 1);
+    }
+
+public:
+    /**
+     * @brief Returns a setting, or @p fallback if it is not set.
+     */
+    std::string get(const std::string& key, const std::string& fallback = "") const {
+        const std::string* v = values_.find(key);
+        return v ? *v : fallback;
+    }
+
+    /**
+     * @brief Returns an integer setting, or @p fallback if it is unset or not a number.
+     */
+    int get_int(const std::string& key, int fallback) const {
+        const std::string* v = values_.find(key);
+        if (!v) return fallback;
+        try {
+            return std::stoi(*v);
+        } catch (const std::exception&) {
+            return fallback;
+        }
+    }
+
+    void set(const std::string& key, const std::string& value) { values_.put(key, value); }
+
+    /**
+     * @brief Returns all settings ordered by key.
+     */
+    std::vector<std::pair<std::string, std::string>> entries() const {
+        std::vector<std::pair<std::string, std::string>> out;
+        out.reserve(values_.size());
+        values_.for_each([&out](const std::string& k, const std::string& v) { out.emplace_back(k, v); });
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    /**
+     * @brief Reads settings from @p path; a missing file means all defaults.
+     */
+    void load(const std::string& path) {
+        values_.clear();
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) {
+            std::string t = trim(line);
+            if (t.empty() || t[0] == '#') continue;
+            std::size_t eq = t.find('=');
+            if (eq == std::string::npos) continue;
+            values_.put(trim(t.substr(0, eq)), trim(t.substr(eq + 1)));
+        }
+    }
+
+    /**
+     * @brief Writes the settings atomically (temporary file, then rename).
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void save(const std::string& path) const {
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            for (const auto& kv : entries()) out << kv.first << " = " << kv.second << '\n';
+            if (!out) throw std::runtime_error("Cannot write config: " + tmp);
+        }
+        if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+            throw std::runtime_error("Cannot replace config: " + path);
+        }
+    }
+};
+
+} // namespace core
@@ -4,9 +4,9 @@
  *
  * @author Umut Ertuğrul Daşgın
  * @note Documentation maintained by Deniz Kayra Aydın / Ömer Kağan Zafer.
- * @version 1.1
+ * @version 1.14
  * @date 2025-12-25
- * @lastModified 2026-01-10
+ * @lastModified 2026-10-14
  */
 
 #pragma once
@@ -14,6 +14,7 @@
 #include <string>
 #include <iostream>
 #include <stdexcept>
+#include <vector>
 
 #include "GraphManager.h"
 #include "ReferenceManager.h"
@@ -22,10 +23,28 @@
 #include "MerkleTree.h"
 #include "StorageEngine.h"
 #include "MergeEngine.h"
+#include "StatCache.h"
+#include "WorkingTree.h"
+#include "RepoConfig.h"
+#include "Diff.h"
+#include "RevWalk.h"
+#include "Pager.h"
+#include "BlobPipeline.h"
+#include "Stats.h"
 #include "../entities/File.h"
+#include "../entities/Manifest.h"
 
 namespace core {
 
+/**
+ * @brief Limits and output settings of Repository::log().
+ */
+struct LogOptions {
+    std::size_t max_count = 0;   ///< Stop after this many commits (0 = no limit)
+    std::time_t since = 0;       ///< Stop at the first commit older than this (0 = no limit)
+    bool use_pager = false;      ///< Page the output when stdout is a terminal
+};
+
 /**
  * @brief Central controller for repository operations.
  * * Coordinates commit creation and history traversal
@@ -33,92 +52,696 @@ namespace core {
  */
 class Repository {
 private:
+    std::string repo_dir_;
     GraphManager graph_manager_;
     ReferenceManager reference_manager_;
     StagingArea staging_area_;
     StorageEngine storage_engine_;
     MergeEngine merge_engine_;
+    StatCache stat_cache_;
+    RepoConfig config_;
+    bool stat_cache_loaded_ = false;
+    unsigned scan_threads_ = 0;
+
+    /**
+     * @brief Computes and stores the Merkle trees of a commit snapshot.
+     * @details With a parent, only directories containing paths that differ
+     * from the parent's snapshot are rebuilt; all other subtrees are reused
+     * by id.
+     * @param parent Parent commit (may be nullptr).
+     * @param files Manifest of the snapshot.
+     * @return Root tree hash or the null id if the snapshot is empty.
+     */
+    entities::ObjectId calculate_tree_hash(const entities::Commit* parent, const entities::Manifest& files) {
+        Stats::ScopedTimer timer(Timer::TREE_HASH);
+        if (files.empty()) return entities::ObjectId();
+
+        if (!parent || parent->get_tree_hash().is_null()) {
+            MerkleTree tree(files, &graph_manager_);
+            return tree.get_root_hash();
+        }
+
+        std::vector<entities::ManifestEntry> changes;
+        entities::Manifest::diff(parent->get_files(), files,
+            [&](const entities::ManifestEntry* old_entry, const entities::ManifestEntry* new_entry) {
+                if (new_entry) {
+                    changes.push_back(*new_entry);
+                } else {
+                    changes.push_back(*old_entry);
+                    changes.back().id = entities::ObjectId();
+                }
+            });
+        return MerkleTree::update(graph_manager_, parent->get_tree_hash(), std::move(changes));
+    }
+
+    /**
+     * @brief Persists the staging index after it changes.
+     */
+    void save_index() const {
+        staging_area_.save(repo_dir_ + "/index");
+    }
+
+    /**
+     * @brief Returns the working-tree directory (the parent of repo_dir_).
+     */
+    std::string work_dir() const {
+        std::string parent = fs::path(repo_dir_).parent_path().string();
+        return parent.empty() ? "." : parent;
+    }
+
+    /**
+     * @brief Scans the working tree and refreshes the stat cache.
+     * @details The cache is rewritten only if a file was rehashed or a
+     * cached file disappeared.
+     * @return Every regular file in the working tree, ordered by path.
+     */
+    std::vector<ScanEntry> scan_working_tree() {
+        if (!stat_cache_loaded_) {
+            stat_cache_.load(repo_dir_ + "/statcache");
+            stat_cache_loaded_ = true;
+        }
+
+        std::vector<ScanEntry> files = WorkingTree(work_dir()).scan(stat_cache_, scan_threads_);
+
+        bool dirty = files.size() != stat_cache_.size();
+        for (const ScanEntry& e : files) dirty = dirty || e.rehashed;
+
+        if (dirty) {
+            stat_cache_.clear();
+            stat_cache_.reserve(files.size());
+            for (const ScanEntry& e : files) stat_cache_.update(e.path, e.stat, e.id);
+            try {
+                stat_cache_.save(repo_dir_ + "/statcache");
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: " << e.what() << std::endl;
+            }
+        }
+        return files;
+    }
+
+    /**
+     * @brief Returns the id a path has in the next commit as staged so far.
+     * @return Staged id, else the HEAD id, else the null id.
+     */
+    entities::ObjectId indexed_id(const std::string& path, const entities::Commit* head) const {
+        if (const StagedEntry* staged = staging_area_.find(path)) return staged->get_hash();
+        if (!head) return entities::ObjectId();
+        const entities::ManifestEntry* e = head->get_files().find(path);
+        return e ? e->get_hash() : entities::ObjectId();
+    }
+
+    /**
+     * @brief Returns the mode a path has in the next commit as staged so far.
+     * @return Staged mode, else the HEAD mode, else kModeRegular.
+     */
+    std::uint32_t indexed_mode(const std::string& path, const entities::Commit* head) const {
+        if (const StagedEntry* staged = staging_area_.find(path)) return staged->get_mode();
+        const entities::ManifestEntry* e = head ? head->get_files().find(path) : nullptr;
+        return e ? e->get_mode() : entities::kModeRegular;
+    }
+
+    /**
+     * @brief Maps stat(2) permission bits to the mode recorded in manifests.
+     */
+    static std::uint32_t mode_of(const FileStat& stat) {
+        return (stat.mode & 0111) ? entities::kModeExecutable : entities::kModeRegular;
+    }
+
+    /**
+     * @brief Applies the compression, delta and chunking settings of config_
+     * to the object store.
+     * @throws std::runtime_error if a setting is invalid.
+     */
+    void apply_config() {
+        std::string codec = config_.get("compression", "lz");
+        if (codec != "lz" && codec != "none") {
+            throw std::runtime_error("compression must be 'lz' or 'none', not '" + codec + "'");
+        }
+        int level = config_.get_int("compression.level", LzCodec::kMinLevel);
+        if (level < LzCodec::kMinLevel || level > LzCodec::kMaxLevel) {
+            throw std::runtime_error("compression.level must be between 1 and 9");
+        }
+        entities::ObjectId dict;
+        std::string dict_hex = config_.get("compression.dictionary");
+        if (!dict_hex.empty() && dict_hex != "none" && !entities::ObjectId::parse_hex(dict_hex, dict)) {
+            throw std::runtime_error("compression.dictionary is not an object id: " + dict_hex);
+        }
+        graph_manager_.set_compression(codec == "lz" ? Codec::LZ : Codec::NONE, level, dict);
+
+        int depth = config_.get_int("delta.maxDepth", ObjectStore::kDefaultMaxDeltaDepth);
+        if (depth < 0 || depth > ObjectStore::kMaxDeltaDepth) {
+            throw std::runtime_error("delta.maxDepth must be between 0 and 64");
+        }
+        graph_manager_.set_max_delta_depth(depth);
+
+        std::string chunking = config_.get("chunking", "none");
+        if (chunking != "fastcdc" && chunking != "none") {
+            throw std::runtime_error("chunking must be 'fastcdc' or 'none', not '" + chunking + "'");
+        }
+        int average = config_.get_int("chunking.averageSize", static_cast<int>(FastCdc::kDefaultAverage));
+        if (average < static_cast<int>(FastCdc::kMinAverage) || average > static_cast<int>(FastCdc::kMaxAverage) ||
+            (average & (average - 1))) {
+            throw std::runtime_error("chunking.averageSize must be a power of two between 1024 and 262144");
+        }
+        graph_manager_.set_chunking(chunking == "fastcdc" ? static_cast<std::size_t>(average) : 0);
+    }
+
+    /**
+     * @brief Returns the version of @p path in @p head, the natural delta base
+     * for a new version of the file (null id if it is new).
+     */
+    static entities::ObjectId delta_base(const std::string& path, const entities::Commit* head) {
+        if (!head) return entities::ObjectId();
+        const entities::ManifestEntry* e = head->get_files().find(path);
+        return e ? e->get_hash() : entities::ObjectId();
+    }
+
+    entities::Commit* head_commit() const {
+        entities::Branch* b = reference_manager_.get_current_branch();
+        return b ? b->get_last_commit() : nullptr;
+    }
+
+    std::vector<entities::Commit*> branch_tips() {
+        std::vector<entities::Commit*> tips;
+        const auto& branches = reference_manager_.get_all_branches();
+        for (auto it = branches.begin(); it != branches.end(); ++it) tips.push_back((*it)->get_last_commit());
+        return tips;
+    }
+
+    /**
+     * @brief Resolves a branch name, "HEAD" or a unique commit id prefix.
+     * @throws std::runtime_error if nothing (or more than one commit) matches.
+     */
+    entities::Commit* resolve_revision(const std::string& rev) {
+        if (rev == "HEAD") {
+            if (entities::Commit* head = head_commit()) return head;
+            throw std::runtime_error("HEAD has no commits yet");
+        }
+        if (entities::Branch* b = reference_manager_.get_branch(rev)) {
+            if (b->get_last_commit()) return b->get_last_commit();
+            throw std::runtime_error("Branch has no commits yet: " + rev);
+        }
+        bool hex = rev.size() >= 4 && rev.find_first_not_of("0123456789abcdef") == std::string::npos;
+        entities::Commit* c = hex ? graph_manager_.find_commit_by_prefix(rev) : nullptr;
+        if (!c) throw std::runtime_error("Unknown revision: " + rev);
+        return c;
+    }
+
+    /**
+     * @brief Formats one commit the way log() prints it.
+     */
+    static std::string format_log_record(const entities::Commit* c) {
+        std::string record = "Commit: " + c->get_id().to_hex() + "\n";
+        record += "Author: " + c->get_author() + "\n";
+        std::time_t t = c->get_time();
+        record += "Date:   ";
+        record += std::ctime(&t);
+        record += "Tree:   " + c->get_tree_hash().short_hex(10) + "...\n";
+
+        if (c->is_merge_commit()) {
+            record += "Merge:  " + c->get_parent1_id().short_hex() + " " +
+                      c->get_parent2_id().short_hex() + "\n";
+        }
+
+        record += "\n    " + c->get_message() + "\n";
+        record += "------------------------------------------\n";
+        return record;
+    }
 
     /**
-     * @brief Computes the Merkle tree hash of staged files.
-     * @return Root tree hash or "empty_tree" if staging area is empty.
+     * @brief Prints the unified diff of one file.
+     * @param old_id Stored old version (null id: the file is new).
+     * @param new_content New content, or nullptr if the file was deleted.
      */
-    std::string calculate_tree_hash() const {
-        if (staging_area_.is_empty()) return "empty_tree";
+    void print_file_diff(const std::string& path, const entities::ObjectId& old_id,
+                         const std::string* new_content) const {
+        std::string old_content = old_id.is_null() ? "" : graph_manager_.get_blob_content(old_id);
+        std::string empty;
+        const std::string& new_text = new_content ? *new_content : empty;
 
-        MerkleTree tree(staging_area_.get_files());
-        return tree.get_root_hash();
+        std::cout << "diff a/" << path << " b/" << path << "\n";
+        if (LineDiff::is_binary(old_content) || LineDiff::is_binary(new_text)) {
+            std::cout << "Binary files differ\n";
+            return;
+        }
+        std::cout << LineDiff::unified(old_content, new_text,
+                                       old_id.is_null() ? "/dev/null" : "a/" + path,
+                                       new_content ? "b/" + path : "/dev/null");
     }
 
 public:
-    Repository() {
+    /**
+     * @brief Opens (or initializes) the repository stored in @p repo_dir.
+     * @param repo_dir Metadata directory holding objects and refs.
+     */
+    explicit Repository(const std::string& repo_dir = ".tri")
+        : repo_dir_(repo_dir), graph_manager_(repo_dir) {
         try {
+            reference_manager_.open(repo_dir_, graph_manager_);
             if (!reference_manager_.get_branch("master")) {
                 reference_manager_.create_branch("master", nullptr);
             }
-            reference_manager_.checkout_branch("master");
+            if (!reference_manager_.get_current_branch()) {
+                reference_manager_.checkout_branch("master");
+            }
+            staging_area_.load(repo_dir_ + "/index");
+            config_.load(repo_dir_ + "/config");
+            apply_config();
         } catch (const std::exception& e) {
             std::cerr << "Initialization warning:" << e.what() << std::endl;
         }
     }
 
+    /**
+     * @brief Prints one setting, or all of them if @p key is empty.
+     */
+    void show_config(const std::string& key = "") const {
+        if (!key.empty()) {
+            std::cout << key << " = " << config_.get(key) << std::endl;
+            return;
+        }
+        for (const auto& kv : config_.entries()) std::cout << kv.first << " = " << kv.second << std::endl;
+    }
+
+    /**
+     * @brief Changes and persists a setting.
+     * @details Compression settings apply to objects written afterwards;
+     * existing objects keep their encoding.
+     * @throws std::runtime_error if the new value is invalid (nothing is changed).
+     */
+    void set_config(const std::string& key, const std::string& value) {
+        RepoConfig previous = config_;
+        config_.set(key, value);
+        try {
+            apply_config();
+        } catch (const std::exception&) {
+            config_ = previous;
+            apply_config();
+            throw;
+        }
+        config_.save(repo_dir_ + "/config");
+    }
+
+    /**
+     * @brief Rewrites the object store with delta bases chosen over all history.
+     * @param window Candidate bases tried per blob.
+     * @param max_depth Longest delta chain; 0 uses the `delta.maxDepth` setting.
+     */
+    void repack(std::size_t window = 10, int max_depth = 0) {
+        if (max_depth <= 0) max_depth = config_.get_int("delta.maxDepth", ObjectStore::kDefaultMaxDeltaDepth);
+
+        RepackStats stats = graph_manager_.repack(branch_tips(), window, max_depth);
+        apply_config();   // restore the configured chain limit for later writes
+
+        std::cout << "Repacked " << stats.objects << " object(s), " << stats.deltas << " as deltas: "
+                  << stats.bytes_before << " -> " << stats.bytes_after << " bytes" << std::endl;
+    }
+
+    /**
+     * @brief Removes objects no branch can reach and repacks the rest.
+     * @details Staged blobs are kept as well, so a pending commit or an
+     * unresolved merge survives. The configured compression dictionary is
+     * kept; older ones are dropped.
+     * @param window Candidate bases tried per blob.
+     * @param max_depth Longest delta chain; 0 uses the `delta.maxDepth` setting.
+     */
+    void gc(std::size_t window = 10, int max_depth = 0) {
+        if (max_depth <= 0) max_depth = config_.get_int("delta.maxDepth", ObjectStore::kDefaultMaxDeltaDepth);
+
+        std::vector<entities::ObjectId> staged;
+        for (const StagedEntry* e : staging_area_.get_files()) {
+            if (!e->get_hash().is_null()) staged.push_back(e->get_hash());
+        }
+        RepackStats stats = graph_manager_.gc(branch_tips(), staged, window, max_depth);
+        apply_config();
+
+        std::cout << "Removed " << stats.removed << " unreachable object(s), kept " << stats.objects
+                  << " (" << stats.deltas << " as deltas): "
+                  << stats.bytes_before << " -> " << stats.bytes_after << " bytes" << std::endl;
+    }
+
+    /**
+     * @brief Trains a compression dictionary from the files of HEAD and enables it.
+     * @param capacity Maximum dictionary size in bytes.
+     */
+    void train_dictionary(std::size_t capacity) {
+        entities::Commit* head = head_commit();
+        if (!head) {
+            std::cout << "Nothing to train on: no commits yet." << std::endl;
+            return;
+        }
+        std::vector<entities::ObjectId> blobs;
+        for (const auto& e : head->get_files()) blobs.push_back(e.get_hash());
+
+        entities::ObjectId dict = graph_manager_.train_dictionary(blobs, capacity);
+        if (dict.is_null()) {
+            std::cout << "Files share too little content for a dictionary." << std::endl;
+            return;
+        }
+        set_config("compression.dictionary", dict.to_hex());
+        std::cout << "Dictionary " << dict.short_hex() << " trained on " << blobs.size()
+                  << " file(s); new blobs will be compressed with it." << std::endl;
+    }
+
     /**
      * @brief Stages a file for the next commit.
+     * @details The content is stored right away; the staging index only
+     * records its id.
      * @param path File path.
      * @param content File content.
      */
     void add(const std::string& path, const std::string& content) {
-        entities::File file(path, content);
-        staging_area_.add_file(file);
+        Stats::ScopedTimer timer(Timer::ADD);
+        entities::ObjectId id = entities::File::hash_of(path, content);
+        graph_manager_.save_blob(id, content, delta_base(path, head_commit()));
+        staging_area_.add_file(path, id);
+        save_index();
         std::cout << "File staged: " << path << std::endl;
     }
 
+    /**
+     * @brief Stages a file from disk without loading it into memory.
+     * @details The file is read, hashed and compressed in fixed-size pieces
+     * straight into the object store, so memory use does not depend on the
+     * file size. Streamed files are stored whole, not as deltas.
+     * @param path File path, relative to the working tree.
+     * @throws std::runtime_error if the file cannot be read or stored.
+     */
+    void add_file(const std::string& path) {
+        Stats::ScopedTimer timer(Timer::ADD);
+        FileStat stat;
+        if (!FileStat::from_path(path, stat) || !S_ISREG(stat.mode)) {
+            throw std::runtime_error("Not a regular file: " + path);
+        }
+        entities::File file;
+        if (!BlobPipeline::stream_file(graph_manager_, path, file)) {
+            throw std::runtime_error("Cannot read file: " + path);
+        }
+        graph_manager_.flush();
+        staging_area_.add_file(path, file.get_hash(), mode_of(stat), stat);
+        save_index();
+        std::cout << "File staged: " << path << " (" << file.get_size() << " bytes)" << std::endl;
+    }
+
+    /**
+     * @brief Stages every change in the working tree.
+     * @details New and modified files are stored and staged, and files whose
+     * executable bit changed are staged with their new mode; tracked files
+     * missing from disk are staged for deletion. Files whose stat data is
+     * unchanged since they were last hashed are not read. Changed files are
+     * read, hashed and compressed in parallel and appended to the pack in
+     * a few large writes with a single sync (see BlobPipeline).
+     */
+    void add_all() {
+        Stats::ScopedTimer timer(Timer::ADD);
+        entities::Commit* head = head_commit();
+        std::vector<ScanEntry> disk = scan_working_tree();
+
+        data_structures::HashTable<std::string, bool> on_disk(disk.size());
+        std::size_t staged = 0;
+
+        std::vector<const ScanEntry*> changed;
+        std::vector<BlobInput> inputs;
+        for (const ScanEntry& e : disk) {
+            on_disk.put(e.path, true);
+            if (indexed_id(e.path, head) == e.id) {
+                if (indexed_mode(e.path, head) != mode_of(e.stat)) {
+                    staging_area_.add_file(e.path, e.id, mode_of(e.stat), e.stat);   // content already stored
+                    ++staged;
+                }
+                continue;
+            }
+            changed.push_back(&e);
+            inputs.push_back(BlobInput{e.path, delta_base(e.path, head), nullptr, e.stat.size, e.id});
+        }
+
+        std::vector<BlobOutput> stored = BlobPipeline().store(graph_manager_, inputs);
+        for (std::size_t i = 0; i < changed.size(); ++i) {
+            if (!stored[i].ok) continue;
+            const ScanEntry& e = *changed[i];
+            staging_area_.add_file(e.path, stored[i].id, mode_of(e.stat), e.stat);
+            ++staged;
+        }
+
+        std::vector<std::string> gone;
+        if (head) {
+            for (const auto& e : head->get_files()) {
+                if (!on_disk.contains(e.get_path())) gone.push_back(e.get_path());
+            }
+        }
+        for (const StagedEntry* e : staging_area_.get_files()) {
+            if (!e->get_hash().is_null() && !on_disk.contains(e->get_path())) gone.push_back(e->get_path());
+        }
+        for (const std::string& path : gone) {
+            bool tracked = head && head->get_files().find(path);
+            if (tracked) staging_area_.add_file(path, entities::ObjectId());
+            else staging_area_.remove_file(path);
+            ++staged;
+        }
+
+        save_index();
+        std::cout << "Staged " << staged << " change(s) from " << disk.size() << " file(s)." << std::endl;
+    }
+
+    /**
+     * @brief Prints staged, unstaged and untracked changes.
+     * @details Only files whose stat data changed since they were last
+     * hashed are read; a clean tree costs one stat per file.
+     */
+    void status() {
+        entities::Commit* head = head_commit();
+        std::vector<ScanEntry> disk = scan_working_tree();
+
+        std::cout << "On branch " << get_current_branch_name() << std::endl;
+
+        std::vector<std::string> to_commit, not_staged, untracked;
+
+        for (const StagedEntry* e : staging_area_.get_files()) {
+            const entities::ManifestEntry* in_head = head ? head->get_files().find(e->get_path()) : nullptr;
+            if (e->get_hash().is_null()) {
+                if (in_head) to_commit.push_back("deleted:    " + e->get_path());
+            } else if (!in_head) {
+                to_commit.push_back("new file:   " + e->get_path());
+            } else if (in_head->get_hash() != e->get_hash() || in_head->get_mode() != e->get_mode()) {
+                to_commit.push_back("modified:   " + e->get_path());
+            }
+        }
+
+        data_structures::HashTable<std::string, bool> on_disk(disk.size());
+        std::size_t rehashed = 0;
+        for (const ScanEntry& e : disk) {
+            on_disk.put(e.path, true);
+            if (e.rehashed) ++rehashed;
+
+            entities::ObjectId expected = indexed_id(e.path, head);
+            if (expected.is_null()) untracked.push_back(e.path);
+            else if (expected != e.id || indexed_mode(e.path, head) != mode_of(e.stat)) {
+                not_staged.push_back("modified:   " + e.path);
+            }
+        }
+
+        auto check_deleted = [&](const std::string& path) {
+            if (!on_disk.contains(path) && !indexed_id(path, head).is_null()) {
+                not_staged.push_back("deleted:    " + path);
+            }
+        };
+        if (head) {
+            for (const auto& e : head->get_files()) {
+                if (!staging_area_.find(e.get_path())) check_deleted(e.get_path());
+            }
+        }
+        for (const StagedEntry* e : staging_area_.get_files()) check_deleted(e->get_path());
+        std::sort(not_staged.begin(), not_staged.end(),
+            [](const std::string& a, const std::string& b) { return a.compare(12, std::string::npos, b, 12, std::string::npos) < 0; });
+
+        auto section = [](const char* title, const std::vector<std::string>& lines) {
+            if (lines.empty()) return;
+            std::cout << title << "\n";
+            for (const std::string& l : lines) std::cout << "    " << l << "\n";
+        };
+        section("Changes to be committed:", to_commit);
+        section("Changes not staged for commit:", not_staged);
+        section("Untracked files:", untracked);
+
+        if (to_commit.empty() && not_staged.empty() && untracked.empty()) {
+            std::cout << "nothing to commit, working tree clean\n";
+        }
+        std::cout << "(" << disk.size() << " files scanned, " << rehashed << " hashed)" << std::endl;
+    }
+
+    /**
+     * @brief Prints changes as unified diffs.
+     * @details Without @p staged, the working tree is compared with what
+     * is staged (or HEAD for unstaged paths); untracked files are skipped.
+     * With @p staged, the staged files are compared with HEAD.
+     * @param staged Show staged instead of unstaged changes.
+     */
+    void diff(bool staged = false) {
+        entities::Commit* head = head_commit();
+
+        if (staged) {
+            for (const StagedEntry* e : staging_area_.get_files()) {
+                entities::ObjectId old_id = delta_base(e->get_path(), head);
+                if (old_id == e->get_hash()) continue;
+                if (e->get_hash().is_null()) {
+                    print_file_diff(e->get_path(), old_id, nullptr);
+                } else {
+                    std::string content = graph_manager_.get_blob_content(e->get_hash());
+                    print_file_diff(e->get_path(), old_id, &content);
+                }
+            }
+            std::cout.flush();
+            return;
+        }
+
+        std::vector<ScanEntry> disk = scan_working_tree();
+        data_structures::HashTable<std::string, bool> on_disk(disk.size());
+        struct Change {
+            std::string path;
+            entities::ObjectId old_id;   ///< Staged or committed version
+            bool deleted;
+        };
+        std::vector<Change> changed;
+
+        for (const ScanEntry& e : disk) {
+            on_disk.put(e.path, true);
+            entities::ObjectId expected = indexed_id(e.path, head);
+            if (expected.is_null() || expected == e.id) continue;
+            changed.push_back(Change{e.path, expected, false});
+        }
+        auto check_deleted = [&](const std::string& path) {
+            entities::ObjectId expected = indexed_id(path, head);
+            if (!on_disk.contains(path) && !expected.is_null()) {
+                changed.push_back(Change{path, expected, true});
+            }
+        };
+        if (head) {
+            for (const auto& e : head->get_files()) {
+                if (!staging_area_.find(e.get_path())) check_deleted(e.get_path());
+            }
+        }
+        for (const StagedEntry* e : staging_area_.get_files()) check_deleted(e->get_path());
+
+        std::sort(changed.begin(), changed.end(),
+            [](const Change& a, const Change& b) { return a.path < b.path; });
+
+        std::string content;
+        for (const Change& c : changed) {
+            if (c.deleted || !WorkingTree::read_file(c.path, content)) {
+                print_file_diff(c.path, c.old_id, nullptr);
+            } else {
+                print_file_diff(c.path, c.old_id, &content);
+            }
+        }
+        std::cout.flush();
+    }
+
+    /**
+     * @brief Prints the changes between the snapshots of two branches.
+     * @param from Old side.
+     * @param to New side; empty compares HEAD with @p from, HEAD being the old side.
+     * @throws std::runtime_error if a branch does not exist.
+     */
+    void diff_branches(const std::string& from, const std::string& to = "") {
+        auto tip = [this](const std::string& name) -> entities::Commit* {
+            entities::Branch* b = reference_manager_.get_branch(name);
+            if (!b) throw std::runtime_error("Branch not found: " + name);
+            return b->get_last_commit();
+        };
+        entities::Commit* old_c = to.empty() ? head_commit() : tip(from);
+        entities::Commit* new_c = to.empty() ? tip(from) : tip(to);
+
+        entities::Manifest none;
+        const entities::Manifest& old_files = old_c ? old_c->get_files() : none;
+        const entities::Manifest& new_files = new_c ? new_c->get_files() : none;
+
+        entities::Manifest::diff(old_files, new_files,
+            [&](const entities::ManifestEntry* old_entry, const entities::ManifestEntry* new_entry) {
+                if (new_entry) {
+                    entities::ObjectId old_id = old_entry ? old_entry->get_hash() : entities::ObjectId();
+                    std::string content = graph_manager_.get_blob_content(new_entry->get_hash());
+                    print_file_diff(new_entry->get_path(), old_id, &content);
+                } else if (old_entry) {
+                    print_file_diff(old_entry->get_path(), old_entry->get_hash(), nullptr);
+                }
+            });
+        std::cout.flush();
+    }
+
+    /**
+     * @brief Sets the number of threads used to scan the working tree.
+     * @param threads Thread count (0 = hardware concurrency).
+     */
+    void set_scan_threads(unsigned threads) { scan_threads_ = threads; }
+
+    /**
+     * @brief Sets the number of threads used to write files on checkout and merge.
+     * @param threads Thread count (0 = automatic).
+     */
+    void set_restore_threads(unsigned threads) { storage_engine_.set_threads(threads); }
+
     /**
      * @brief Creates a new commit from staged files.
+     * @details The commit is a full snapshot: its manifest is the parent's
+     * manifest with the staged files applied, sharing every unchanged
+     * segment with the parent.
      * @param message Commit message.
      * @param author Commit author.
      * @return Identifier of the created commit.
      * @throws std::runtime_error if staging area is empty.
      */
-    std::string commit(const std::string& message, const std::string author) {
+    entities::ObjectId commit(std::string message, std::string author) {
+        Stats::ScopedTimer timer(Timer::COMMIT);
         if (staging_area_.is_empty()) {
             throw std::runtime_error("Nothing to commit (Staging area is empty).");
         }
 
-        std::string tree_hash = calculate_tree_hash();
-        data_structures::DoublyLinkedList<entities::File> commit_files;
+        entities::Commit* parent = nullptr;
+        entities::Branch* current_branch = reference_manager_.get_current_branch();
+        if (current_branch) parent = current_branch->get_last_commit();
+
         const auto& staged = staging_area_.get_files();
+        std::vector<entities::ManifestEntry> changes;
+        changes.reserve(staged.size());
 
-        for (auto it = staged.begin(); it != staged.end(); ++it) {
-            graph_manager_.save_blob(it->get_hash(), it->get_content());
-            entities::File lightweight_file(it->get_path(), "");
-            lightweight_file.set_hash_manual(it->get_hash());
-            commit_files.push_back(lightweight_file);
+        for (const StagedEntry* e : staged) {
+            changes.emplace_back(e->get_path(), e->get_hash(), e->get_mode());
         }
 
-        entities::Commit* parent = nullptr;
-        entities::Branch* current_branch = reference_manager_.get_current_branch();
-        if (current_branch) parent = current_branch->get_last_commit();
+        entities::Manifest commit_files = parent
+            ? parent->get_files().with_changes(std::move(changes))
+            : entities::Manifest().with_changes(std::move(changes));
+
+        entities::ObjectId tree_hash = calculate_tree_hash(parent, commit_files);
 
         entities::Commit* new_commit =
-            new entities::Commit(message, author, tree_hash, commit_files, parent);
+            new entities::Commit(std::move(message), std::move(author), tree_hash, std::move(commit_files), parent);
 
         graph_manager_.add_commit(new_commit);
         reference_manager_.update_head(new_commit);
         staging_area_.clear();
+        save_index();
 
         std::cout << "[" << current_branch->get_name()
-                  << " " << new_commit->get_id().substr(0, 7)
-                  << "] " << message << std::endl;
+                  << " " << new_commit->get_id().short_hex()
+                  << "] " << new_commit->get_message() << std::endl;
 
         return new_commit->get_id();
     }
 
     /**
      * @brief Switches the current branch.
+     * @details Only files whose hash differs between the previous HEAD and the
+     * target commit are rewritten; files absent from the target are removed.
+     * The working tree is assumed to match the previous HEAD.
      * @param name Target branch name.
+     * @param quiet Suppress per-file output and print only a summary.
      */
-    void checkout(const std::string& name) {
+    void checkout(const std::string& name, bool quiet = false) {
+        Stats::ScopedTimer timer(Timer::CHECKOUT);
+        entities::Branch* previous = reference_manager_.get_current_branch();
+        entities::Commit* from = previous ? previous->get_last_commit() : nullptr;
+
         reference_manager_.checkout_branch(name);
 
         entities::Branch* branch = reference_manager_.get_branch(name);
@@ -127,9 +750,15 @@ public:
         std::cout << "Switched to branch '" << name << "'" << std::endl;
 
         if (commit) {
-            storage_engine_.restore_files(commit, graph_manager_);
+            storage_engine_.set_verbose(!quiet);
+            CheckoutStats stats = storage_engine_.checkout_files(from, commit, graph_manager_);
+            storage_engine_.set_verbose(true);
+
             std::cout << "Files restored from commit "
-                      << commit->get_id().substr(0,7) << std::endl;
+                      << commit->get_id().short_hex()
+                      << " (" << stats.written << " updated, "
+                      << stats.removed << " removed, "
+                      << stats.unchanged << " unchanged)" << std::endl;
         }
     }
 
@@ -139,6 +768,7 @@ public:
      * @throws std::runtime_error if branch does not exist.
      */
     void merge(const std::string& branch_name) {
+        Stats::ScopedTimer timer(Timer::MERGE);
         entities::Branch* current = reference_manager_.get_current_branch();
         entities::Branch* target = reference_manager_.get_branch(branch_name);
 
@@ -153,66 +783,96 @@ public:
             return;
         }
 
-        if (head_c->get_id() == target_c->get_id()) {
+        if (graph_manager_.is_ancestor(target_c, head_c)) {
             std::cout << "Already up to date." << std::endl;
             return;
         }
 
+        // HEAD is behind the target: move the branch and rewrite only the
+        // files that differ, without a merge commit.
+        if (graph_manager_.is_ancestor(head_c, target_c)) {
+            reference_manager_.update_head(target_c);
+
+            CheckoutStats stats = storage_engine_.checkout_files(head_c, target_c, graph_manager_);
+            staging_area_.clear();
+            save_index();
+
+            std::cout << "Fast-forward " << head_c->get_id().short_hex()
+                      << ".." << target_c->get_id().short_hex()
+                      << " (" << stats.written << " updated, "
+                      << stats.removed << " removed, "
+                      << stats.unchanged << " unchanged)" << std::endl;
+            return;
+        }
+
         std::cout << "Merging " << branch_name
                   << " into " << current->get_name() << "..." << std::endl;
 
         std::string conflict_msg = "";
-        auto merged_files =
+        std::vector<MergeChange> changes =
             merge_engine_.merge_commits(head_c, target_c,
                                         graph_manager_, conflict_msg);
 
         staging_area_.clear();
 
-        for (auto it = merged_files.begin(); it != merged_files.end(); ++it) {
-            staging_area_.add_file(*it);
+        // Only paths whose merged version differs from HEAD are touched.
+        std::vector<BlobInput> merged;
+        for (const MergeChange& c : changes) {
+            if (c.merged) merged.push_back(BlobInput{c.path, delta_base(c.path, head_c), &c.content, 0, entities::ObjectId()});
+        }
+        BlobPipeline().store(graph_manager_, merged);
 
-            std::string content_to_write = it->get_content();
-            if (content_to_write.empty()) {
-                content_to_write =
-                    graph_manager_.get_blob_content(it->get_hash());
+        std::vector<RestoreJob> jobs;
+        jobs.reserve(changes.size());
+        for (const MergeChange& c : changes) {
+            if (c.id.is_null()) {
+                storage_engine_.remove_file_from_disk(c.path);
+            } else if (c.merged) {
+                jobs.push_back(RestoreJob{c.path, BlobView::borrow(c.content), c.mode});
+            } else {
+                jobs.push_back(RestoreJob{c.path, graph_manager_.get_blob_packed(c.id), c.mode});
             }
-            storage_engine_.save_file_to_disk(it->get_path(), content_to_write);
+            staging_area_.add_file(c.path, c.id, c.mode);
         }
+        storage_engine_.write_files(jobs);
+        storage_engine_.flush_report();
+        save_index();
 
         if (!conflict_msg.empty()) {
             std::cout << "MERGE CONFLICT! Fix conflicts manually."
                       << std::endl << conflict_msg << std::endl;
         } else {
             std::string msg = "Merge branch '" + branch_name + "'";
-            std::string tree_hash = calculate_tree_hash();
 
-            data_structures::DoublyLinkedList<entities::File> commit_files;
-            const auto& staged = staging_area_.get_files();
-
-            for (auto it = staged.begin(); it != staged.end(); ++it) {
-                graph_manager_.save_blob(it->get_hash(), it->get_content());
-                entities::File lf(it->get_path(), "");
-                lf.set_hash_manual(it->get_hash());
-                commit_files.push_back(lf);
-            }
+            std::vector<entities::ManifestEntry> entries;
+            entries.reserve(changes.size());
+            for (const MergeChange& c : changes) entries.emplace_back(c.path, c.id, c.mode);
 
+            entities::Manifest commit_files = head_c->get_files().with_changes(std::move(entries));
+            entities::ObjectId tree_hash = calculate_tree_hash(head_c, commit_files);
             entities::Commit* merge_commit =
-                new entities::Commit(msg, "MergeUser",
-                                     tree_hash, commit_files,
+                new entities::Commit(std::move(msg), "MergeUser",
+                                     tree_hash, std::move(commit_files),
                                      head_c, target_c);
 
             graph_manager_.add_commit(merge_commit);
             reference_manager_.update_head(merge_commit);
             staging_area_.clear();
+            save_index();
 
             std::cout << "Merge successful." << std::endl;
         }
     }
 
     /**
-     * @brief Prints commit history of the current branch.
+     * @brief Prints commit history of the current branch, newest first.
+     * @details Commits are produced lazily and written as soon as they are
+     * formatted, so the first screen appears without walking the whole
+     * history. The walk also stops when the pager is closed.
+     * @param options Limits and output settings.
      */
-    void log() {
+    void log(const LogOptions& options = LogOptions()) {
+        Stats::ScopedTimer timer(Timer::LOG);
         entities::Branch* current = reference_manager_.get_current_branch();
 
         if (!current || !current->get_last_commit()) {
@@ -220,37 +880,113 @@ public:
             return;
         }
 
-        auto history_stack =
-            GraphAlgorithms::get_history_dfs(current->get_last_commit());
+        RevWalk walk(&graph_manager_.commit_graph());
+        walk.push(current->get_last_commit());
 
-        std::cout << "\n===== Commit History for '"
-                  << current->get_name() << "' =====\n";
+        Pager out(options.use_pager);
+        if (!out.write("\n===== Commit History for '" + current->get_name() + "' =====\n")) return;
 
-        while (!history_stack.empty()) {
-            entities::Commit* c = history_stack.top();
-            history_stack.pop();
+        for (std::size_t shown = 0; !walk.done(); ++shown) {
+            if (options.max_count && shown == options.max_count) break;
+            if (options.since && walk.peek_time() < options.since) break;
+            if (!out.write(format_log_record(walk.next()))) break;
+        }
+    }
 
-            std::cout << "Commit: " << c->get_id() << "\n";
-            std::cout << "Author: " << c->get_author() << "\n";
-            std::time_t t = c->get_time();
-            std::cout << "Date:   " << std::ctime(&t);
-            std::cout << "Tree:   "
-                      << c->get_tree_hash().substr(0, 10)
-                      << "...\n";
+    /**
+     * @brief Prints the commits reachable from @p to but not from @p from,
+     * newest first (`log from..to`).
+     * @details Both sets come from the reachability bitmaps, so only commits
+     * newer than the nearest bitmaps are walked and only the commits shown
+     * are decoded.
+     * @param from Excluded revision; empty means HEAD.
+     * @param to Included revision; empty means HEAD.
+     * @param options Limits and output settings.
+     * @throws std::runtime_error if a revision cannot be resolved.
+     */
+    void log_range(const std::string& from, const std::string& to, const LogOptions& options = LogOptions()) {
+        Stats::ScopedTimer timer(Timer::LOG);
+        entities::Commit* exclude = resolve_revision(from.empty() ? "HEAD" : from);
+        entities::Commit* include = resolve_revision(to.empty() ? "HEAD" : to);
 
-            if (c->is_merge_commit()) {
-                std::cout << "Merge:  "
-                          << c->get_parent1()->get_id().substr(0,7)
-                          << " "
-                          << c->get_parent2()->get_id().substr(0,7)
-                          << "\n";
-            }
+        data_structures::Bitmap commits = graph_manager_.reachable_commits({include});
+        commits.and_not(graph_manager_.reachable_commits({exclude}));
 
-            std::cout << "\n    " << c->get_message() << "\n";
-            std::cout << "------------------------------------------\n";
+        const CommitGraph& graph = graph_manager_.commit_graph();
+        std::vector<std::uint32_t> order;
+        order.reserve(commits.count());
+        commits.for_each([&](std::size_t pos) { order.push_back(static_cast<std::uint32_t>(pos)); });
+        std::sort(order.begin(), order.end(), [&graph](std::uint32_t a, std::uint32_t b) {
+            if (graph.time(a) != graph.time(b)) return graph.time(a) > graph.time(b);
+            return graph.generation(a) > graph.generation(b);
+        });
+
+        Pager out(options.use_pager);
+        if (!out.write("\n===== Commits in '" + (to.empty() ? "HEAD" : to) + "' but not in '" +
+                       (from.empty() ? "HEAD" : from) + "' (" + std::to_string(order.size()) + ") =====\n")) {
+            return;
+        }
+        for (std::size_t shown = 0; shown < order.size(); ++shown) {
+            if (options.max_count && shown == options.max_count) break;
+            if (options.since && static_cast<std::time_t>(graph.time(order[shown])) < options.since) break;
+            entities::Commit* c = graph_manager_.get_commit(graph.id(order[shown]));
+            if (c && !out.write(format_log_record(c))) break;
         }
     }
 
+    /**
+     * @brief Prints the best common ancestor of two revisions.
+     * @param a Branch name, "HEAD" or commit id prefix.
+     * @param b Branch name, "HEAD" or commit id prefix.
+     * @return The merge base, or the null id if the histories are unrelated.
+     * @throws std::runtime_error if a revision cannot be resolved.
+     */
+    entities::ObjectId merge_base(const std::string& a, const std::string& b) {
+        entities::Commit* base = graph_manager_.merge_base(resolve_revision(a), resolve_revision(b));
+        if (!base) {
+            std::cout << "No common ancestor." << std::endl;
+            return entities::ObjectId();
+        }
+        std::cout << base->get_id().to_hex() << std::endl;
+        return base->get_id();
+    }
+
+    /**
+     * @brief Prints the branches whose history contains a commit.
+     * @param rev Branch name, "HEAD" or commit id prefix.
+     * @throws std::runtime_error if @p rev cannot be resolved.
+     */
+    void branch_contains(const std::string& rev) {
+        entities::Commit* target = resolve_revision(rev);
+        std::uint32_t pos = graph_manager_.position(target);
+
+        entities::Branch* current = reference_manager_.get_current_branch();
+        std::vector<std::string> names;
+        const auto& branches = reference_manager_.get_all_branches();
+        for (auto it = branches.begin(); it != branches.end(); ++it) {
+            entities::Commit* tip = (*it)->get_last_commit();
+            if (tip && graph_manager_.reachable_commits({tip}).test(pos)) {
+                names.push_back(((*it) == current ? "* " : "  ") + (*it)->get_name());
+            }
+        }
+        std::sort(names.begin(), names.end(), [](const std::string& a, const std::string& b) {
+            return a.substr(2) < b.substr(2);
+        });
+        for (const std::string& n : names) std::cout << n << "\n";
+        std::cout.flush();
+    }
+
+    /**
+     * @brief Builds reachability bitmaps for every branch tip.
+     */
+    void build_bitmaps() {
+        std::size_t built = graph_manager_.build_bitmaps(branch_tips());
+        std::size_t objects = graph_manager_.reachable_objects(branch_tips()).size();
+        std::cout << "Built " << built << " bitmap(s) covering "
+                  << graph_manager_.commit_graph().size() << " commit(s) and "
+                  << objects << " reachable object(s)." << std::endl;
+    }
+
     /**
      * @brief Creates a new branch from the current commit.
      * @param name Branch name.
@@ -270,6 +1006,25 @@ public:
         std::cout << "Branch created: " << name << std::endl;
     }
 
+    /**
+     * @brief Returns the latest published read-only view of history and objects.
+     * @details Unlike every other method this one may be called from any
+     * thread, and the snapshot may be queried on many threads at once while
+     * this repository keeps committing. Taking the snapshot briefly holds a
+     * library mutex; queries on it take none. Branch tips to start from can
+     * be read with a RefStore on the same directory.
+     * @see ReadSnapshot
+     */
+    std::shared_ptr<const ReadSnapshot> snapshot() const { return graph_manager_.snapshot(); }
+
+    /**
+     * @brief Moves every loose branch ref into `.tri/packed-refs`.
+     */
+    void pack_refs() {
+        std::size_t packed = reference_manager_.pack_refs();
+        std::cout << "Packed " << packed << " ref(s)." << std::endl;
+    }
+
     /**
      * @brief Returns the current branch name.
      * @return Branch name or "Detached".
@@ -0,0 +1,99 @@
+/**
+ * @file RevWalk.h
+ * @brief Lazy walk over commit history, newest first.
+ *
+ * @details Commits are yielded one at a time from a priority queue ordered
+ * by commit time, then by generation number, so a child always comes
+ * before a parent that shares its timestamp. A commit's parents are only
+ * resolved, and thus decoded from the object store, when the commit itself
+ * is yielded; stopping after N commits costs O(N log N) no matter how long
+ * the history is.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.1
+ * @date 2026-10-14
+ * @lastModified 2026-10-14
+ */
+
+#pragma once
+
+#include <queue>
+#include <vector>
+#include <cstdint>
+#include "CommitGraph.h"
+#include "Stats.h"
+#include "../data_structures/HashTable.h"
+#include "../entities/Commit.h"
+#include "../entities/ObjectId.h"
+
+namespace core {
+
+/**
+ * @brief Iterator over the commits reachable from a set of tips.
+ * * Every commit is yielded once, even if reachable along several paths
+ * * Memory grows with the commits seen so far, not with the history size
+ */
+class RevWalk {
+private:
+    struct Item {
+        entities::Commit* commit;
+        std::int64_t time;
+        std::uint32_t generation;
+    };
+
+    struct Older {
+        bool operator()(const Item& a, const Item& b) const {
+            if (a.time != b.time) return a.time < b.time;
+            return a.generation < b.generation;
+        }
+    };
+
+    const CommitGraph* graph_;
+    std::priority_queue<Item, std::vector<Item>, Older> queue_;
+    data_structures::HashTable<entities::ObjectId, bool, CountedProbes> seen_;
+
+public:
+    /**
+     * @brief Creates an empty walk.
+     * @param graph Supplies generation numbers to order commits with equal
+     * times (may be nullptr).
+     */
+    explicit RevWalk(const CommitGraph* graph = nullptr) : graph_(graph) {}
+
+    /**
+     * @brief Adds a starting point; commits already queued or yielded are ignored.
+     */
+    void push(entities::Commit* commit) {
+        if (!commit || !seen_.insert(commit->get_id(), true)) return;
+
+        std::uint32_t generation = 0;
+        if (graph_) {
+            std::uint32_t pos = graph_->find(commit->get_id());
+            if (pos != CommitGraph::kNone) generation = graph_->generation(pos);
+        }
+        queue_.push(Item{commit, static_cast<std::int64_t>(commit->get_time()), generation});
+    }
+
+    /**
+     * @brief Returns the time of the commit next() would yield.
+     * @pre !done()
+     */
+    std::int64_t peek_time() const { return queue_.top().time; }
+
+    bool done() const { return queue_.empty(); }
+
+    /**
+     * @brief Yields the newest remaining commit and queues its parents.
+     * @return The commit, or nullptr when the walk is over.
+     */
+    entities::Commit* next() {
+        if (queue_.empty()) return nullptr;
+        entities::Commit* c = queue_.top().commit;
+        queue_.pop();
+        push(c->get_parent1());
+        push(c->get_parent2());
+        return c;
+    }
+};
+
+} // namespace core
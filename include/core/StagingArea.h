@@ -4,13 +4,19 @@
  *
  * @details The StagingArea class represents an intermediate
  * area where files are collected before being committed. It supports adding,
- * updating, removing, and clearing staged files.
+ * updating, removing, and clearing staged files, and persists itself as a
+ * compact binary index so staged work survives between invocations.
+ *
+ * Index file layout (little-endian): "TRISTG01", u32 entry count, then per
+ * entry `[u32 path length][path][u32 mode][ObjectId][i64 mtime_ns]
+ * [i64 ctime_ns][u64 size][u64 inode][u32 st_mode]` ordered by path, followed
+ * by the SHA-256 of everything before it.
  *
  * @author Umut Ertuğrul Daşgın
  * @note Documentation maintained by Deniz Kayra Aydın.
- * @version 1.1
+ * @version 1.3
  * @date 2025-12-25
- * @lastModified 2026-01-10
+ * @lastModified 2026-10-14
  *
  * @copyright Copyright (c) 2025
  */
@@ -18,21 +24,56 @@
 #pragma once
 
 #include <string>
-#include "../data_structures/DoublyLinkedList.h"
-#include "../entities/File.h"
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include "BinaryIO.h"
+#include "FileStat.h"
+#include "Stats.h"
+#include "../data_structures/HashTable.h"
+#include "../entities/Manifest.h"
+#include "../entities/ObjectId.h"
+#include "../crypto/Sha256.h"
 
 namespace core {
 
+/**
+ * @brief A file staged for the next commit.
+ * @details Content is written to the object store when the file is staged,
+ * so an entry only records where that content lives.
+ */
+struct StagedEntry {
+    std::string path;
+    entities::ObjectId id;
+    std::uint32_t mode = entities::kModeRegular;
+    FileStat stat;    ///< Working-tree metadata at staging time (may be unknown)
+
+    const std::string& get_path() const { return path; }
+    const entities::ObjectId& get_hash() const { return id; }
+    std::uint32_t get_mode() const { return mode; }
+};
+
 /**
  * @brief Represents a staging area for files awaiting commit.
  *
- * @details The StagingArea class temporarily stores file objects that are marked
- * for inclusion in the next commit. If a file with the same path is added
+ * @details The StagingArea class records the files that are marked for
+ * inclusion in the next commit. If a file with the same path is added
  * multiple times, the staged version is updated accordingly.
+ * * Entries are keyed by path in a hash table: add, update and remove are O(1)
+ * * get_files() returns entries ordered by path, the order snapshot
+ *   manifests and trees are built in; the order is rebuilt only after a change
  */
 class StagingArea {
 private:
-    data_structures::DoublyLinkedList<entities::File> staged_files_;
+    static constexpr char kIndexMagic[8] = {'T', 'R', 'I', 'S', 'T', 'G', '0', '1'};
+
+    data_structures::HashTable<std::string, StagedEntry, CountedProbes> entries_;
+    mutable std::vector<const StagedEntry*> sorted_;
+    mutable bool sorted_valid_ = true;
 
 public:
     /**
@@ -46,16 +87,20 @@ public:
      * @details If a file with the same path already exists in the staging area,
      * it is replaced with the new version.
      *
-     * @param[in] file File to be staged.
+     * @param[in] path File path.
+     * @param[in] id Id of the file's content (already stored).
+     * @param[in] mode File mode.
+     * @param[in] stat Working-tree metadata, if the content came from disk.
      */
-    void add_file(const entities::File& file) {
-        for (auto it = staged_files_.begin(); it != staged_files_.end(); ++it) {
-            if (it->get_path() == file.get_path()) {
-                *it = file;
-                return;
-            }
-        }
-        staged_files_.push_back(file);
+    void add_file(const std::string& path, const entities::ObjectId& id,
+                  std::uint32_t mode = entities::kModeRegular, const FileStat& stat = FileStat()) {
+        StagedEntry entry;
+        entry.path = path;
+        entry.id = id;
+        entry.mode = mode;
+        entry.stat = stat;
+        entries_.put(path, entry);
+        sorted_valid_ = false;
     }
 
     /**
@@ -64,30 +109,45 @@ public:
      * @param[in] file_path Path of the file to be removed.
      */
     void remove_file(const std::string& file_path) {
-        std::size_t idx = 0;
-        for (auto it = staged_files_.begin(); it != staged_files_.end(); ++it) {
-            if (it->get_path() == file_path) {
-                staged_files_.erase(idx);
-                return;
-            }
-            ++idx;
-        }
+        entries_.remove(file_path);
+        sorted_valid_ = false;
+    }
+
+    /**
+     * @brief Looks up the staged entry for a path.
+     *
+     * @param[in] file_path File path.
+     * @return Entry pointer, or nullptr if the path is not staged.
+     */
+    const StagedEntry* find(const std::string& file_path) const {
+        return entries_.find(file_path);
     }
 
     /**
      * @brief Retrieves all staged files.
      *
-     * @return Constant reference to the list of staged files.
+     * @return Staged entries ordered by path. Invalidated by any change to
+     * the staging area.
      */
-    const data_structures::DoublyLinkedList<entities::File>& get_files() const {
-        return staged_files_;
+    const std::vector<const StagedEntry*>& get_files() const {
+        if (!sorted_valid_) {
+            sorted_.clear();
+            sorted_.reserve(entries_.size());
+            entries_.for_each([this](const std::string&, const StagedEntry& e) { sorted_.push_back(&e); });
+            std::sort(sorted_.begin(), sorted_.end(),
+                [](const StagedEntry* a, const StagedEntry* b) { return a->path < b->path; });
+            sorted_valid_ = true;
+        }
+        return sorted_;
     }
 
     /**
      * @brief Clears all staged files.
      */
     void clear() {
-        staged_files_.clear();
+        entries_.clear();
+        sorted_.clear();
+        sorted_valid_ = true;
     }
 
     /**
@@ -96,7 +156,85 @@ public:
      * @return true if no files are staged, false otherwise.
      */
     bool is_empty() const {
-        return staged_files_.empty();
+        return entries_.empty();
+    }
+
+    /**
+     * @brief Returns the number of staged files.
+     */
+    std::size_t size() const { return entries_.size(); }
+
+    /**
+     * @brief Writes the index atomically (temporary file, then rename).
+     *
+     * @param[in] index_path Destination file.
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void save(const std::string& index_path) const {
+        std::string out(kIndexMagic, sizeof(kIndexMagic));
+        const auto& files = get_files();
+        binary_io::put_u32(out, static_cast<std::uint32_t>(files.size()));
+        for (const StagedEntry* e : files) {
+            binary_io::put_string(out, e->path);
+            binary_io::put_u32(out, e->mode);
+            out.append(reinterpret_cast<const char*>(e->id.data()), entities::ObjectId::size());
+            e->stat.encode(out);
+        }
+        crypto::Digest sum = crypto::Sha256::hash(out);
+        out.append(reinterpret_cast<const char*>(sum.bytes.data()), sum.bytes.size());
+
+        std::string tmp = index_path + ".tmp";
+        {
+            std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+            if (!f || !f.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+                throw std::runtime_error("Cannot write index: " + tmp);
+            }
+        }
+        if (std::rename(tmp.c_str(), index_path.c_str()) != 0) {
+            throw std::runtime_error("Cannot replace index: " + index_path);
+        }
+    }
+
+    /**
+     * @brief Replaces the staged files with those from an index file.
+     *
+     * @details A missing index means nothing is staged.
+     *
+     * @param[in] index_path Index file.
+     * @throws std::runtime_error if the index is malformed or corrupt.
+     */
+    void load(const std::string& index_path) {
+        clear();
+
+        std::ifstream f(index_path, std::ios::binary);
+        if (!f) return;
+        std::string data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+        const std::size_t sum_size = crypto::Digest::kSize;
+        if (data.size() < sizeof(kIndexMagic) + 4 + sum_size ||
+            std::memcmp(data.data(), kIndexMagic, sizeof(kIndexMagic)) != 0) {
+            throw std::runtime_error("Malformed index: " + index_path);
+        }
+
+        std::string_view body(data.data(), data.size() - sum_size);
+        crypto::Digest sum = crypto::Sha256::hash(body);
+        if (std::memcmp(sum.bytes.data(), data.data() + body.size(), sum_size) != 0) {
+            throw std::runtime_error("Index checksum mismatch: " + index_path);
+        }
+
+        binary_io::ByteReader in(body.data() + sizeof(kIndexMagic), body.size() - sizeof(kIndexMagic));
+        std::uint32_t count = in.u32();
+        entries_.reserve(count);
+        for (std::uint32_t i = 0; i < count; ++i) {
+            StagedEntry e;
+            e.path = in.string();
+            e.mode = in.u32();
+            e.id = entities::ObjectId::from_bytes(in.raw(entities::ObjectId::size()));
+            e.stat = FileStat::decode(in);
+            std::string key = e.path;
+            entries_.put(std::move(key), std::move(e));
+        }
+        sorted_valid_ = false;
     }
 };
 
@@ -0,0 +1,158 @@
+/**
+ * @file StatCache.h
+ * @brief Persistent cache of working-tree file metadata and content ids.
+ *
+ * @details Lets working-tree scans skip reading and hashing files whose
+ * stat data is unchanged since they were last hashed.
+ *
+ * File layout (little-endian): "TRISTC01", u32 entry count, then per entry
+ * `[u32 path length][path][ObjectId][FileStat]`, followed by the SHA-256 of
+ * everything before it.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.1
+ * @date 2026-10-14
+ * @lastModified 2026-10-14
+ */
+
+#pragma once
+
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include "BinaryIO.h"
+#include "FileStat.h"
+#include "Stats.h"
+#include "../data_structures/HashTable.h"
+#include "../entities/ObjectId.h"
+#include "../crypto/Sha256.h"
+
+namespace core {
+
+/**
+ * @brief Content id of a file as of a recorded stat.
+ */
+struct StatCacheEntry {
+    FileStat stat;
+    entities::ObjectId id;
+};
+
+/**
+ * @brief Path → (stat, id) cache consulted by working-tree scans.
+ * * Lookups are read-only and safe to run from several threads at once
+ * * An entry modified at or after the moment the cache was last written is
+ *   "racily clean": a later edit in the same timestamp tick would be
+ *   invisible, so such entries are never trusted
+ */
+class StatCache {
+private:
+    static constexpr char kMagic[8] = {'T', 'R', 'I', 'S', 'T', 'C', '0', '1'};
+
+    data_structures::HashTable<std::string, StatCacheEntry, CountedProbes> entries_;
+    std::int64_t written_ns_ = 0;   ///< Modification time of the cache file when last loaded or saved
+
+public:
+    /**
+     * @brief Returns the cached id if @p stat proves the file unchanged.
+     * @param path File path.
+     * @param stat Current metadata of the file.
+     * @return Cached id, or nullptr if the file must be rehashed.
+     */
+    const entities::ObjectId* lookup_clean(const std::string& path, const FileStat& stat) const {
+        const StatCacheEntry* e = entries_.find(path);
+        if (!e || !e->stat.matches(stat) || e->stat.mtime_ns >= written_ns_) return nullptr;
+        return &e->id;
+    }
+
+    /**
+     * @brief Records the id of a file as of @p stat.
+     */
+    void update(const std::string& path, const FileStat& stat, const entities::ObjectId& id) {
+        entries_.put(path, StatCacheEntry{stat, id});
+    }
+
+    void remove(const std::string& path) { entries_.remove(path); }
+    void clear() { entries_.clear(); }
+    void reserve(std::size_t n) { entries_.reserve(n); }
+    std::size_t size() const { return entries_.size(); }
+
+    /**
+     * @brief Writes the cache atomically (temporary file, then rename).
+     * @details Entries become trustworthy once the cache is written, so the
+     * new file's modification time becomes the racy-clean cutoff.
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void save(const std::string& cache_path) {
+        std::string out(kMagic, sizeof(kMagic));
+        binary_io::put_u32(out, static_cast<std::uint32_t>(entries_.size()));
+        entries_.for_each([&out](const std::string& path, const StatCacheEntry& e) {
+            binary_io::put_string(out, path);
+            out.append(reinterpret_cast<const char*>(e.id.data()), entities::ObjectId::size());
+            e.stat.encode(out);
+        });
+        crypto::Digest sum = crypto::Sha256::hash(out);
+        out.append(reinterpret_cast<const char*>(sum.bytes.data()), sum.bytes.size());
+
+        std::string tmp = cache_path + ".tmp";
+        {
+            std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+            if (!f || !f.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+                throw std::runtime_error("Cannot write stat cache: " + tmp);
+            }
+        }
+        if (std::rename(tmp.c_str(), cache_path.c_str()) != 0) {
+            throw std::runtime_error("Cannot replace stat cache: " + cache_path);
+        }
+
+        FileStat own;
+        written_ns_ = FileStat::from_path(cache_path, own) ? own.mtime_ns : 0;
+    }
+
+    /**
+     * @brief Loads the cache; a missing or damaged file leaves it empty.
+     * @details The cache is only an accelerator, so corruption is not an error.
+     */
+    void load(const std::string& cache_path) {
+        entries_.clear();
+        written_ns_ = 0;
+
+        FileStat own;
+        if (!FileStat::from_path(cache_path, own)) return;
+
+        std::ifstream f(cache_path, std::ios::binary);
+        if (!f) return;
+        std::string data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+        const std::size_t sum_size = crypto::Digest::kSize;
+        if (data.size() < sizeof(kMagic) + 4 + sum_size ||
+            std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+            return;
+        }
+
+        std::string_view body(data.data(), data.size() - sum_size);
+        crypto::Digest sum = crypto::Sha256::hash(body);
+        if (std::memcmp(sum.bytes.data(), data.data() + body.size(), sum_size) != 0) return;
+
+        try {
+            binary_io::ByteReader in(body.data() + sizeof(kMagic), body.size() - sizeof(kMagic));
+            std::uint32_t count = in.u32();
+            entries_.reserve(count);
+            for (std::uint32_t i = 0; i < count; ++i) {
+                std::string path = in.string();
+                StatCacheEntry e;
+                e.id = entities::ObjectId::from_bytes(in.raw(entities::ObjectId::size()));
+                e.stat = FileStat::decode(in);
+                entries_.put(std::move(path), std::move(e));
+            }
+        } catch (const std::runtime_error&) {
+            entries_.clear();
+            return;
+        }
+        written_ns_ = own.mtime_ns;
+    }
+};
+
+} // namespace core
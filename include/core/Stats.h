@@ -0,0 +1,270 @@
+/**
+ * @file Stats.h
+ * @brief Hot-path counters and scoped operation timers.
+ *
+ * @details Statistics are off unless enabled (`tri --stats`); a disabled
+ * counter costs one relaxed load and a branch. Once enabled, every thread
+ * counts into its own shard, which only that thread writes, so an update
+ * is a plain load and store with no contended cache line or locked
+ * instruction even on lookups made by many reader threads at once. Totals
+ * sum the live shards and those of threads that have exited.
+ *
+ * Counted: SHA-256 digests and the bytes they cover, blobs read from and
+ * written to the object store, payload bytes copied out of the pack into
+ * owned buffers (reads through views copy nothing), and lookups in the
+ * core's hot hash tables (object store, commit cache, staging area, stat
+ * cache, history walks) with the slots they probed. Timed: the user-facing
+ * repository operations, inclusive of what they call (a commit's time
+ * includes its tree hashing).
+ *
+ * This header depends only on the standard library, so crypto can count
+ * too. data_structures stays independent of it: a HashTable is counted only
+ * when core declares it with CountedProbes as its probe policy.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.1
+ * @date 2026-10-14
+ * @lastModified 2026-10-14
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <ostream>
+#include <vector>
+#include <algorithm>
+
+namespace core {
+
+/**
+ * @brief Counted events.
+ */
+enum class Counter : unsigned {
+    HASHES,          ///< SHA-256 digests computed
+    HASHED_BYTES,    ///< Bytes fed to those digests
+    BLOBS_READ,      ///< Blob records looked up in the object store
+    BLOBS_WRITTEN,   ///< Blob records appended to the pack
+    BYTES_COPIED,    ///< Object payload bytes copied into owned strings
+    TABLE_LOOKUPS,   ///< Lookups in hash tables declared with CountedProbes
+    TABLE_PROBES,    ///< Slots inspected by those lookups
+    COUNT
+};
+
+/**
+ * @brief Timed operations.
+ */
+enum class Timer : unsigned {
+    ADD,
+    COMMIT,
+    TREE_HASH,
+    CHECKOUT,
+    MERGE,
+    MERGE_BASE,
+    LOG,
+    COUNT
+};
+
+/**
+ * @brief Process-wide statistics registry.
+ * * count() and ScopedTimer may be used from any thread
+ * * totals() is exact for threads that are not counting concurrently and
+ *   never tears a value for those that are
+ */
+class Stats {
+public:
+    static constexpr unsigned kCounters = static_cast<unsigned>(Counter::COUNT);
+    static constexpr unsigned kTimers = static_cast<unsigned>(Timer::COUNT);
+
+    /**
+     * @brief A reading of every counter and timer.
+     */
+    struct Totals {
+        std::uint64_t counters[kCounters] = {};
+        std::uint64_t calls[kTimers] = {};
+        std::uint64_t nanos[kTimers] = {};
+
+        std::uint64_t operator[](Counter c) const { return counters[static_cast<unsigned>(c)]; }
+
+        /**
+         * @brief Returns what happened between @p earlier and this reading.
+         */
+        Totals since(const Totals& earlier) const {
+            Totals d;
+            for (unsigned i = 0; i < kCounters; ++i) d.counters[i] = counters[i] - earlier.counters[i];
+            for (unsigned i = 0; i < kTimers; ++i) {
+                d.calls[i] = calls[i] - earlier.calls[i];
+                d.nanos[i] = nanos[i] - earlier.nanos[i];
+            }
+            return d;
+        }
+    };
+
+private:
+    static constexpr unsigned kSlots = kCounters + 2 * kTimers;   // counters, then calls, then nanoseconds
+
+    struct Registry;
+
+    /**
+     * @brief One thread's values; written by that thread only.
+     */
+    struct Shard {
+        std::atomic<std::uint64_t> values[kSlots] = {};
+
+        Shard() {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.shards.push_back(this);
+        }
+
+        ~Shard() {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            for (unsigned i = 0; i < kSlots; ++i) r.retired[i] += values[i].load(std::memory_order_relaxed);
+            r.shards.erase(std::find(r.shards.begin(), r.shards.end(), this));
+        }
+    };
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<Shard*> shards;
+        std::uint64_t retired[kSlots] = {};   ///< Left behind by threads that exited
+        Totals baseline;                      ///< Subtracted from every reading; set by reset()
+    };
+
+    static inline std::atomic<bool> enabled_{false};
+
+    static Registry& registry() {
+        static Registry r;
+        return r;
+    }
+
+    static void bump(unsigned slot, std::uint64_t n) {
+        thread_local Shard shard;
+        std::atomic<std::uint64_t>& v = shard.values[slot];
+        v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    static Totals raw_totals(Registry& r) {
+        std::uint64_t sum[kSlots];
+        std::copy(r.retired, r.retired + kSlots, sum);
+        for (const Shard* s : r.shards) {
+            for (unsigned i = 0; i < kSlots; ++i) sum[i] += s->values[i].load(std::memory_order_relaxed);
+        }
+        Totals t;
+        std::copy(sum, sum + kCounters, t.counters);
+        std::copy(sum + kCounters, sum + kCounters + kTimers, t.calls);
+        std::copy(sum + kCounters + kTimers, sum + kSlots, t.nanos);
+        return t;
+    }
+
+public:
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+    static void enable(bool on = true) { enabled_.store(on, std::memory_order_relaxed); }
+
+    /**
+     * @brief Adds @p n to a counter if statistics are enabled.
+     */
+    static void count(Counter c, std::uint64_t n = 1) {
+        if (enabled()) bump(static_cast<unsigned>(c), n);
+    }
+
+    /**
+     * @brief Returns everything counted since start-up or the last reset().
+     */
+    static Totals totals() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        return raw_totals(r).since(r.baseline);
+    }
+
+    /**
+     * @brief Starts counting from zero again.
+     */
+    static void reset() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.baseline = raw_totals(r);
+    }
+
+    static const char* counter_name(Counter c) {
+        static const char* const names[kCounters] = {
+            "hashes computed", "bytes hashed", "blobs read", "blobs written",
+            "bytes copied", "hash-table lookups", "hash-table probes"};
+        return names[static_cast<unsigned>(c)];
+    }
+
+    static const char* timer_name(Timer t) {
+        static const char* const names[kTimers] = {
+            "add", "commit", "tree hash", "checkout", "merge", "merge base", "log"};
+        return names[static_cast<unsigned>(t)];
+    }
+
+    /**
+     * @brief Prints @p t as two tables: counters, then timed operations.
+     */
+    static void report(std::ostream& out, const Totals& t) {
+        char line[96];
+        for (unsigned i = 0; i < kCounters; ++i) {
+            std::snprintf(line, sizeof(line), "%-20s %16llu\n", counter_name(static_cast<Counter>(i)),
+                          static_cast<unsigned long long>(t.counters[i]));
+            out << line;
+        }
+        std::snprintf(line, sizeof(line), "\n%-20s %10s %12s %12s\n", "operation", "calls", "total ms", "mean us");
+        out << line;
+        for (unsigned i = 0; i < kTimers; ++i) {
+            if (!t.calls[i]) continue;
+            std::snprintf(line, sizeof(line), "%-20s %10llu %12.3f %12.1f\n", timer_name(static_cast<Timer>(i)),
+                          static_cast<unsigned long long>(t.calls[i]), t.nanos[i] / 1e6,
+                          t.nanos[i] / 1e3 / t.calls[i]);
+            out << line;
+        }
+    }
+
+    static void report(std::ostream& out) { report(out, totals()); }
+
+    /**
+     * @brief Adds the lifetime of a scope to a Timer.
+     * @details Whether to time is decided once, at construction.
+     */
+    class ScopedTimer {
+    private:
+        Timer timer_;
+        bool on_;
+        std::chrono::steady_clock::time_point start_;
+
+    public:
+        explicit ScopedTimer(Timer t) : timer_(t), on_(enabled()) {
+            if (on_) start_ = std::chrono::steady_clock::now();
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        ~ScopedTimer() {
+            if (!on_) return;
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+            unsigned i = static_cast<unsigned>(timer_);
+            bump(kCounters + i, 1);
+            bump(kCounters + kTimers + i, static_cast<std::uint64_t>(ns.count()));
+        }
+    };
+};
+
+/**
+ * @brief HashTable probe policy that counts lookups and probed slots.
+ * @details Core tables on hot paths name it as their third template
+ * argument; other tables keep the no-op default and pay nothing.
+ */
+struct CountedProbes {
+    static void record(std::uint32_t probes) {
+        if (!Stats::enabled()) return;
+        Stats::count(Counter::TABLE_LOOKUPS);
+        Stats::count(Counter::TABLE_PROBES, probes);
+    }
+};
+
+} // namespace core
@@ -2,78 +2,383 @@
  * @file StorageEngine.h
  * @brief Handles persistent storage of file data.
  * @details Manages writing files to disk and restoring
- * tracked content from stored blob data.
+ * tracked content from stored blob data. Blob bytes are written straight from
+ * the object store's mapping (copy_file_range when possible, write otherwise),
+ * without intermediate std::string copies. Multi-file restores create each
+ * parent directory once and write files from a pool of worker threads, which
+ * also decode compressed blobs. Files get the mode recorded in the manifest,
+ * and directories emptied by deletions are removed.
  *
  * @author Umut Ertuğrul Daşgın
  * @note Documentation maintained by Deniz Kayra Aydın / Ömer Kağan Zafer.
- * @version 1.1
+ * @version 1.4
  * @date 2025-12-25
- * @lastModified 2026-01-10
+ * @lastModified 2026-10-14
  */
 
 
 #pragma once
 
-#include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "../entities/Commit.h"
 #include "../entities/File.h"
 #include "GraphManager.h"
+#include "BlobView.h"
 
 namespace fs = std::filesystem;
 
 namespace core {
 
+/**
+ * @brief Counts of working-tree changes made by a checkout.
+ */
+struct CheckoutStats {
+    std::size_t written = 0;    ///< Files created or rewritten
+    std::size_t removed = 0;    ///< Files deleted because the target lacks them
+    std::size_t unchanged = 0;  ///< Files skipped because their hash matched
+};
+
+/**
+ * @brief One file to be written by StorageEngine::write_files().
+ */
+struct RestoreJob {
+    std::string path;
+    PackedObject content;   ///< Decoded by the writing thread
+    std::uint32_t mode;     ///< entities::kModeRegular or kModeExecutable
+};
+
 /**
  * @brief Manages disk-level file restoration and persistence.
  * * Supports restoring tracked files from commits
- * * Ensures required directories exist before writing files
+ * * Ensures required directories exist before writing files; batches create
+ *   every distinct parent directory exactly once
+ * * Batches are written by a pool of worker threads, since restores are
+ *   dominated by open/write/close latency rather than CPU
+ * * Per-file messages are batched and printed once per operation
  */
 class StorageEngine {
+private:
+    static constexpr std::size_t kMinJobsPerThread = 8;   ///< Below this, extra threads cost more than they save
+
+    bool verbose_ = true;   ///< Emit per-file lines in the report
+    std::string report_;    ///< Pending per-file output
+    unsigned threads_ = 0;  ///< Writer threads for batches (0 = automatic)
+
+    void note(const char* what, const std::string& path) {
+        if (!verbose_) return;
+        report_ += what;
+        report_ += path;
+        report_ += '\n';
+    }
+
+    /**
+     * @brief Copies the view's bytes into @p fd in-kernel when it is file-backed.
+     * @return Number of bytes copied; less than the view size means the caller
+     * must write the remainder from memory.
+     */
+    static std::size_t copy_range(int fd, const BlobView& blob) {
+#if defined(__linux__)
+        if (blob.source_fd() < 0) return 0;
+
+        off64_t src_off = static_cast<off64_t>(blob.source_offset());
+        std::size_t done = 0;
+        while (done < blob.size()) {
+            ssize_t n = ::copy_file_range(blob.source_fd(), &src_off, fd, nullptr,
+                                          blob.size() - done, 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            done += static_cast<std::size_t>(n);
+        }
+        return done;
+#else
+        (void)fd;
+        (void)blob;
+        return 0;
+#endif
+    }
+
+    /**
+     * @brief Writes the view's bytes starting at @p from using write(2).
+     */
+    static bool write_all(int fd, const BlobView& blob, std::size_t from) {
+        const char* p = blob.data() + from;
+        std::size_t left = blob.size() - from;
+        while (left > 0) {
+            ssize_t n = ::write(fd, p, left);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            p += n;
+            left -= static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Creates and fills one file; does not create parent directories.
+     * @details A new file is created 0755 or 0644 (less the umask). An
+     * existing file keeps its permissions unless its executable bit disagrees
+     * with @p mode, since open(2) ignores the mode when it only truncates.
+     * @return False if the file could not be opened, fully written or given its mode.
+     */
+    static bool write_blob(const std::string& path, const BlobView& content, std::uint32_t mode) {
+        const bool executable = mode == entities::kModeExecutable;
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, executable ? 0755 : 0644);
+        if (fd < 0) return false;
+
+        struct stat st;
+        bool ok = ::fstat(fd, &st) == 0;
+        if (ok && ((st.st_mode & 0111) != 0) != executable) {
+            ok = ::fchmod(fd, executable ? (st.st_mode & 0777) | 0111 : st.st_mode & 0666) == 0;
+        }
+
+        std::size_t copied = ok ? copy_range(fd, content) : 0;
+        ok = ok && write_all(fd, content, copied);
+        return ::close(fd) == 0 && ok;
+    }
+
+    /**
+     * @brief Removes the parent directories of @p path that are left empty,
+     * innermost first, stopping at the first one still in use.
+     */
+    static void remove_empty_parents(const std::string& path) {
+        std::error_code ec;
+        for (fs::path dir = fs::path(path).parent_path(); !dir.empty(); dir = dir.parent_path()) {
+            if (!fs::remove(dir, ec) || ec) break;
+        }
+    }
+
+    /**
+     * @brief Creates the parent directory of every job, each one only once.
+     */
+    static void create_parent_dirs(const std::vector<RestoreJob>& jobs) {
+        std::vector<std::string_view> dirs;
+        dirs.reserve(jobs.size());
+        for (const RestoreJob& job : jobs) {
+            std::string_view path(job.path);
+            std::size_t slash = path.rfind('/');
+            if (slash != std::string_view::npos && slash > 0) dirs.push_back(path.substr(0, slash));
+        }
+        std::sort(dirs.begin(), dirs.end());
+        dirs.erase(std::unique(dirs.begin(), dirs.end()), dirs.end());
+
+        std::error_code ec;
+        for (std::string_view dir : dirs) fs::create_directories(fs::path(dir), ec);
+    }
+
+    /**
+     * @brief Number of writer threads to use for @p jobs files.
+     */
+    unsigned thread_count(std::size_t jobs) const {
+        unsigned n = threads_;
+        if (n == 0) n = std::max(4u, std::thread::hardware_concurrency());
+        std::size_t useful = std::max<std::size_t>(1, jobs / kMinJobsPerThread);
+        return static_cast<unsigned>(std::min<std::size_t>(n, useful));
+    }
+
 public:
     StorageEngine() = default;
 
+    /**
+     * @brief Sets the number of threads used to write multi-file batches.
+     * @param threads Thread count; 0 picks one automatically (at least 4,
+     * since writes mostly wait on the file system).
+     */
+    void set_threads(unsigned threads) { threads_ = threads; }
+
+    /**
+     * @brief Enables or disables per-file output.
+     * @param verbose When false, only callers' summaries are printed.
+     */
+    void set_verbose(bool verbose) { verbose_ = verbose; }
+
+    /**
+     * @brief Prints and clears the batched per-file output.
+     */
+    void flush_report() {
+        if (report_.empty()) return;
+        std::cout << report_ << std::flush;
+        report_.clear();
+    }
+
+    /**
+     * @brief Writes a batch of files concurrently.
+     *
+     * @details Parent directories are created up front in a single pass, then
+     * worker threads claim files from a shared counter, decode and write them. Per-file
+     * report lines and errors are emitted afterwards in job order, so output
+     * does not depend on scheduling. A file that cannot be decoded or
+     * written is reported and skipped; any other exception stops the
+     * workers and is rethrown here once they have all joined.
+     *
+     * @param jobs Files to write; paths must be distinct.
+     * @return Number of files written successfully.
+     */
+    std::size_t write_files(const std::vector<RestoreJob>& jobs) {
+        if (jobs.empty()) return 0;
+        create_parent_dirs(jobs);
+
+        std::vector<char> ok(jobs.size(), 0);
+        std::atomic<std::size_t> next{0};
+        std::exception_ptr failure;
+        std::mutex failure_mutex;
+        auto worker = [&] {
+            for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < jobs.size();) {
+                try {
+                    ok[i] = write_blob(jobs[i].path, jobs[i].content.open(), jobs[i].mode);
+                } catch (const std::runtime_error&) {
+                    ok[i] = false;
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(failure_mutex);
+                    if (!failure) failure = std::current_exception();
+                    next.store(jobs.size(), std::memory_order_relaxed);   // stop claiming work
+                }
+            }
+        };
+
+        unsigned threads = thread_count(jobs.size());
+        std::vector<std::thread> pool;
+        pool.reserve(threads - 1);
+        for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+        worker();
+        for (auto& t : pool) t.join();
+        if (failure) std::rethrow_exception(failure);
+
+        std::size_t written = 0;
+        for (std::size_t i = 0; i < jobs.size(); ++i) {
+            if (ok[i]) {
+                note("Restored: ", jobs[i].path);
+                ++written;
+            } else {
+                std::cerr << "Error: Could not write to file " << jobs[i].path << std::endl;
+            }
+        }
+        return written;
+    }
+
     /**
      * @brief Restores all files referenced by a commit.
      * @param commit Pointer to the commit object.
      * @param graph_manager Provides access to stored blob data.
+     * @return Number of files written.
      */
-    void restore_files(entities::Commit* commit, GraphManager& graph_manager) {
-        if (!commit) return;
+    CheckoutStats restore_files(entities::Commit* commit, GraphManager& graph_manager) {
+        CheckoutStats stats;
+        if (!commit) return stats;
 
         const auto& files = commit->get_files();
-        if (files.empty()) return;
-
+        std::vector<RestoreJob> jobs;
+        jobs.reserve(files.size());
         for (auto it = files.begin(); it != files.end(); ++it) {
-            std::string hash = it->get_hash();
-            std::string content = graph_manager.get_blob_content(hash);
+            jobs.push_back(RestoreJob{it->get_path(), graph_manager.get_blob_packed(it->get_hash()), it->get_mode()});
+        }
+        stats.written = write_files(jobs);
+        flush_report();
+        return stats;
+    }
 
-            save_file_to_disk(it->get_path(), content);
+    /**
+     * @brief Moves the working tree from one commit's snapshot to another's.
+     *
+     * @details The two manifests are walked in path order, skipping the
+     * segments they share. Only added or changed files are written, and
+     * files tracked by @p from but absent from @p to are deleted.
+     * Without a @p from commit every file of @p to is restored. Deletions
+     * are applied first, so a removed file may be replaced by a directory,
+     * and a file whose only change is its mode is rewritten with the new one.
+     *
+     * @param from Commit the working tree currently reflects (may be nullptr).
+     * @param to Target commit.
+     * @param graph_manager Provides access to stored blob data.
+     * @return Counts of written, removed and unchanged files.
+     */
+    CheckoutStats checkout_files(entities::Commit* from, entities::Commit* to,
+                                 GraphManager& graph_manager) {
+        if (!to) return CheckoutStats();
+        if (!from) return restore_files(to, graph_manager);
+
+        CheckoutStats stats;
+        if (from == to) {
+            stats.unchanged = to->get_files().size();
+            return stats;
         }
+
+        std::vector<RestoreJob> jobs;
+        stats.unchanged = entities::Manifest::diff(from->get_files(), to->get_files(),
+            [&](const entities::ManifestEntry* old_entry, const entities::ManifestEntry* new_entry) {
+                if (new_entry) {
+                    jobs.push_back(RestoreJob{new_entry->get_path(),
+                                              graph_manager.get_blob_packed(new_entry->get_hash()),
+                                              new_entry->get_mode()});
+                } else if (old_entry) {
+                    remove_file_from_disk(old_entry->get_path());
+                    ++stats.removed;
+                }
+            });
+        stats.written = write_files(jobs);
+
+        flush_report();
+        return stats;
     }
 
     /**
-     * @brief Writes file content to disk at the given path.
+     * @brief Deletes a tracked file from the working tree, along with any
+     * parent directories it leaves empty.
+     * @param path File path.
+     */
+    void remove_file_from_disk(const std::string& path) {
+        std::error_code ec;
+        if (fs::remove(path, ec)) {
+            note("Removed: ", path);
+            remove_empty_parents(path);
+        } else if (ec) {
+            std::cerr << "Error: Could not remove file " << path << std::endl;
+        }
+    }
+
+    /**
+     * @brief Writes blob content to disk at the given path.
      * @param path Target file path.
-     * @param content File data to write.
+     * @param content View of the data to write.
+     * @param mode entities::kModeRegular or kModeExecutable.
      */
-    void save_file_to_disk(const std::string& path, const std::string& content) {
+    void save_file_to_disk(const std::string& path, const BlobView& content,
+                           std::uint32_t mode = entities::kModeRegular) {
         fs::path file_path(path);
         if (file_path.has_parent_path()) {
-            fs::create_directories(file_path.parent_path());
+            std::error_code ec;
+            fs::create_directories(file_path.parent_path(), ec);
         }
 
-        std::ofstream out_file(path, std::ios::trunc);
-        if (out_file.is_open()) {
-            out_file << content;
-            out_file.close();
-
-            std::cout << "Restored: " << path << std::endl;
+        if (write_blob(path, content, mode)) {
+            note("Restored: ", path);
         } else {
             std::cerr << "Error: Could not write to file " << path << std::endl;
         }
     }
+
+    /**
+     * @brief Writes file content to disk at the given path.
+     * @param path Target file path.
+     * @param content File data to write.
+     * @param mode entities::kModeRegular or kModeExecutable.
+     */
+    void save_file_to_disk(const std::string& path, const std::string& content,
+                           std::uint32_t mode = entities::kModeRegular) {
+        save_file_to_disk(path, BlobView::borrow(content), mode);
+    }
 };
 
 } // namespace core
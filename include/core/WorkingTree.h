@@ -0,0 +1,208 @@
+/**
+ * @file WorkingTree.h
+ * @brief Parallel scan of the working tree against the stat cache.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.3
+ * @date 2026-10-14
+ * @lastModified 2026-10-14
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "FileStat.h"
+#include "StatCache.h"
+#include "../entities/File.h"
+#include "../entities/ObjectId.h"
+
+namespace core {
+
+/**
+ * @brief One regular file found by a scan.
+ */
+struct ScanEntry {
+    std::string path;          ///< Path as tracked by the repository
+    FileStat stat;
+    entities::ObjectId id;     ///< Content id (from the cache or freshly hashed)
+    bool rehashed = false;     ///< True if the file had to be read and hashed
+};
+
+/**
+ * @brief Walks a directory tree with a pool of worker threads.
+ * * Directories are distributed through a shared queue, so wide and deep
+ *   trees both keep every worker busy
+ * * Files whose stat data matches the cache are not opened
+ * * Repository metadata directories (.tri, .git) are skipped; symbolic
+ *   links and special files are ignored
+ */
+class WorkingTree {
+private:
+    std::string root_;      ///< Directory to scan
+    std::string prefix_;    ///< Prepended to relative paths ("" or "root/")
+
+    static bool skipped_dir(const char* name) {
+        return std::strcmp(name, ".tri") == 0 || std::strcmp(name, ".git") == 0;
+    }
+
+public:
+    /**
+     * @brief Prepares a scan rooted at @p root.
+     * @param root Working-tree directory; "." or "" for the current directory.
+     */
+    explicit WorkingTree(const std::string& root) {
+        root_ = root.empty() ? "." : root;
+        prefix_ = (root_ == ".") ? "" : root_ + "/";
+    }
+
+    /**
+     * @brief Reads a file piece by piece.
+     * @param fn Called with each piece, in order; pieces are at most 64 KiB.
+     * @return False if the file cannot be opened or read.
+     */
+    template <typename F>
+    static bool read_chunks(const std::string& path, F&& fn) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+
+        char buf[1 << 16];
+        for (;;) {
+            ssize_t n = ::read(fd, buf, sizeof(buf));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                ::close(fd);
+                return n == 0;
+            }
+            fn(std::string_view(buf, static_cast<std::size_t>(n)));
+        }
+    }
+
+    /**
+     * @brief Reads a whole file.
+     * @return False if the file cannot be opened or read.
+     */
+    static bool read_file(const std::string& path, std::string& out) {
+        out.clear();
+        return read_chunks(path, [&](std::string_view piece) { out.append(piece); });
+    }
+
+    /**
+     * @brief Computes the id of a file on disk without loading it whole.
+     * @param disk_path File to read.
+     * @param path Repository path the id is computed for.
+     * @return False if the file cannot be read.
+     */
+    static bool hash_file(const std::string& disk_path, const std::string& path, entities::ObjectId& out) {
+        entities::File::Hasher hasher(path);
+        if (!read_chunks(disk_path, [&](std::string_view piece) { hasher.update(piece); })) return false;
+        out = hasher.finish();
+        return true;
+    }
+
+    /**
+     * @brief Returns the scanned directory.
+     */
+    const std::string& root() const { return root_; }
+
+    /**
+     * @brief Lists every regular file with its content id.
+     *
+     * @param cache Stat cache used to avoid rehashing unchanged files.
+     * @param threads Number of worker threads (0 = hardware concurrency).
+     * @return Files ordered by path.
+     */
+    std::vector<ScanEntry> scan(const StatCache& cache, unsigned threads = 0) const {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::string> pending{""};   // directories relative to root_, with trailing '/'
+        unsigned busy = 0;
+
+        std::vector<std::vector<ScanEntry>> found(threads);
+
+        auto worker = [&](std::vector<ScanEntry>& out) {
+            for (;;) {
+                std::string dir;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [&] { return !pending.empty() || busy == 0; });
+                    if (pending.empty()) return;
+                    dir = std::move(pending.front());
+                    pending.pop_front();
+                    ++busy;
+                }
+
+                std::vector<std::string> subdirs;
+                std::string dir_path = root_ + "/" + dir;
+                if (DIR* d = ::opendir(dir_path.c_str())) {
+                    int dfd = ::dirfd(d);
+                    while (dirent* ent = ::readdir(d)) {
+                        const char* name = ent->d_name;
+                        if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0))) continue;
+
+                        struct stat st;
+                        if (::fstatat(dfd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) continue;
+
+                        if (S_ISDIR(st.st_mode)) {
+                            if (!skipped_dir(name)) subdirs.push_back(dir + name + "/");
+                            continue;
+                        }
+                        if (!S_ISREG(st.st_mode)) continue;
+
+                        ScanEntry e;
+                        e.path = prefix_ + dir + name;
+                        e.stat = FileStat::from_stat(st);
+                        if (const entities::ObjectId* cached = cache.lookup_clean(e.path, e.stat)) {
+                            e.id = *cached;
+                        } else if (hash_file(dir_path + name, e.path, e.id)) {
+                            e.rehashed = true;
+                        } else {
+                            continue;
+                        }
+                        out.push_back(std::move(e));
+                    }
+                    ::closedir(d);
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    for (auto& s : subdirs) pending.push_back(std::move(s));
+                    --busy;
+                }
+                cv.notify_all();
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned i = 1; i < threads; ++i) pool.emplace_back(worker, std::ref(found[i]));
+        worker(found[0]);
+        for (auto& t : pool) t.join();
+
+        std::vector<ScanEntry> all;
+        std::size_t total = 0;
+        for (const auto& v : found) total += v.size();
+        all.reserve(total);
+        for (auto& v : found) {
+            for (auto& e : v) all.push_back(std::move(e));
+        }
+        std::sort(all.begin(), all.end(),
+            [](const ScanEntry& a, const ScanEntry& b) { return a.path < b.path; });
+        return all;
+    }
+};
+
+} // namespace core
@@ -0,0 +1,369 @@
+/**
+ * @file Sha256.h
+ * @brief SHA-256 content hashing with runtime-selected compression kernels.
+ *
+ * @details Provides the fixed-size binary Digest used to address objects and
+ * an incremental Sha256 hasher. The block compression function is chosen once
+ * per process from the available backends:
+ * - SHA_NI   : x86 SHA extensions (SHA256RNDS2/MSG1/MSG2), detected via CPUID
+ * - PORTABLE : plain C++ implementation, used everywhere else
+ *
+ * Digests are produced and compared in binary; hex conversion is only done
+ * on request (to_hex) for display and text formats.
+ *
+ * Every digest is counted in Stats (Counter::HASHES, HASHED_BYTES).
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.2
+ * @date 2026-10-14
+ * @lastModified 2026-10-14
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include "../core/Stats.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define TRI_SHA256_HAVE_SHANI 1
+#include <immintrin.h>
+#include <cpuid.h>
+#endif
+
+namespace crypto {
+
+/**
+ * @brief 32-byte binary SHA-256 digest.
+ * * Trivially copyable; compared with memcmp
+ */
+struct Digest {
+    static constexpr std::size_t kSize = 32;
+    std::array<std::uint8_t, kSize> bytes{};
+
+    bool operator==(const Digest& o) const { return std::memcmp(bytes.data(), o.bytes.data(), kSize) == 0; }
+    bool operator!=(const Digest& o) const { return !(*this == o); }
+    bool operator<(const Digest& o) const { return std::memcmp(bytes.data(), o.bytes.data(), kSize) < 0; }
+
+    /**
+     * @brief Formats the digest as 64 lowercase hex characters.
+     */
+    std::string to_hex() const {
+        static const char kHex[] = "0123456789abcdef";
+        std::string out(kSize * 2, '0');
+        for (std::size_t i = 0; i < kSize; ++i) {
+            out[2 * i] = kHex[bytes[i] >> 4];
+            out[2 * i + 1] = kHex[bytes[i] & 0x0F];
+        }
+        return out;
+    }
+
+    /**
+     * @brief Parses 64 hex characters.
+     * @throws std::invalid_argument on malformed input.
+     */
+    static Digest from_hex(std::string_view hex) {
+        auto nibble = [](char c) -> int {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        };
+
+        if (hex.size() != kSize * 2) throw std::invalid_argument("Digest::from_hex: bad length");
+        Digest d;
+        for (std::size_t i = 0; i < kSize; ++i) {
+            int hi = nibble(hex[2 * i]), lo = nibble(hex[2 * i + 1]);
+            if (hi < 0 || lo < 0) throw std::invalid_argument("Digest::from_hex: bad digit");
+            d.bytes[i] = static_cast<std::uint8_t>((hi << 4) | lo);
+        }
+        return d;
+    }
+};
+
+/**
+ * @brief Available SHA-256 block compression backends.
+ */
+enum class Sha256Backend {
+    PORTABLE,
+    SHA_NI
+};
+
+namespace detail {
+
+alignas(16) inline constexpr std::uint32_t kSha256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+using CompressFn = void (*)(std::uint32_t state[8], const std::uint8_t* blocks, std::size_t count);
+
+inline std::uint32_t rotr(std::uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+/**
+ * @brief Portable SHA-256 compression of @p count 64-byte blocks.
+ */
+inline void compress_portable(std::uint32_t state[8], const std::uint8_t* p, std::size_t count) {
+    for (; count > 0; --count, p += 64) {
+        std::uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = (std::uint32_t(p[4 * i]) << 24) | (std::uint32_t(p[4 * i + 1]) << 16) |
+                   (std::uint32_t(p[4 * i + 2]) << 8) | std::uint32_t(p[4 * i + 3]);
+        }
+        for (int i = 16; i < 64; ++i) {
+            std::uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            std::uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        std::uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            std::uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) +
+                               ((e & f) ^ (~e & g)) + kSha256K[i] + w[i];
+            std::uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) +
+                               ((a & b) ^ (a & c) ^ (b & c));
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+}
+
+#ifdef TRI_SHA256_HAVE_SHANI
+/**
+ * @brief SHA-256 compression using the x86 SHA extensions.
+ *
+ * @details State is kept as ABEF/CDGH lane pairs as required by SHA256RNDS2.
+ * Each iteration of the 16-step loop performs four rounds and extends the
+ * message schedule four words ahead with SHA256MSG1/MSG2.
+ */
+__attribute__((target("sha,sse4.1,ssse3")))
+inline void compress_shani(std::uint32_t state[8], const std::uint8_t* p, std::size_t count) {
+    const __m128i kMask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+    __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);              // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B);        // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8); // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);      // CDGH
+
+    for (; count > 0; --count, p += 64) {
+        const __m128i abef_save = state0;
+        const __m128i cdgh_save = state1;
+        __m128i w[4];
+
+#pragma GCC unroll 16
+        for (int g = 0; g < 16; ++g) {
+            if (g < 4) {
+                w[g] = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * g)), kMask);
+            }
+            __m128i& cur = w[g & 3];
+
+            __m128i msg = _mm_add_epi32(
+                cur, _mm_load_si128(reinterpret_cast<const __m128i*>(&kSha256K[4 * g])));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+
+            if (g >= 3 && g <= 14) {
+                __m128i& next = w[(g + 1) & 3];
+                next = _mm_add_epi32(next, _mm_alignr_epi8(cur, w[(g - 1) & 3], 4));
+                next = _mm_sha256msg2_epu32(next, cur);
+            }
+
+            msg = _mm_shuffle_epi32(msg, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+            if (g >= 1 && g <= 12) {
+                __m128i& prev = w[(g - 1) & 3];
+                prev = _mm_sha256msg1_epu32(prev, cur);
+            }
+        }
+
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);           // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);        // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);     // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);        // HGFE
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+
+/**
+ * @brief Checks CPUID for SHA, SSE4.1 and SSSE3 support.
+ */
+inline bool cpu_has_shani() {
+    unsigned a, b, c, d;
+    if (!__get_cpuid(1, &a, &b, &c, &d)) return false;
+    bool ssse3 = (c & (1u << 9)) != 0;
+    bool sse41 = (c & (1u << 19)) != 0;
+    if (!__get_cpuid_count(7, 0, &a, &b, &c, &d)) return false;
+    bool sha = (b & (1u << 29)) != 0;
+    return ssse3 && sse41 && sha;
+}
+#endif
+
+inline bool backend_supported(Sha256Backend b) {
+    if (b == Sha256Backend::PORTABLE) return true;
+#ifdef TRI_SHA256_HAVE_SHANI
+    static const bool has_shani = cpu_has_shani();
+    return has_shani;
+#else
+    return false;
+#endif
+}
+
+inline Sha256Backend& active_backend() {
+    static Sha256Backend backend = backend_supported(Sha256Backend::SHA_NI)
+        ? Sha256Backend::SHA_NI : Sha256Backend::PORTABLE;
+    return backend;
+}
+
+inline CompressFn compress_for(Sha256Backend b) {
+#ifdef TRI_SHA256_HAVE_SHANI
+    if (b == Sha256Backend::SHA_NI) return compress_shani;
+#endif
+    (void)b;
+    return compress_portable;
+}
+
+} // namespace detail
+
+/**
+ * @brief Returns the backend used by newly created hashers.
+ */
+inline Sha256Backend sha256_backend() { return detail::active_backend(); }
+
+/**
+ * @brief Human-readable name of a backend.
+ */
+inline const char* sha256_backend_name(Sha256Backend b) {
+    return b == Sha256Backend::SHA_NI ? "sha-ni" : "portable";
+}
+
+/**
+ * @brief Overrides the compression backend (e.g. for benchmarks or testing).
+ * @param b Requested backend.
+ * @return False (and nothing changes) if the CPU does not support it.
+ * @note Not thread-safe; call before hashing starts.
+ */
+inline bool set_sha256_backend(Sha256Backend b) {
+    if (!detail::backend_supported(b)) return false;
+    detail::active_backend() = b;
+    return true;
+}
+
+/**
+ * @brief Incremental SHA-256 hasher.
+ * * Feed data with update(), obtain the digest once with finish()
+ */
+class Sha256 {
+private:
+    std::uint32_t state_[8];
+    std::uint8_t buffer_[64];
+    std::size_t buffered_;
+    std::uint64_t total_;
+    detail::CompressFn compress_;
+
+public:
+    Sha256()
+        : state_{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19},
+          buffered_(0), total_(0), compress_(detail::compress_for(sha256_backend())) {}
+
+    /**
+     * @brief Absorbs @p len bytes.
+     */
+    Sha256& update(const void* data, std::size_t len) {
+        const std::uint8_t* p = static_cast<const std::uint8_t*>(data);
+        total_ += len;
+
+        if (buffered_ > 0) {
+            std::size_t take = std::min(len, sizeof(buffer_) - buffered_);
+            std::memcpy(buffer_ + buffered_, p, take);
+            buffered_ += take;
+            p += take;
+            len -= take;
+            if (buffered_ < sizeof(buffer_)) return *this;
+            compress_(state_, buffer_, 1);
+            buffered_ = 0;
+        }
+
+        if (len >= 64) {
+            std::size_t blocks = len / 64;
+            compress_(state_, p, blocks);
+            p += blocks * 64;
+            len -= blocks * 64;
+        }
+
+        if (len > 0) {
+            std::memcpy(buffer_, p, len);
+            buffered_ = len;
+        }
+        return *this;
+    }
+
+    Sha256& update(std::string_view s) { return update(s.data(), s.size()); }
+
+    /**
+     * @brief Absorbs @p s as a length-framed field: decimal length, NUL, bytes.
+     * @details Framing every variable-length field keeps field boundaries
+     * part of the digest, so ("ab", "c") and ("a", "bc") hash differently.
+     */
+    Sha256& update_field(std::string_view s) {
+        std::string len = std::to_string(s.size());
+        update(len.data(), len.size() + 1);   // include the terminating NUL
+        return update(s);
+    }
+
+    /**
+     * @brief Applies padding and returns the digest.
+     * @note The hasher must not be updated afterwards.
+     */
+    Digest finish() {
+        core::Stats::count(core::Counter::HASHES);
+        core::Stats::count(core::Counter::HASHED_BYTES, total_);
+        std::uint64_t bits = total_ * 8;
+        std::uint8_t pad[72] = {0x80};
+        std::size_t pad_len = (buffered_ < 56) ? 56 - buffered_ : 120 - buffered_;
+        for (int i = 0; i < 8; ++i) pad[pad_len + i] = static_cast<std::uint8_t>(bits >> (56 - 8 * i));
+        update(pad, pad_len + 8);
+
+        Digest d;
+        for (int i = 0; i < 8; ++i) {
+            d.bytes[4 * i] = static_cast<std::uint8_t>(state_[i] >> 24);
+            d.bytes[4 * i + 1] = static_cast<std::uint8_t>(state_[i] >> 16);
+            d.bytes[4 * i + 2] = static_cast<std::uint8_t>(state_[i] >> 8);
+            d.bytes[4 * i + 3] = static_cast<std::uint8_t>(state_[i]);
+        }
+        return d;
+    }
+
+    /**
+     * @brief One-shot digest of a byte string.
+     */
+    static Digest hash(std::string_view s) {
+        return Sha256().update(s).finish();
+    }
+};
+
+} // namespace crypto
@@ -0,0 +1,85 @@
+/**
+ * @file AppendOnlyArray.h
+ * @brief Growable array whose elements never move.
+ *
+ * @details Elements live in segments of doubling size (the first holds
+ * kFirstSegment elements, each next one twice as many as the one before),
+ * allocated as the array grows. Nothing is ever copied or freed while the
+ * array lives, so a reference to an element stays valid across appends.
+ *
+ * This makes the array safe to share between one appending thread and any
+ * number of reading threads, provided each reader only reads the prefix
+ * that existed when the array was handed to it (through a release/acquire
+ * pair, such as publishing a snapshot): appends write only to elements and
+ * segment slots no such reader touches.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.0
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace data_structures {
+
+/**
+ * @brief Append-only sequence with stable element addresses.
+ * * operator[] is two shifts and two loads; push_back is amortized O(1)
+ *   and never relocates existing elements
+ * * Only one thread may append; readers must stay below a published size
+ */
+template <typename T>
+class AppendOnlyArray {
+private:
+    static constexpr unsigned kFirstBits = 10;
+    static constexpr std::size_t kFirstSegment = std::size_t(1) << kFirstBits;
+    static constexpr unsigned kMaxSegments = 48;
+
+    std::unique_ptr<T[]> segments_[kMaxSegments];
+    std::size_t size_ = 0;
+
+    /**
+     * @brief Maps an index to its segment and the offset within it.
+     * @details Segment k starts at kFirstSegment * (2^k - 1).
+     */
+    static std::pair<unsigned, std::size_t> locate(std::size_t i) {
+        std::size_t biased = (i >> kFirstBits) + 1;
+        unsigned k = static_cast<unsigned>(sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(biased));
+        return {k, i - kFirstSegment * ((std::size_t(1) << k) - 1)};
+    }
+
+public:
+    AppendOnlyArray() = default;
+    AppendOnlyArray(const AppendOnlyArray&) = delete;
+    AppendOnlyArray& operator=(const AppendOnlyArray&) = delete;
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    T& operator[](std::size_t i) {
+        auto [k, off] = locate(i);
+        return segments_[k][off];
+    }
+
+    const T& operator[](std::size_t i) const {
+        auto [k, off] = locate(i);
+        return segments_[k][off];
+    }
+
+    /**
+     * @brief Appends an element.
+     * @return Its index.
+     */
+    std::size_t push_back(const T& value) {
+        auto [k, off] = locate(size_);
+        if (!segments_[k]) segments_[k].reset(new T[kFirstSegment << k]);
+        segments_[k][off] = value;
+        return size_++;
+    }
+};
+
+} // namespace data_structures
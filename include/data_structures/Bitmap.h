@@ -0,0 +1,210 @@
+/**
+ * @file Bitmap.h
+ * @brief Dense bitset with EWAH run-length compression for storage.
+ *
+ * @details Bits are kept uncompressed in 64-bit words while in use, which
+ * makes set algebra a tight loop over words. For storage a bitmap is
+ * encoded with EWAH (Enhanced Word-Aligned Hybrid): the word stream is
+ * split into runs of identical all-0 or all-1 words followed by verbatim
+ * "literal" words, each group introduced by one marker word:
+ *
+ * - bit 0      : value of the run words
+ * - bits 1-32  : number of run words
+ * - bits 33-63 : number of literal words that follow the marker
+ *
+ * Reachability sets are mostly long runs of ones (old history) and zeros
+ * (unrelated history), so they shrink to a few words. Compressed bitmaps
+ * can be OR-ed into a dense one without being expanded first.
+ *
+ * Encoded layout (little-endian): u32 bit count, u32 stream word count,
+ * then the stream words as u64.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.0
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <stdexcept>
+
+namespace data_structures {
+
+/**
+ * @brief Fixed-size set of small integers.
+ * * OR / AND-NOT of two bitmaps cost one operation per 64 bits
+ * * The size only grows through resize(); bits beyond it are always 0
+ */
+class Bitmap {
+private:
+    static constexpr std::uint64_t kAllOnes = ~std::uint64_t(0);
+    static constexpr std::uint64_t kMaxRun = 0xffffffffu;
+    static constexpr std::uint64_t kMaxLiterals = 0x7fffffffu;
+
+    std::vector<std::uint64_t> words_;
+    std::size_t bits_ = 0;
+
+    static void put_u32(std::string& out, std::uint32_t v) {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+    }
+
+    static void put_u64(std::string& out, std::uint64_t v) {
+        for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+    }
+
+    static std::uint64_t load(std::string_view in, std::size_t at, int bytes) {
+        std::uint64_t v = 0;
+        for (int i = 0; i < bytes; ++i) v |= static_cast<std::uint64_t>(static_cast<unsigned char>(in[at + i])) << (8 * i);
+        return v;
+    }
+
+    static bool clean(std::uint64_t w) { return w == 0 || w == kAllOnes; }
+
+    static void put_marker(std::vector<std::uint64_t>& stream, bool bit, std::uint64_t run, std::uint64_t literals) {
+        stream.push_back((bit ? 1u : 0u) | (run << 1) | (literals << 33));
+    }
+
+public:
+    Bitmap() = default;
+
+    /**
+     * @brief Creates a bitmap of @p bits zero bits.
+     */
+    explicit Bitmap(std::size_t bits) { resize(bits); }
+
+    /**
+     * @brief Grows (or shrinks) the bitmap; new bits are 0.
+     */
+    void resize(std::size_t bits) {
+        words_.resize((bits + 63) / 64, 0);
+        if (bits < bits_ && bits % 64) words_.back() &= (std::uint64_t(1) << (bits % 64)) - 1;
+        bits_ = bits;
+    }
+
+    std::size_t size() const { return bits_; }
+
+    void set(std::size_t i) { words_[i / 64] |= std::uint64_t(1) << (i % 64); }
+
+    bool test(std::size_t i) const { return i < bits_ && (words_[i / 64] >> (i % 64)) & 1; }
+
+    /**
+     * @brief Returns the number of set bits.
+     */
+    std::size_t count() const {
+        std::size_t n = 0;
+        for (std::uint64_t w : words_) n += static_cast<std::size_t>(__builtin_popcountll(w));
+        return n;
+    }
+
+    /**
+     * @brief Adds every bit of @p other (which must not be larger).
+     */
+    Bitmap& operator|=(const Bitmap& other) {
+        for (std::size_t i = 0; i < other.words_.size(); ++i) words_[i] |= other.words_[i];
+        return *this;
+    }
+
+    /**
+     * @brief Removes every bit of @p other.
+     */
+    Bitmap& and_not(const Bitmap& other) {
+        std::size_t n = std::min(words_.size(), other.words_.size());
+        for (std::size_t i = 0; i < n; ++i) words_[i] &= ~other.words_[i];
+        return *this;
+    }
+
+    /**
+     * @brief Calls fn(index) for every set bit, in increasing order.
+     */
+    template <typename F>
+    void for_each(F&& fn) const {
+        for (std::size_t i = 0; i < words_.size(); ++i) {
+            for (std::uint64_t w = words_[i]; w; w &= w - 1) {
+                fn(i * 64 + static_cast<std::size_t>(__builtin_ctzll(w)));
+            }
+        }
+    }
+
+    /**
+     * @brief Encodes the bitmap with EWAH.
+     */
+    std::string encode_ewah() const {
+        std::vector<std::uint64_t> stream;
+        std::size_t i = 0;
+        const std::size_t n = words_.size();
+        while (i < n) {
+            bool bit = words_[i] == kAllOnes;
+            std::uint64_t run = 0;
+            while (i < n && clean(words_[i]) && (words_[i] == kAllOnes) == bit && run < kMaxRun) {
+                ++run;
+                ++i;
+            }
+            std::size_t lit_begin = i;
+            while (i < n && !clean(words_[i]) && i - lit_begin < kMaxLiterals) ++i;
+            put_marker(stream, bit, run, i - lit_begin);
+            stream.insert(stream.end(), words_.begin() + lit_begin, words_.begin() + i);
+        }
+
+        std::string out;
+        out.reserve(8 + stream.size() * 8);
+        put_u32(out, static_cast<std::uint32_t>(bits_));
+        put_u32(out, static_cast<std::uint32_t>(stream.size()));
+        for (std::uint64_t w : stream) put_u64(out, w);
+        return out;
+    }
+
+    /**
+     * @brief Returns the encoded size of the EWAH bitmap at the start of @p in.
+     * @throws std::runtime_error if @p in is too short.
+     */
+    static std::size_t ewah_size(std::string_view in) {
+        if (in.size() < 8) throw std::runtime_error("Bitmap: truncated EWAH header");
+        std::size_t total = 8 + static_cast<std::size_t>(load(in, 4, 4)) * 8;
+        if (in.size() < total) throw std::runtime_error("Bitmap: truncated EWAH stream");
+        return total;
+    }
+
+    /**
+     * @brief Returns the number of bits of an encoded bitmap.
+     */
+    static std::size_t ewah_bits(std::string_view in) {
+        ewah_size(in);
+        return static_cast<std::size_t>(load(in, 0, 4));
+    }
+
+    /**
+     * @brief ORs an EWAH-encoded bitmap into this one without expanding it.
+     * @throws std::runtime_error if the encoding is corrupt or has more
+     * bits than this bitmap.
+     */
+    void or_ewah(std::string_view in) {
+        std::size_t total = ewah_size(in);
+        if (load(in, 0, 4) > bits_) throw std::runtime_error("Bitmap: EWAH bitmap is larger than target");
+
+        std::size_t w = 0;
+        for (std::size_t at = 8; at < total;) {
+            std::uint64_t marker = load(in, at, 8);
+            at += 8;
+            std::uint64_t run = (marker >> 1) & kMaxRun;
+            std::uint64_t literals = marker >> 33;
+            if (run > words_.size() - w || literals > words_.size() - w - run ||
+                literals * 8 > total - at) {
+                throw std::runtime_error("Bitmap: corrupt EWAH stream");
+            }
+            if (marker & 1) {
+                for (std::uint64_t k = 0; k < run; ++k) words_[w + k] = kAllOnes;
+            }
+            w += run;
+            for (std::uint64_t k = 0; k < literals; ++k, at += 8) words_[w++] |= load(in, at, 8);
+        }
+        if (bits_ % 64 && !words_.empty()) words_.back() &= (std::uint64_t(1) << (bits_ % 64)) - 1;
+    }
+};
+
+} // namespace data_structures
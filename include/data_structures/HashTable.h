@@ -4,185 +4,279 @@
  *
  * @details
  * This file defines a templated HashTable class that maps keys to values
- * using hashing with separate chaining. The container supports insertion,
- * lookup, removal, and automatic resizing based on load factor.
+ * using open addressing with Robin Hood linear probing. Entries live in one
+ * flat slot array whose capacity is a power of two, so a lookup is a short,
+ * cache-friendly scan rather than a walk over heap-allocated chain nodes.
+ * Probe lengths can be reported through an optional policy parameter,
+ * which records nothing by default.
  *
  * @author Umut Ertuğrul Daşgın
  * @note Documentation maintained by Deniz Kayra Aydın and Ömer Kağan Zafer.
- * @version 1.1
+ * @version 1.4
  * @date 2025-12-24
- * @lastModified 2026-01-10
+ * @lastModified 2026-10-14
  * @copyright Copyright (c) 2025
  */
 
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 #include <utility>
 #include <functional>
+#include <new>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 namespace data_structures {
 
 /**
- * @brief A templated hash table with separate chaining.
+ * @brief Probe policy that records nothing; the default for HashTable.
+ * @details A policy provides `static void record(std::uint32_t probes)`,
+ * called once per lookup with the number of slots it inspected.
+ */
+struct NoProbeCount {
+    static void record(std::uint32_t) {}
+};
+
+/**
+ * @brief A templated open-addressing hash table.
  *
  * @details
- * The HashTable class stores key–value pairs in buckets indexed by a hash
- * function. Collisions are handled using linked lists, and the table is
- * automatically rehashed when the load factor exceeds a predefined threshold.
+ * Slots are probed linearly from the key's home position. Robin Hood
+ * insertion keeps probe sequences short by letting an entry that is further
+ * from its home displace one that is closer, and lets lookups stop as soon
+ * as they meet an entry closer to home than the probe itself. Removal uses
+ * backward shifting, so no tombstones accumulate. Each slot caches its key's
+ * full hash, which makes rehashing and negative comparisons cheap.
+ *
+ * Lookups accept any key type @c Q that compares equal to @c K and hashes
+ * consistently with it (e.g. @c std::string_view for @c std::string keys),
+ * so callers do not need to construct a key just to probe the table.
  *
  * @tparam K Type of keys.
  * @tparam V Type of values.
+ * @tparam ProbeCount Receives the probe count of every lookup (NoProbeCount
+ * compiles to nothing).
  */
-template <typename K, typename V>
+template <typename K, typename V, typename ProbeCount = NoProbeCount>
 class HashTable {
 private:
     /**
      * @brief Internal hash table entry.
-     *
-     * @details
-     * Represents a single key–value pair stored in the table. Entries within
-     * the same bucket are linked together to resolve collisions.
      */
-    struct HashEntry {
+    struct Slot {
         K key;
         V value;
-        HashEntry* next;
-
-        explicit HashEntry(const K& k, const V& v) : key(k), value(v), next(nullptr) {}
-        explicit HashEntry(K&& k, V&& v) : key(std::move(k)), value(std::move(v)), next(nullptr) {}
     };
 
-    HashEntry** buckets_;          ///< Array of bucket pointers
-    std::size_t capacity_;         ///< Number of buckets
+    Slot* slots_;                  ///< Raw slot storage (constructed only where dist_ != 0)
+    std::size_t* hashes_;          ///< Cached hash per slot
+    std::uint32_t* dist_;          ///< Probe distance + 1; 0 marks an empty slot
+    std::size_t capacity_;         ///< Number of slots (power of two, or 0)
     std::size_t size_;             ///< Number of stored elements
     const float load_factor_threshold_ = 0.75f; ///< Rehash threshold
 
     /**
-     * @brief Computes the hash index for a given key.
+     * @brief Hashes a key or a compatible lookup key.
      *
-     * @details
-     * Uses the standard library hash function and maps the result into
-     * the valid bucket range.
-     *
-     * @param[in] key Key to hash.
-     * @return Index of the corresponding bucket.
+     * @details Anything convertible to std::string_view is hashed as a
+     * string_view, which the standard guarantees to match std::hash<std::string>.
      */
-    std::size_t hash_func(const K& key) const {
-        return std::hash<K>{}(key) % capacity_;
+    template <typename Q>
+    static std::size_t hash_of(const Q& key) {
+        if constexpr (std::is_convertible<const Q&, std::string_view>::value) {
+            return std::hash<std::string_view>{}(std::string_view(key));
+        } else {
+            return std::hash<Q>{}(key);
+        }
     }
 
     /**
-     * @brief Clears all entries from the hash table.
+     * @brief Maps a hash to its home slot.
      *
-     * @details
-     * Deallocates all internal nodes while keeping the bucket array intact.
+     * @details Fibonacci multiplication spreads weak hashes (such as the
+     * identity hash used for integers) across the power-of-two table.
+     */
+    std::size_t home_of(std::size_t h) const {
+        return static_cast<std::size_t>((static_cast<std::uint64_t>(h) * 0x9E3779B97F4A7C15ull) >> 32) & (capacity_ - 1);
+    }
+
+    static std::size_t round_up_pow2(std::size_t n) {
+        std::size_t cap = 8;
+        while (cap < n) cap <<= 1;
+        return cap;
+    }
+
+    void allocate(std::size_t cap) {
+        capacity_ = cap;
+        slots_ = static_cast<Slot*>(::operator new(sizeof(Slot) * cap, std::align_val_t(alignof(Slot))));
+        hashes_ = new std::size_t[cap];
+        dist_ = new std::uint32_t[cap]();
+    }
+
+    void deallocate() noexcept {
+        if (slots_) ::operator delete(slots_, std::align_val_t(alignof(Slot)));
+        delete[] hashes_;
+        delete[] dist_;
+        slots_ = nullptr;
+        hashes_ = nullptr;
+        dist_ = nullptr;
+        capacity_ = 0;
+    }
+
+    /**
+     * @brief Destroys all entries while keeping the slot array.
      */
     void clear_internal() noexcept {
         for (std::size_t i = 0; i < capacity_; ++i) {
-            HashEntry* entry = buckets_[i];
-            while (entry) {
-                HashEntry* temp = entry;
-                entry = entry->next;
-                delete temp;
+            if (dist_[i]) {
+                slots_[i].~Slot();
+                dist_[i] = 0;
             }
-            buckets_[i] = nullptr;
         }
         size_ = 0;
     }
 
     /**
-     * @brief Copies the contents of another hash table.
-     *
-     * @details
-     * Performs a deep copy of all buckets and chained entries.
-     *
-     * @param[in] other HashTable to copy from.
+     * @brief Locates the slot holding a key.
+     * @return Slot index or capacity_ if absent.
      */
-    void copy_from(const HashTable& other) {
-        buckets_ = new HashEntry*[other.capacity_];
-        capacity_ = other.capacity_;
-        size_ = 0;
-
-        for (std::size_t i = 0; i < capacity_; ++i) buckets_[i] = nullptr;
+    template <typename Q>
+    std::size_t find_index(const Q& key, std::size_t h) const {
+        if (size_ == 0) return capacity_;
+
+        std::size_t idx = home_of(h);
+        for (std::uint32_t d = 1;; ++d) {
+            std::uint32_t sd = dist_[idx];
+            if (sd < d) return probed(d, capacity_);   // empty, or an entry closer to home: key absent
+            if (hashes_[idx] == h && slots_[idx].key == key) return probed(d, idx);
+            idx = (idx + 1) & (capacity_ - 1);
+        }
+    }
 
-        for (std::size_t i = 0; i < other.capacity_; ++i) {
-            HashEntry* curr = other.buckets_[i];
-            HashEntry** tail_ptr = &buckets_[i];
+    static std::size_t probed(std::uint32_t probes, std::size_t result) {
+        ProbeCount::record(probes);
+        return result;
+    }
 
-            while (curr) {
-                *tail_ptr = new HashEntry(curr->key, curr->value);
-                tail_ptr = &((*tail_ptr)->next);
-                curr = curr->next;
+    /**
+     * @brief Inserts a key known to be absent, displacing richer entries.
+     */
+    void insert_new(std::size_t h, K&& key, V&& value) {
+        std::size_t idx = home_of(h);
+        std::uint32_t d = 1;
+
+        Slot carry{std::move(key), std::move(value)};
+        for (;;) {
+            if (dist_[idx] == 0) {
+                new (&slots_[idx]) Slot{std::move(carry.key), std::move(carry.value)};
+                hashes_[idx] = h;
+                dist_[idx] = d;
                 ++size_;
+                return;
+            }
+            if (dist_[idx] < d) {
+                std::swap(carry, slots_[idx]);
+                std::swap(h, hashes_[idx]);
+                std::swap(d, dist_[idx]);
             }
+            idx = (idx + 1) & (capacity_ - 1);
+            ++d;
         }
     }
 
     /**
      * @brief Rehashes the table to a new capacity.
      *
-     * @details
-     * Redistributes all existing entries into a new bucket array
-     * according to the updated capacity.
-     *
-     * @param[in] new_capacity New number of buckets.
+     * @param[in] new_capacity New number of slots (power of two).
      */
     void rehash(std::size_t new_capacity) {
-        HashEntry** new_buckets = new HashEntry*[new_capacity];
-        for (std::size_t i = 0; i < new_capacity; ++i) new_buckets[i] = nullptr;
+        Slot* old_slots = slots_;
+        std::size_t* old_hashes = hashes_;
+        std::uint32_t* old_dist = dist_;
+        std::size_t old_cap = capacity_;
 
-        for (std::size_t i = 0; i < capacity_; ++i) {
-            HashEntry* entry = buckets_[i];
-            while (entry) {
-                HashEntry* next = entry->next;
-                std::size_t new_idx = std::hash<K>{}(entry->key) % new_capacity;
-                entry->next = new_buckets[new_idx];
-                new_buckets[new_idx] = entry;
-                entry = next;
-            }
+        allocate(new_capacity);
+        size_ = 0;
+
+        for (std::size_t i = 0; i < old_cap; ++i) {
+            if (!old_dist[i]) continue;
+            insert_new(old_hashes[i], std::move(old_slots[i].key), std::move(old_slots[i].value));
+            old_slots[i].~Slot();
         }
 
-        delete[] buckets_;
-        buckets_ = new_buckets;
-        capacity_ = new_capacity;
+        if (old_slots) ::operator delete(old_slots, std::align_val_t(alignof(Slot)));
+        delete[] old_hashes;
+        delete[] old_dist;
+    }
+
+    void grow_for(std::size_t n) {
+        if (capacity_ == 0 || static_cast<float>(n) > load_factor_threshold_ * capacity_) {
+            std::size_t cap = capacity_ ? capacity_ : 8;
+            while (static_cast<float>(n) > load_factor_threshold_ * cap) cap <<= 1;
+            rehash(cap);
+        }
+    }
+
+    /**
+     * @brief Copies the contents of another hash table.
+     *
+     * @details Performs a deep copy of every occupied slot.
+     *
+     * @param[in] other HashTable to copy from.
+     */
+    void copy_from(const HashTable& other) {
+        slots_ = nullptr;
+        hashes_ = nullptr;
+        dist_ = nullptr;
+        capacity_ = 0;
+        size_ = 0;
+        if (other.capacity_ == 0) return;
+
+        allocate(other.capacity_);
+        for (std::size_t i = 0; i < capacity_; ++i) {
+            if (!other.dist_[i]) continue;
+            new (&slots_[i]) Slot{other.slots_[i].key, other.slots_[i].value};
+            hashes_[i] = other.hashes_[i];
+            dist_[i] = other.dist_[i];
+        }
+        size_ = other.size_;
     }
 
 public:
     /**
-     * @brief Constructs a hash table with a given initial capacity.
+     * @brief Constructs a hash table able to hold @p expected entries without rehashing.
      *
-     * @param[in] cap Initial number of buckets.
+     * @param[in] expected Expected number of elements.
      */
-    explicit HashTable(std::size_t cap = 101) : capacity_(cap), size_(0) {
-        buckets_ = new HashEntry*[capacity_];
-        for (std::size_t i = 0; i < capacity_; ++i) buckets_[i] = nullptr;
+    explicit HashTable(std::size_t expected = 0)
+        : slots_(nullptr), hashes_(nullptr), dist_(nullptr), capacity_(0), size_(0) {
+        if (expected) reserve(expected);
     }
 
     /**
      * @brief Destroys the hash table and releases all allocated memory.
      */
     ~HashTable() {
-        clear_internal();
-        delete[] buckets_;
+        if (capacity_) clear_internal();
+        deallocate();
     }
 
     /**
      * @brief Copy constructor.
      */
-    HashTable(const HashTable& other) : buckets_(nullptr), capacity_(0), size_(0) {
-        copy_from(other);
-    }
+    HashTable(const HashTable& other) { copy_from(other); }
 
     /**
      * @brief Copy assignment operator.
      */
     HashTable& operator=(const HashTable& other) {
         if (this == &other) return *this;
-        clear_internal();
-        delete[] buckets_;
+        if (capacity_) clear_internal();
+        deallocate();
         copy_from(other);
         return *this;
     }
@@ -191,8 +285,11 @@ public:
      * @brief Move constructor.
      */
     HashTable(HashTable&& other) noexcept
-        : buckets_(other.buckets_), capacity_(other.capacity_), size_(other.size_) {
-        other.buckets_ = nullptr;
+        : slots_(other.slots_), hashes_(other.hashes_), dist_(other.dist_),
+          capacity_(other.capacity_), size_(other.size_) {
+        other.slots_ = nullptr;
+        other.hashes_ = nullptr;
+        other.dist_ = nullptr;
         other.capacity_ = 0;
         other.size_ = 0;
     }
@@ -202,12 +299,16 @@ public:
      */
     HashTable& operator=(HashTable&& other) noexcept {
         if (this == &other) return *this;
-        clear_internal();
-        delete[] buckets_;
-        buckets_ = other.buckets_;
+        if (capacity_) clear_internal();
+        deallocate();
+        slots_ = other.slots_;
+        hashes_ = other.hashes_;
+        dist_ = other.dist_;
         capacity_ = other.capacity_;
         size_ = other.size_;
-        other.buckets_ = nullptr;
+        other.slots_ = nullptr;
+        other.hashes_ = nullptr;
+        other.dist_ = nullptr;
         other.capacity_ = 0;
         other.size_ = 0;
         return *this;
@@ -226,7 +327,16 @@ public:
     /**
      * @brief Removes all elements from the table.
      */
-    void clear() { clear_internal(); }
+    void clear() { if (capacity_) clear_internal(); }
+
+    /**
+     * @brief Ensures @p n elements fit without further rehashing.
+     *
+     * @param[in] n Number of elements to make room for.
+     */
+    void reserve(std::size_t n) {
+        grow_for(n);
+    }
 
     /**
      * @brief Inserts or updates a key–value pair.
@@ -235,25 +345,66 @@ public:
      * @param[in] val Value associated with the key.
      */
     void put(const K& key, const V& val) {
-        if ((float)(size_ + 1) / capacity_ > load_factor_threshold_) {
-            rehash(capacity_ * 2);
+        std::size_t h = hash_of(key);
+        std::size_t idx = find_index(key, h);
+        if (idx != capacity_) {
+            slots_[idx].value = val;
+            return;
         }
+        grow_for(size_ + 1);
+        insert_new(h, K(key), V(val));
+    }
 
-        std::size_t idx = hash_func(key);
-        HashEntry* entry = buckets_[idx];
-
-        while (entry) {
-            if (entry->key == key) {
-                entry->value = val;
-                return;
-            }
-            entry = entry->next;
+    /**
+     * @brief Inserts or updates a key–value pair, moving both in.
+     */
+    void put(K&& key, V&& val) {
+        std::size_t h = hash_of(key);
+        std::size_t idx = find_index(key, h);
+        if (idx != capacity_) {
+            slots_[idx].value = std::move(val);
+            return;
         }
+        grow_for(size_ + 1);
+        insert_new(h, std::move(key), std::move(val));
+    }
+
+    /**
+     * @brief Inserts a key–value pair only if the key is absent.
+     *
+     * @param[in] key Key to insert.
+     * @param[in] val Value associated with the key.
+     * @return true if inserted, false if the key already existed (value untouched).
+     * @note One probe sequence; replaces the contains()+put() pattern.
+     */
+    bool insert(const K& key, const V& val) {
+        std::size_t h = hash_of(key);
+        if (find_index(key, h) != capacity_) return false;
+        grow_for(size_ + 1);
+        insert_new(h, K(key), V(val));
+        return true;
+    }
+
+    /**
+     * @brief Looks up a key without throwing.
+     *
+     * @param[in] key Key (or compatible lookup key) to find.
+     * @return Pointer to the value, or nullptr if absent. Invalidated by
+     * any later insertion or removal.
+     */
+    template <typename Q>
+    V* find(const Q& key) {
+        std::size_t idx = find_index(key, hash_of(key));
+        return idx == capacity_ ? nullptr : &slots_[idx].value;
+    }
 
-        HashEntry* new_node = new HashEntry(key, val);
-        new_node->next = buckets_[idx];
-        buckets_[idx] = new_node;
-        ++size_;
+    /**
+     * @brief Looks up a key without throwing (const version).
+     */
+    template <typename Q>
+    const V* find(const Q& key) const {
+        std::size_t idx = find_index(key, hash_of(key));
+        return idx == capacity_ ? nullptr : &slots_[idx].value;
     }
 
     /**
@@ -265,13 +416,9 @@ public:
      * @throws std::runtime_error if the key is not found.
      */
     V& get(const K& key) {
-        std::size_t idx = hash_func(key);
-        HashEntry* entry = buckets_[idx];
-        while (entry) {
-            if (entry->key == key) return entry->value;
-            entry = entry->next;
-        }
-        throw std::runtime_error("HashTable::get key not found");
+        V* v = find(key);
+        if (!v) throw std::runtime_error("HashTable::get key not found");
+        return *v;
     }
 
     /**
@@ -281,16 +428,12 @@ public:
      * @return Const reference to the associated value.
      *
      * @throws std::runtime_error if the key is not found.
-     * @note Time complexity: O(1) average case, O(n) worst case.
+     * @note Time complexity: O(1) average case.
      */
     const V& get(const K& key) const {
-        std::size_t idx = hash_func(key);
-        const HashEntry* entry = buckets_[idx];
-        while (entry) {
-            if (entry->key == key) return entry->value;
-            entry = entry->next;
-        }
-        throw std::runtime_error("HashTable::get key not found");
+        const V* v = find(key);
+        if (!v) throw std::runtime_error("HashTable::get key not found");
+        return *v;
     }
 
     /**
@@ -299,36 +442,49 @@ public:
      * @param[in] key Key to check.
      * @return true if the key exists, false otherwise.
      */
-    bool contains(const K& key) const {
-        std::size_t idx = hash_func(key);
-        HashEntry* entry = buckets_[idx];
-        while (entry) {
-            if (entry->key == key) return true;
-            entry = entry->next;
-        }
-        return false;
+    template <typename Q>
+    bool contains(const Q& key) const {
+        return find_index(key, hash_of(key)) != capacity_;
     }
 
     /**
      * @brief Removes a key–value pair from the table.
      *
+     * @details Following entries are shifted back one slot until an empty
+     * slot or an entry already at its home position is reached.
+     *
      * @param[in] key Key to remove.
      */
-    void remove(const K& key) {
-        std::size_t idx = hash_func(key);
-        HashEntry* entry = buckets_[idx];
-        HashEntry* prev = nullptr;
-
-        while (entry) {
-            if (entry->key == key) {
-                if (prev) prev->next = entry->next;
-                else buckets_[idx] = entry->next;
-                delete entry;
-                --size_;
-                return;
-            }
-            prev = entry;
-            entry = entry->next;
+    template <typename Q>
+    void remove(const Q& key) {
+        std::size_t idx = find_index(key, hash_of(key));
+        if (idx == capacity_) return;
+
+        slots_[idx].~Slot();
+        dist_[idx] = 0;
+        --size_;
+
+        std::size_t next = (idx + 1) & (capacity_ - 1);
+        while (dist_[next] > 1) {
+            new (&slots_[idx]) Slot{std::move(slots_[next].key), std::move(slots_[next].value)};
+            slots_[next].~Slot();
+            hashes_[idx] = hashes_[next];
+            dist_[idx] = dist_[next] - 1;
+            dist_[next] = 0;
+            idx = next;
+            next = (next + 1) & (capacity_ - 1);
+        }
+    }
+
+    /**
+     * @brief Visits every entry in unspecified order.
+     *
+     * @param[in] fn Callable invoked as fn(const K&, const V&).
+     */
+    template <typename F>
+    void for_each(F&& fn) const {
+        for (std::size_t i = 0; i < capacity_; ++i) {
+            if (dist_[i]) fn(slots_[i].key, slots_[i].value);
         }
     }
 };
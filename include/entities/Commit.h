@@ -4,9 +4,9 @@
  *
  * @author Umut Ertuğrul Daşgın
  * @note Documentation maintained by Deniz Kayra Aydın / Ömer Kağan Zafer.
- * @version 1.1
+ * @version 1.3
  * @date 2025-12-25
- * @lastModified 2026-01-10
+ * @lastModified 2026-10-14
  */
 
 
@@ -14,82 +14,147 @@
 
 #include <string>
 #include <ctime>
-#include <sstream>
-#include <iomanip>
-#include <functional>
-#include "../data_structures/DoublyLinkedList.h"
-#include "../entities/File.h"
+#include <utility>
+#include "../entities/Manifest.h"
+#include "../entities/ObjectId.h"
+#include "../crypto/Sha256.h"
 
 namespace entities {
 
+class Commit;
+
+/**
+ * @brief Resolves commit identifiers to commit objects.
+ * * Implemented by the component that owns commits (core::GraphManager)
+ * * Lets restored commits load their parents and manifest on first access
+ */
+class CommitResolver {
+public:
+    virtual ~CommitResolver() = default;
+
+    /**
+     * @brief Looks up a commit by identifier.
+     * @param id Commit identifier.
+     * @return Commit pointer or nullptr if unknown.
+     */
+    virtual Commit* resolve_commit(const ObjectId& id) = 0;
+
+    /**
+     * @brief Expands a stored root tree into a manifest.
+     * @param tree_id Root tree id (null for an empty snapshot).
+     * @return Manifest of every file below the tree.
+     */
+    virtual Manifest resolve_manifest(const ObjectId& tree_id) = 0;
+};
+
 /**
  * @brief Immutable commit record.
- * * Stores metadata, file snapshots, and parent links
+ * * Stores metadata, a manifest of the snapshot, and parent links
+ * * Manifests are shared with parent commits wherever files are unchanged
  * * Supports merge commits with two parents
  */
 class Commit {
 private:
-    std::string id_;
+    ObjectId id_;
     std::string message_;
     std::string author_;
     std::time_t time_;
-    std::string tree_hash_;
-    data_structures::DoublyLinkedList<File> files_;
-    Commit* parent1_;
-    Commit* parent2_;
+    ObjectId tree_hash_;
+    mutable Manifest files_;
+    mutable bool files_loaded_;
+    ObjectId parent1_id_;
+    ObjectId parent2_id_;
+    mutable Commit* parent1_;
+    mutable Commit* parent2_;
+    CommitResolver* resolver_;
 
     /**
      * @brief Computes the commit identifier.
-     * @return Deterministic commit hash.
+     * @return SHA-256 over a "commit " tag, the length-framed metadata,
+     * the tree hash and the parent ids preceded by their count.
      */
-    std::string calculate_id() const {
-        std::stringstream ss;
-
-        ss << message_ << author_ << time_ << tree_hash_;
-
-        if (parent1_) ss << parent1_->get_id();
-        if (parent2_) ss << parent2_->get_id();
-
-        std::hash<std::string> hasher;
-        std::size_t hash_val = hasher(ss.str());
-
-        std::stringstream out;
-        out << std::hex << std::setw(16) << std::setfill('0') << hash_val;
-
-        return out.str();
+    ObjectId calculate_id() const {
+        crypto::Sha256 hasher;
+        hasher.update("commit ").update_field(message_).update_field(author_).update_field(std::to_string(time_));
+        hasher.update(tree_hash_.data(), ObjectId::size());
+        const char parents = static_cast<char>(!parent1_id_.is_null() + !parent2_id_.is_null());
+        hasher.update(&parents, 1);
+        if (!parent1_id_.is_null()) hasher.update(parent1_id_.data(), ObjectId::size());
+        if (!parent2_id_.is_null()) hasher.update(parent2_id_.data(), ObjectId::size());
+        return ObjectId(hasher.finish());
     }
 
 public:
     /**
      * @brief Creates a new commit instance.
+     * @details Message, author and manifest are sinks and are moved into
+     * the commit.
      * @param message Commit message.
      * @param author Commit author.
      * @param tree_hash Root tree hash.
-     * @param files Snapshot of tracked files.
+     * @param files Snapshot manifest (shared, not copied).
      * @param p1 First parent commit.
      * @param p2 Second parent commit.
      */
-    Commit(const std::string& message,
-           const std::string& author,
-           const std::string& tree_hash,
-           data_structures::DoublyLinkedList<File>& files,
+    Commit(std::string message,
+           std::string author,
+           const ObjectId& tree_hash,
+           Manifest files,
            Commit* p1 = nullptr,
            Commit* p2 = nullptr)
-        : message_(message),
-          author_(author),
+        : message_(std::move(message)),
+          author_(std::move(author)),
           tree_hash_(tree_hash),
-          files_(files),
+          files_(std::move(files)),
+          files_loaded_(true),
+          parent1_id_(p1 ? p1->get_id() : ObjectId()),
+          parent2_id_(p2 ? p2->get_id() : ObjectId()),
           parent1_(p1),
-          parent2_(p2) {
+          parent2_(p2),
+          resolver_(nullptr) {
 
         time_ = std::time(nullptr);
         id_ = calculate_id();
     }
 
+    /**
+     * @brief Restores a previously stored commit.
+     * @details Parents are referenced by id and the manifest by root tree;
+     * both are resolved lazily through @p resolver, so loading a commit
+     * loads neither its history nor its file list.
+     * @param id Stored commit identifier.
+     * @param message Commit message.
+     * @param author Commit author.
+     * @param time Original commit timestamp.
+     * @param tree_hash Root tree hash.
+     * @param parent1_id First parent id or the null id.
+     * @param parent2_id Second parent id or the null id.
+     * @param resolver Used to load parents on demand.
+     */
+    Commit(const ObjectId& id,
+           std::string message,
+           std::string author,
+           std::time_t time,
+           const ObjectId& tree_hash,
+           const ObjectId& parent1_id,
+           const ObjectId& parent2_id,
+           CommitResolver* resolver)
+        : id_(id),
+          message_(std::move(message)),
+          author_(std::move(author)),
+          time_(time),
+          tree_hash_(tree_hash),
+          files_loaded_(false),
+          parent1_id_(parent1_id),
+          parent2_id_(parent2_id),
+          parent1_(nullptr),
+          parent2_(nullptr),
+          resolver_(resolver) {}
+
     /**
      * @brief Returns the commit identifier.
      */
-    const std::string& get_id() const { return id_; }
+    const ObjectId& get_id() const { return id_; }
 
     /**
      * @brief Returns the commit message.
@@ -109,28 +174,51 @@ public:
     /**
      * @brief Returns the root tree hash.
      */
-    const std::string& get_tree_hash() const { return tree_hash_; }
+    const ObjectId& get_tree_hash() const { return tree_hash_; }
+
+    /**
+     * @brief Returns the manifest of tracked files, ordered by path.
+     * @details Restored commits expand their tree on first access.
+     */
+    const Manifest& get_files() const {
+        if (!files_loaded_) {
+            if (resolver_) files_ = resolver_->resolve_manifest(tree_hash_);
+            files_loaded_ = true;
+        }
+        return files_;
+    }
+
+    /**
+     * @brief Returns the first parent commit, loading it if necessary.
+     */
+    Commit* get_parent1() const {
+        if (!parent1_ && !parent1_id_.is_null() && resolver_) parent1_ = resolver_->resolve_commit(parent1_id_);
+        return parent1_;
+    }
 
     /**
-     * @brief Returns tracked files in this commit.
+     * @brief Returns the second parent commit, loading it if necessary.
      */
-    const data_structures::DoublyLinkedList<File>& get_files() const { return files_; }
+    Commit* get_parent2() const {
+        if (!parent2_ && !parent2_id_.is_null() && resolver_) parent2_ = resolver_->resolve_commit(parent2_id_);
+        return parent2_;
+    }
 
     /**
-     * @brief Returns the first parent commit.
+     * @brief Returns the first parent id (null for a root commit).
      */
-    Commit* get_parent1() const { return parent1_; }
+    const ObjectId& get_parent1_id() const { return parent1_id_; }
 
     /**
-     * @brief Returns the second parent commit.
+     * @brief Returns the second parent id (null unless this is a merge).
      */
-    Commit* get_parent2() const { return parent2_; }
+    const ObjectId& get_parent2_id() const { return parent2_id_; }
 
     /**
      * @brief Checks whether this is a merge commit.
      * @return True if two parents exist.
      */
-    bool is_merge_commit() const { return parent1_ && parent2_; }
+    bool is_merge_commit() const { return !parent1_id_.is_null() && !parent2_id_.is_null(); }
 };
 
 } // namespace entities
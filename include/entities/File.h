@@ -4,18 +4,20 @@
  *
  * @author Umut Ertuğrul Daşgın
  * @note Documentation maintained by Deniz Kayra Aydın / Ömer Kağan Zafer.
- * @version 1.1
+ * @version 1.5
  * @date 2025-12-25
- * @lastModified 2026-01-10
+ * @lastModified 2026-10-14
  */
 
 
 #pragma once
 
 #include <string>
-#include <functional>
-#include <sstream>
-#include <iomanip>
+#include <string_view>
+#include <utility>
+#include <cstdint>
+#include "ObjectId.h"
+#include "../crypto/Sha256.h"
 
 namespace entities {
 
@@ -23,41 +25,88 @@ namespace entities {
  * @brief File snapshot with content-based hashing.
  * * Stores file path and content
  * * Computes a deterministic content hash
+ * * A streamed file keeps only path, size and hash; its content lives in
+ *   the object store
  */
 class File {
 private:
     std::string path_;
     std::string content_;
-    std::string hash_;
+    std::uint64_t size_ = 0;
+    ObjectId hash_;
 
     /**
      * @brief Computes the file hash.
-     * @return Deterministic hash value.
+     * @see hash_of()
      */
-    std::string calculate_hash() const {
-        std::hash<std::string> hasher;
-        std::size_t hash_val = hasher(content_ + path_);
+    ObjectId calculate_hash() const { return hash_of(path_, content_); }
 
-        std::stringstream ss;
-        ss << std::hex << std::setw(16) << std::setfill('0') << hash_val;
-        return ss.str();
+public:
+    /**
+     * @brief Computes a file id from content supplied in pieces.
+     * * Construct with the path, update() the content in order, then finish()
+     * * Gives the same id as hash_of() on the whole content
+     */
+    class Hasher {
+    private:
+        crypto::Sha256 sha_;
+        std::uint64_t size_ = 0;
+
+    public:
+        explicit Hasher(std::string_view path) { sha_.update("blob ").update_field(path); }
+
+        Hasher& update(std::string_view piece) {
+            sha_.update(piece);
+            size_ += piece.size();
+            return *this;
+        }
+
+        ObjectId finish() {
+            std::string trailer = std::to_string(size_);
+            sha_.update("\0", 1).update(trailer);
+            return ObjectId(sha_.finish());
+        }
+    };
+
+    /**
+     * @brief Computes the id a file with this path and content gets,
+     * without building a File.
+     * @details Hashes `"blob " <len(path)> NUL path content NUL <len(content)>`.
+     * The path is framed up front and the content length trails, since a
+     * streamed file's size is only known at the end; the trailer holds no
+     * NUL, so the last NUL always marks where the content ends. Different
+     * (path, content) pairs never share an input, and the "blob " tag keeps
+     * file ids apart from the other object kinds.
+     */
+    static ObjectId hash_of(std::string_view path, std::string_view content) {
+        return Hasher(path).update(content).finish();
     }
 
-public:
     /**
      * @brief Creates a file with path and content.
+     * @details Both arguments are sinks: pass temporaries or std::move() to
+     * build the file without copying the content.
      * @param path File path.
      * @param content File content.
      */
-    File(const std::string& path, const std::string& content)
-        : path_(path), content_(content) {
+    File(std::string path, std::string content)
+        : path_(std::move(path)), content_(std::move(content)), size_(content_.size()) {
         hash_ = calculate_hash();
     }
 
+    /**
+     * @brief Describes a streamed file whose content is not held in memory.
+     * @param path File path.
+     * @param size Content size in bytes.
+     * @param hash Id the content was stored under.
+     */
+    File(std::string path, std::uint64_t size, const ObjectId& hash)
+        : path_(std::move(path)), size_(size), hash_(hash) {}
+
     /**
      * @brief Creates an empty file object.
      */
-    File() : path_(""), content_(""), hash_("") {}
+    File() : path_(""), content_(""), hash_() {}
 
     /**
      * @brief Returns the file path.
@@ -69,25 +118,36 @@ public:
      */
     const std::string& get_content() const { return content_; }
 
+    /**
+     * @brief Returns the content size, also for streamed files.
+     */
+    std::uint64_t get_size() const { return size_; }
+
     /**
      * @brief Returns the file hash.
      */
-    const std::string& get_hash() const { return hash_; }
+    const ObjectId& get_hash() const { return hash_; }
 
     /**
      * @brief Updates file content and recomputes hash.
-     * @param new_content New file content.
+     * @param new_content New file content (moved from).
      */
-    void set_content(const std::string& new_content) {
-        content_ = new_content;
+    void set_content(std::string new_content) {
+        content_ = std::move(new_content);
+        size_ = content_.size();
         hash_ = calculate_hash();
     }
 
+    /**
+     * @brief Moves the content out; the path and hash stay valid.
+     */
+    std::string release_content() { return std::move(content_); }
+
     /**
      * @brief Sets the hash value manually.
      * @param hash Hash value to assign.
      */
-    void set_hash_manual(const std::string& hash) { hash_ = hash; }
+    void set_hash_manual(const ObjectId& hash) { hash_ = hash; }
 
     /**
      * @brief Compares files by hash value.
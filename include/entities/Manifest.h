@@ -0,0 +1,306 @@
+/**
+ * @file Manifest.h
+ * @brief Sorted, structurally shared file listing of a commit snapshot.
+ *
+ * @details A manifest maps every tracked path to the id of its content. It
+ * is stored as a sequence of immutable, sorted segments held by shared
+ * pointers: deriving a child snapshot rebuilds only the segments that
+ * contain changed paths and shares every other segment with the parent.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.0
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "ObjectId.h"
+#include "PathPool.h"
+
+namespace entities {
+
+/// Mode of a regular, non-executable file.
+constexpr std::uint32_t kModeRegular = 0100644;
+/// Mode of an executable file.
+constexpr std::uint32_t kModeExecutable = 0100755;
+
+/**
+ * @brief Compact manifest record: interned path, mode and content id.
+ */
+struct ManifestEntry {
+    std::uint32_t path_id;
+    std::uint32_t mode;
+    ObjectId id;
+
+    ManifestEntry() : path_id(0), mode(kModeRegular), id() {}
+
+    ManifestEntry(std::string_view path, const ObjectId& content_id, std::uint32_t file_mode = kModeRegular)
+        : path_id(PathPool::instance().intern(path)), mode(file_mode), id(content_id) {}
+
+    const std::string& get_path() const { return PathPool::instance().path(path_id); }
+    const ObjectId& get_hash() const { return id; }
+    std::uint32_t get_mode() const { return mode; }
+
+    bool operator==(const ManifestEntry& o) const {
+        return path_id == o.path_id && mode == o.mode && id == o.id;
+    }
+    bool operator!=(const ManifestEntry& o) const { return !(*this == o); }
+};
+
+/**
+ * @brief Immutable snapshot listing, ordered by path.
+ * * Copying a manifest copies segment pointers, not entries
+ * * with_changes() derives a new manifest sharing untouched segments
+ * * diff() skips segments both manifests share without looking inside
+ */
+class Manifest {
+public:
+    /// Target number of entries per segment.
+    static constexpr std::size_t kSegmentSize = 256;
+
+private:
+    using Segment = std::vector<ManifestEntry>;
+    using SegmentPtr = std::shared_ptr<const Segment>;
+
+    std::vector<SegmentPtr> segments_;
+    std::size_t size_ = 0;
+
+    static bool path_less(const ManifestEntry& a, const ManifestEntry& b) {
+        return a.path_id != b.path_id && a.get_path() < b.get_path();
+    }
+
+    /**
+     * @brief Sorts by path keeping only the last entry for each path.
+     */
+    static void sort_unique(std::vector<ManifestEntry>& entries) {
+        // Staged and decoded entries usually arrive ordered already.
+        if (!std::is_sorted(entries.begin(), entries.end(), path_less)) {
+            std::stable_sort(entries.begin(), entries.end(), path_less);
+        }
+        std::size_t out = 0;
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            if (out > 0 && entries[out - 1].path_id == entries[i].path_id) {
+                entries[out - 1] = entries[i];
+            } else {
+                entries[out++] = entries[i];
+            }
+        }
+        entries.resize(out);
+    }
+
+    /**
+     * @brief Appends sorted entries, cutting them into segments.
+     */
+    void append_sorted(const ManifestEntry* first, std::size_t count) {
+        while (count > 0) {
+            // Avoid leaving a tiny trailing segment behind a full one.
+            std::size_t take = count < 2 * kSegmentSize ? count : kSegmentSize;
+            segments_.push_back(std::make_shared<const Segment>(first, first + take));
+            size_ += take;
+            first += take;
+            count -= take;
+        }
+    }
+
+    void append_segment(const SegmentPtr& seg) {
+        segments_.push_back(seg);
+        size_ += seg->size();
+    }
+
+public:
+    /**
+     * @brief Forward iterator over all entries in path order.
+     */
+    class const_iterator {
+    private:
+        const Manifest* m_;
+        std::size_t seg_;
+        std::size_t pos_;
+
+    public:
+        const_iterator(const Manifest* m, std::size_t seg, std::size_t pos) : m_(m), seg_(seg), pos_(pos) {}
+
+        const ManifestEntry& operator*() const { return (*m_->segments_[seg_])[pos_]; }
+        const ManifestEntry* operator->() const { return &(*m_->segments_[seg_])[pos_]; }
+
+        const_iterator& operator++() {
+            if (++pos_ == m_->segments_[seg_]->size()) {
+                ++seg_;
+                pos_ = 0;
+            }
+            return *this;
+        }
+
+        bool operator==(const const_iterator& o) const { return seg_ == o.seg_ && pos_ == o.pos_; }
+        bool operator!=(const const_iterator& o) const { return !(*this == o); }
+    };
+
+    Manifest() = default;
+
+    /**
+     * @brief Builds a manifest from entries in any order.
+     * @details If a path occurs more than once, the last occurrence wins.
+     */
+    static Manifest from_entries(std::vector<ManifestEntry> entries) {
+        sort_unique(entries);
+        Manifest m;
+        m.append_sorted(entries.data(), entries.size());
+        return m;
+    }
+
+    /**
+     * @brief Derives a manifest with changes applied.
+     *
+     * @details Each change inserts or replaces the entry for its path; a
+     * change carrying the null id removes the path. Segments that contain no
+     * changed path are shared with this manifest.
+     *
+     * @param changes Changes in any order; the last change to a path wins.
+     * @return The updated manifest.
+     */
+    Manifest with_changes(std::vector<ManifestEntry> changes) const {
+        sort_unique(changes);
+
+        Manifest out;
+        out.segments_.reserve(segments_.size() + 1);
+
+        std::size_t c = 0;
+        std::vector<ManifestEntry> merged;
+
+        for (std::size_t s = 0; s < segments_.size(); ++s) {
+            const Segment& seg = *segments_[s];
+
+            // Changes belonging to this segment: everything ordered before the next segment.
+            std::size_t c_end = c;
+            if (s + 1 == segments_.size()) {
+                c_end = changes.size();
+            } else {
+                const ManifestEntry& next_first = segments_[s + 1]->front();
+                while (c_end < changes.size() && path_less(changes[c_end], next_first)) ++c_end;
+            }
+
+            if (c_end == c) {
+                out.append_segment(segments_[s]);
+                continue;
+            }
+
+            merged.clear();
+            std::size_t i = 0;
+            while (i < seg.size() || c < c_end) {
+                if (c == c_end || (i < seg.size() && path_less(seg[i], changes[c]))) {
+                    merged.push_back(seg[i++]);
+                } else {
+                    bool replaces = i < seg.size() && seg[i].path_id == changes[c].path_id;
+                    if (!changes[c].id.is_null()) merged.push_back(changes[c]);
+                    if (replaces) ++i;
+                    ++c;
+                }
+            }
+            out.append_sorted(merged.data(), merged.size());
+        }
+
+        if (segments_.empty()) {
+            merged.clear();
+            for (const ManifestEntry& e : changes) {
+                if (!e.id.is_null()) merged.push_back(e);
+            }
+            out.append_sorted(merged.data(), merged.size());
+        }
+
+        return out;
+    }
+
+    /**
+     * @brief Looks up the entry for a path.
+     * @return Entry pointer or nullptr if the path is not tracked.
+     */
+    const ManifestEntry* find(std::string_view path) const {
+        auto seg_it = std::upper_bound(segments_.begin(), segments_.end(), path,
+            [](std::string_view p, const SegmentPtr& s) { return p < std::string_view(s->front().get_path()); });
+        if (seg_it == segments_.begin()) return nullptr;
+
+        const Segment& seg = **(seg_it - 1);
+        auto it = std::lower_bound(seg.begin(), seg.end(), path,
+            [](const ManifestEntry& e, std::string_view p) { return std::string_view(e.get_path()) < p; });
+        if (it == seg.end() || it->get_path() != path) return nullptr;
+        return &*it;
+    }
+
+    /**
+     * @brief Walks the differences between two manifests in path order.
+     *
+     * @details @p fn is called as fn(old_entry, new_entry) for every path
+     * whose entry differs; old_entry is nullptr for added paths and
+     * new_entry is nullptr for removed ones. Segments shared by both
+     * manifests are skipped in O(1).
+     *
+     * @param from Old manifest.
+     * @param to New manifest.
+     * @param fn Difference callback.
+     * @return Number of entries that are identical in both manifests.
+     */
+    template <typename F>
+    static std::size_t diff(const Manifest& from, const Manifest& to, F&& fn) {
+        std::size_t unchanged = 0;
+        std::size_t fs = 0, fp = 0, ts = 0, tp = 0;
+
+        auto advance = [](const Manifest& m, std::size_t& s, std::size_t& p) {
+            if (++p == m.segments_[s]->size()) {
+                ++s;
+                p = 0;
+            }
+        };
+
+        while (fs < from.segments_.size() && ts < to.segments_.size()) {
+            if (fp == 0 && tp == 0 && from.segments_[fs] == to.segments_[ts]) {
+                unchanged += to.segments_[ts]->size();
+                ++fs;
+                ++ts;
+                continue;
+            }
+
+            const ManifestEntry& a = (*from.segments_[fs])[fp];
+            const ManifestEntry& b = (*to.segments_[ts])[tp];
+
+            if (a.path_id == b.path_id) {
+                if (a == b) ++unchanged;
+                else fn(&a, &b);
+                advance(from, fs, fp);
+                advance(to, ts, tp);
+            } else if (path_less(a, b)) {
+                fn(&a, static_cast<const ManifestEntry*>(nullptr));
+                advance(from, fs, fp);
+            } else {
+                fn(static_cast<const ManifestEntry*>(nullptr), &b);
+                advance(to, ts, tp);
+            }
+        }
+
+        while (fs < from.segments_.size()) {
+            fn(&(*from.segments_[fs])[fp], static_cast<const ManifestEntry*>(nullptr));
+            advance(from, fs, fp);
+        }
+        while (ts < to.segments_.size()) {
+            fn(static_cast<const ManifestEntry*>(nullptr), &(*to.segments_[ts])[tp]);
+            advance(to, ts, tp);
+        }
+
+        return unchanged;
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0, 0); }
+    const_iterator end() const { return const_iterator(this, segments_.size(), 0); }
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+};
+
+} // namespace entities
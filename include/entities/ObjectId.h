@@ -0,0 +1,120 @@
+/**
+ * @file ObjectId.h
+ * @brief Fixed-size binary identifier for files, trees and commits.
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.0
+ * @date 2026-10-14
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <type_traits>
+#include "../crypto/Sha256.h"
+
+namespace entities {
+
+/**
+ * @brief 32-byte content address (SHA-256 digest).
+ * * Trivially copyable; comparisons are memcmp, not string compares
+ * * The all-zero id is the null id ("no object")
+ * * hash() reuses the digest's first 8 bytes, which are already uniformly
+ *   distributed, so hashing an id costs a single load
+ */
+class ObjectId {
+public:
+    static constexpr std::size_t kSize = crypto::Digest::kSize;
+
+private:
+    crypto::Digest digest_;
+
+public:
+    /**
+     * @brief Creates the null id.
+     */
+    ObjectId() = default;
+
+    /**
+     * @brief Wraps a computed digest.
+     */
+    explicit ObjectId(const crypto::Digest& d) : digest_(d) {}
+
+    /**
+     * @brief Copies kSize raw bytes.
+     */
+    static ObjectId from_bytes(const void* p) {
+        ObjectId id;
+        std::memcpy(id.digest_.bytes.data(), p, kSize);
+        return id;
+    }
+
+    /**
+     * @brief Parses a 64-character hex id.
+     * @param hex Hex text.
+     * @param[out] out Receives the id on success.
+     * @return False if @p hex is malformed.
+     */
+    static bool parse_hex(std::string_view hex, ObjectId& out) {
+        try {
+            out = ObjectId(crypto::Digest::from_hex(hex));
+            return true;
+        } catch (const std::invalid_argument&) {
+            return false;
+        }
+    }
+
+    /**
+     * @brief Parses a 64-character hex id.
+     * @throws std::invalid_argument if @p hex is malformed.
+     */
+    static ObjectId from_hex(std::string_view hex) {
+        return ObjectId(crypto::Digest::from_hex(hex));
+    }
+
+    /**
+     * @brief Full hex representation (display and text formats only).
+     */
+    std::string to_hex() const { return digest_.to_hex(); }
+
+    /**
+     * @brief Abbreviated hex representation.
+     * @param len Number of hex characters.
+     */
+    std::string short_hex(std::size_t len = 7) const { return to_hex().substr(0, len); }
+
+    bool is_null() const {
+        static const crypto::Digest kZero{};
+        return digest_ == kZero;
+    }
+
+    const std::uint8_t* data() const { return digest_.bytes.data(); }
+    static constexpr std::size_t size() { return kSize; }
+
+    std::size_t hash() const {
+        std::size_t h;
+        std::memcpy(&h, digest_.bytes.data(), sizeof(h));
+        return h;
+    }
+
+    bool operator==(const ObjectId& o) const { return digest_ == o.digest_; }
+    bool operator!=(const ObjectId& o) const { return digest_ != o.digest_; }
+    bool operator<(const ObjectId& o) const { return digest_ < o.digest_; }
+};
+
+static_assert(std::is_trivially_copyable<ObjectId>::value, "ObjectId must stay trivially copyable");
+
+} // namespace entities
+
+namespace std {
+template <>
+struct hash<entities::ObjectId> {
+    std::size_t operator()(const entities::ObjectId& id) const noexcept { return id.hash(); }
+};
+} // namespace std
@@ -0,0 +1,131 @@
+/**
+ * @file PathPool.h
+ * @brief Process-wide interning of repository paths.
+ *
+ * @details Manifest entries refer to paths by a 32-bit id instead of owning a
+ * std::string, so a path shared by many commits is stored exactly once.
+ * Paths are only freed by reset(), which long-running sessions call when
+ * they reopen the repository (see batch_mode() in main.cpp).
+ *
+ * @author Umut Ertuğrul Daşgın
+ * @version 1.1
+ * @date 2026-10-14
+ * @lastModified 2026-10-14
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include "../data_structures/HashTable.h"
+
+namespace entities {
+
+/**
+ * @brief Interns path strings and hands out stable 32-bit ids.
+ * * Interned strings are never moved and only freed by reset(), so
+ *   references returned by path() stay valid until then
+ * * path() is lock-free: strings live in fixed-size chunks published through
+ *   atomic pointers; only intern() takes the mutex
+ * * Id 0 is the empty path
+ */
+class PathPool {
+private:
+    static constexpr std::size_t kChunkBits = 12;
+    static constexpr std::size_t kChunkSize = std::size_t(1) << kChunkBits;
+    static constexpr std::size_t kMaxChunks = std::size_t(1) << 14;
+
+    std::mutex mutex_;
+    data_structures::HashTable<std::string_view, std::uint32_t> ids_;
+    std::atomic<std::string*> chunks_[kMaxChunks];
+    std::uint32_t count_;
+
+    PathPool() : count_(0) {
+        for (auto& c : chunks_) c.store(nullptr, std::memory_order_relaxed);
+        intern("");
+    }
+
+    /**
+     * @brief intern() with the mutex already held.
+     */
+    std::uint32_t intern_locked(std::string_view path) {
+        if (const std::uint32_t* id = ids_.find(path)) return *id;
+
+        std::size_t chunk = count_ >> kChunkBits;
+        if (chunk >= kMaxChunks) throw std::runtime_error("PathPool: too many distinct paths");
+
+        std::string* slots = chunks_[chunk].load(std::memory_order_relaxed);
+        if (!slots) {
+            slots = new std::string[kChunkSize];
+            chunks_[chunk].store(slots, std::memory_order_release);
+        }
+
+        std::string& stored = slots[count_ & (kChunkSize - 1)];
+        stored.assign(path.data(), path.size());
+        ids_.put(std::string_view(stored), count_);
+        return count_++;
+    }
+
+public:
+    ~PathPool() {
+        for (auto& c : chunks_) delete[] c.load(std::memory_order_relaxed);
+    }
+
+    PathPool(const PathPool&) = delete;
+    PathPool& operator=(const PathPool&) = delete;
+
+    /**
+     * @brief Returns the process-wide pool.
+     */
+    static PathPool& instance() {
+        static PathPool pool;
+        return pool;
+    }
+
+    /**
+     * @brief Returns the id of @p path, adding it on first use.
+     * @throws std::runtime_error if the pool is exhausted.
+     */
+    std::uint32_t intern(std::string_view path) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return intern_locked(path);
+    }
+
+    /**
+     * @brief Number of distinct paths interned, the empty path included.
+     */
+    std::size_t size() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return count_;
+    }
+
+    /**
+     * @brief Frees every path; only the empty path (id 0) remains.
+     * @details Every id handed out before becomes invalid, so this may only
+     * be called while no ManifestEntry exists and no other thread uses the
+     * pool, e.g. between closing and reopening a Repository.
+     */
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& c : chunks_) delete[] c.exchange(nullptr, std::memory_order_relaxed);
+        ids_.clear();
+        count_ = 0;
+        intern_locked("");
+    }
+
+    /**
+     * @brief Returns the path for an id obtained from intern().
+     */
+    const std::string& path(std::uint32_t id) const {
+        const std::string* slots = chunks_[id >> kChunkBits].load(std::memory_order_acquire);
+        return slots[id & (kChunkSize - 1)];
+    }
+};
+
+} // namespace entities
@@ -4,8 +4,9 @@
  * @author Umut Ertuğrul Daşgın
  * @co-conturbuted Alp Dikmen
  * @brief Entry point for the VCS Project. Contains Demo.
- * @version 1.0
+ * @version 1.1
  * @date 2025-12-25
+ * @lastModified 2026-10-14
  */
 // File: `include/tests/demo_scenarios.cpp`
 //
@@ -15,6 +16,8 @@
 #include "demo_scenarios.h"
 
 #include <iostream>
+#include <filesystem>
+#include <stdexcept>
 #include <core/Repository.h>
 
 #define RESET   "\033[0m"
@@ -26,10 +29,12 @@ void run_demo() {
     std::cout << GREEN << "=== AUTOMATED DEMO SCENARIO STARTED ===" << RESET << std::endl;
 
     try {
-        core::Repository repo;
-
         const std::string base = "tests/demo/";
 
+        // The demo always starts from an empty, demo-private repository.
+        std::filesystem::remove_all(base + ".tri");
+        core::Repository repo(base + ".tri");
+
         std::cout << CYAN << "\n[STEP 1] Initial Commit on Master" << RESET << std::endl;
         repo.add(base + "main.cpp", "int main() { return 0; }");
         repo.add(base + "readme.txt", "This is a VCS project.");
@@ -55,6 +60,31 @@ void run_demo() {
         std::cout << CYAN << "\n[STEP 6] Show History" << RESET << std::endl;
         repo.log();
 
+        // Regression: a file id must depend on where the path ends and the
+        // content begins ("x" + "hello" and "ox" + "hell" once shared an id).
+        std::cout << CYAN << "\n[STEP 7] Files Whose Path + Content Concatenate Alike" << RESET << std::endl;
+        const std::string ids = base + "ids/";
+        std::filesystem::remove_all(ids);
+        {
+            core::Repository ids_repo(ids + ".tri");
+            ids_repo.add(ids + "y", "z");
+            ids_repo.commit("Base", "Umut");
+            ids_repo.create_branch("b");
+            ids_repo.add(ids + "x", "hello");
+            ids_repo.add(ids + "ox", "hell");
+            ids_repo.commit("Add x and ox", "Umut");
+            ids_repo.checkout("b");
+            ids_repo.checkout("master");
+        }
+        std::string x, ox;
+        core::WorkingTree::read_file(ids + "x", x);
+        core::WorkingTree::read_file(ids + "ox", ox);
+        std::filesystem::remove_all(ids);
+        if (x != "hello" || ox != "hell") {
+            throw std::runtime_error("restored x='" + x + "', ox='" + ox + "' (expected 'hello', 'hell')");
+        }
+        std::cout << "x and ox restored with their own contents." << std::endl;
+
     } catch (const std::exception& e) {
         std::cerr << RED << "Demo Error: " << e.what() << RESET << std::endl;
     }
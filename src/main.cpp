@@ -2,9 +2,10 @@
  * @file main.cpp
  * @author Umut Ertuğrul Daşgın
  * @co-conturbuted Alp Dikmen
- * @brief Entry point for the VCS Project. Contains Demo and Interactive modes.
- * @version 1.0
+ * @brief Entry point for the VCS Project. Contains Demo, Interactive and Batch modes.
+ * @version 1.2
  * @date 2025-12-25
+ * @lastModified 2026-10-14
  */
 
 // main.cpp (edit: remove run_demo() definition, keep call)
@@ -12,9 +13,16 @@
 #include <string>
 #include <sstream>
 #include <vector>
+#include <cstdio>
+#include <ctime>
+#include <stdexcept>
+#include <algorithm>
+#include <optional>
 
 // Keep this as-is for now to minimize changes; you may later switch to <core/Repository.h>
 #include <core/Repository.h>
+#include <core/BatchProtocol.h>
+#include <core/Stats.h>
 
 #include <tests/demo_scenarios.h>
 #include "file_viewer.hpp"
@@ -41,6 +49,184 @@ std::vector<std::string> split_input(const std::string& input) {
     return tokens;
 }
 
+/**
+ * @brief Parses the argument of `log --since`.
+ * @param text A date (YYYY-MM-DD, local midnight) or an age such as 30m,
+ * 12h, 7d or 2w.
+ * @throws std::runtime_error if the text is neither.
+ */
+std::time_t parse_since(const std::string& text) {
+    int y, mo, d;
+    char tail;
+    if (std::sscanf(text.c_str(), "%4d-%2d-%2d%c", &y, &mo, &d, &tail) == 3) {
+        std::tm tm{};
+        tm.tm_year = y - 1900;
+        tm.tm_mon = mo - 1;
+        tm.tm_mday = d;
+        tm.tm_isdst = -1;
+        return std::mktime(&tm);
+    }
+
+    long amount;
+    char unit;
+    if (std::sscanf(text.c_str(), "%ld%c%c", &amount, &unit, &tail) == 2 && amount >= 0) {
+        long seconds = 0;
+        switch (unit) {
+            case 's': seconds = 1; break;
+            case 'm': seconds = 60; break;
+            case 'h': seconds = 3600; break;
+            case 'd': seconds = 86400; break;
+            case 'w': seconds = 7 * 86400; break;
+        }
+        if (seconds) return std::time(nullptr) - amount * seconds;
+    }
+    throw std::runtime_error("Invalid --since value: " + text + " (use YYYY-MM-DD or e.g. 7d)");
+}
+
+/**
+ * @brief Runs a repository command; shared by the interactive shell and batch mode.
+ * @param interactive Whether the command may prompt on standard input and
+ * page its output. Without it, a missing argument is an error.
+ * @return False if @p args does not name a repository command.
+ */
+bool run_command(core::Repository& repo, const std::vector<std::string>& args, bool interactive) {
+    const std::string& command = args[0];
+    auto usage = [interactive](const std::string& text) {
+        if (!interactive) throw std::runtime_error(text);
+        std::cout << text << "\n";
+    };
+
+    if (command == "add") {
+        if (args.size() == 2 && (args[1] == "--all" || args[1] == "-A")) {
+            repo.add_all();
+        } else if (args.size() >= 2 && args[1] == "--file") {
+            if (args.size() != 3) usage("Usage: add --file <path>");
+            else repo.add_file(args[2]);
+        } else if (args.size() < 2) {
+            usage("Usage: add <filename> <content> | add --all | add --file <path>");
+        } else if (args.size() < 3) {
+            usage("Usage: add <filename> <content>");
+            std::cout << "Interactive mode: Enter content for " << args[1] << ": ";
+            std::string content;
+            std::getline(std::cin, content);
+            repo.add(args[1], content);
+        } else {
+            repo.add(args[1], args[2]);
+        }
+    }
+    else if (command == "view")
+    {
+        if (args.size() < 2) {
+            usage("Usage: view <path>");
+        } else {
+            (void)print_file_contents(args[1]);
+        }
+    }
+    else if (command == "commit") {
+        std::string msg, author;
+        bool has_msg = false, has_author = false;
+        for (std::size_t i = 1; i < args.size(); ++i) {
+            if (args[i] == "-m" && i + 1 < args.size()) {
+                msg = args[++i];
+                has_msg = true;
+            } else if (args[i] == "--author" && i + 1 < args.size()) {
+                author = args[++i];
+                has_author = true;
+            }
+        }
+        if (!interactive && !(has_msg && has_author)) usage("Usage: commit -m <message> --author <name>");
+        if (!has_msg) {
+            std::cout << "Enter commit message: ";
+            std::getline(std::cin, msg);
+        }
+        if (!has_author) {
+            std::cout << "Enter author: ";
+            std::getline(std::cin, author);
+        }
+        repo.commit(msg, author);
+    }
+    else if (command == "branch") {
+        if (args.size() < 2) usage("Usage: branch <name> | branch --contains <rev>");
+        else if (args[1] == "--contains") repo.branch_contains(args.size() > 2 ? args[2] : "HEAD");
+        else repo.create_branch(args[1]);
+    }
+    else if (command == "checkout") {
+        if (args.size() < 2) {
+            usage("Usage: checkout <name> [-q] [-j N]");
+        } else {
+            bool quiet = false;
+            for (std::size_t i = 2; i < args.size(); ++i) {
+                if (args[i] == "-q") quiet = true;
+                else if (args[i] == "-j" && i + 1 < args.size()) repo.set_restore_threads(std::stoul(args[++i]));
+            }
+            repo.checkout(args[1], quiet);
+        }
+    }
+    else if (command == "merge") {
+        if (args.size() < 2) usage("Usage: merge <branch_name>");
+        else repo.merge(args[1]);
+    }
+    else if (command == "merge-base") {
+        if (args.size() < 3) usage("Usage: merge-base <rev> <rev>");
+        else repo.merge_base(args[1], args[2]);
+    }
+    else if (command == "stats") {
+        if (args.size() > 1 && args[1] == "reset") core::Stats::reset();
+        else if (!core::Stats::enabled()) std::cout << "Statistics are off; start tri with --stats.\n";
+        else core::Stats::report(std::cout);
+    }
+    else if (command == "status") {
+        repo.status();
+    }
+    else if (command == "diff") {
+        if (args.size() == 1) repo.diff();
+        else if (args[1] == "--staged" || args[1] == "--cached") repo.diff(true);
+        else repo.diff_branches(args[1], args.size() > 2 ? args[2] : "");
+    }
+    else if (command == "config") {
+        if (args.size() >= 3) repo.set_config(args[1], args[2]);
+        else repo.show_config(args.size() == 2 ? args[1] : "");
+    }
+    else if (command == "repack") {
+        repo.repack(args.size() > 1 ? std::stoul(args[1]) : 10,
+                    args.size() > 2 ? std::stoi(args[2]) : 0);
+    }
+    else if (command == "gc") {
+        repo.gc(args.size() > 1 ? std::stoul(args[1]) : 10,
+                args.size() > 2 ? std::stoi(args[2]) : 0);
+    }
+    else if (command == "bitmaps") {
+        repo.build_bitmaps();
+    }
+    else if (command == "pack-refs") {
+        repo.pack_refs();
+    }
+    else if (command == "train-dict") {
+        repo.train_dictionary(args.size() > 1 ? std::stoul(args[1]) : 16 * 1024);
+    }
+    else if (command == "log") {
+        core::LogOptions options;
+        options.use_pager = interactive;
+        std::string range;
+        for (std::size_t i = 1; i < args.size(); ++i) {
+            if (args[i] == "-n" && i + 1 < args.size()) options.max_count = std::stoul(args[++i]);
+            else if (args[i] == "--since" && i + 1 < args.size()) options.since = parse_since(args[++i]);
+            else if (args[i] == "--no-pager") options.use_pager = false;
+            else if (args[i].find("..") != std::string::npos) range = args[i];
+        }
+        if (range.empty()) {
+            repo.log(options);
+        } else {
+            std::size_t dots = range.find("..");
+            repo.log_range(range.substr(0, dots), range.substr(dots + 2), options);
+        }
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
 void interactive_shell() {
     core::Repository repo;
     std::string line;
@@ -67,61 +253,37 @@ void interactive_shell() {
                 std::cout << "Commands:\n"
                           << "  add <file> <content>   : Stage a file (use quotes for content logic not impl in parser)\n"
                           << "                           (Tip: For this shell, content is single word or handled simply)\n"
+                          << "  add --all | -A         : Stage every new, modified and deleted file\n"
+                          << "  add --file <path>      : Stage a file from disk, streamed in constant memory\n"
+                          << "  status                 : Show staged, unstaged and untracked files\n"
+                          << "  diff [--staged]        : Show unstaged (or staged) changes as unified diffs\n"
+                          << "  diff <branch> [branch] : Show changes from HEAD (or the first branch) to a branch\n"
+                          << "  config [key] [value]   : Show or change repository settings\n"
+                          << "  train-dict [bytes]     : Train a compression dictionary from HEAD\n"
+                          << "  repack [window] [depth]: Recompute delta bases over all history\n"
+                          << "  gc [window] [depth]    : Drop objects no branch reaches and repack the rest\n"
                           << "  view <view>              : View contents of a file \n"
-                          << "  commit <msg> <author>  : Commit changes\n"
-                          << "  log                    : Show history\n"
+                          << "  commit [-m <msg>] [--author <name>] : Commit changes (prompts for what is missing)\n"
+                          << "  log [-n N] [--since D] [--no-pager] : Show history, newest first\n"
+                          << "  log A..B [-n N]        : Show commits in B but not in A (either side may be empty: HEAD)\n"
                           << "  branch <name>          : Create new branch\n"
-                          << "  checkout <name>        : Switch branch\n"
-                          << "  merge <branch>         : Merge branch into current\n"
+                          << "  branch --contains <rev>: List branches containing a commit (branch, HEAD or id prefix)\n"
+                          << "  bitmaps                : Build reachability bitmaps for faster history queries\n"
+                          << "  pack-refs              : Move loose branch refs into the packed-refs file\n"
+                          << "  checkout <name> [-q] [-j N] : Switch branch (-q: summary only, -j: writer threads)\n"
+                          << "  merge <branch>         : Merge branch into current (fast-forward if behind)\n"
+                          << "  merge-base <rev> <rev> : Show the best common ancestor of two revisions\n"
+                          << "  stats [reset]          : Show (or zero) the counters and timers of --stats\n"
                           << "  demo                   : Run automated demo\n"
-                          << "  exit                   : Exit program\n";
-            }
-            else if (command == "add") {
-                if (args.size() < 3) {
-                    std::cout << "Usage: add <filename> <content>\n";
-                    std::cout << "Interactive mode: Enter content for " << args[1] << ": ";
-                    std::string content;
-                    std::getline(std::cin, content);
-                    repo.add(args[1], content);
-                } else {
-                    repo.add(args[1], args[2]);
-                }
-            }
-            else if (command == "view")
-            {
-                if (args.size() < 2) {
-                    std::cout << "Usage: view <path>\n";
-                } else {
-                    (void)print_file_contents(args[1]);
-                }
-            }
-            else if (command == "commit") {
-                std::string msg, author;
-                std::cout << "Enter commit message: ";
-                std::getline(std::cin, msg);
-                std::cout << "Enter author: ";
-                std::getline(std::cin, author);
-                repo.commit(msg, author);
-            }
-            else if (command == "branch") {
-                if (args.size() < 2) std::cout << "Usage: branch <name>\n";
-                else repo.create_branch(args[1]);
-            }
-            else if (command == "checkout") {
-                if (args.size() < 2) std::cout << "Usage: checkout <name>\n";
-                else repo.checkout(args[1]);
-            }
-            else if (command == "merge") {
-                if (args.size() < 2) std::cout << "Usage: merge <branch_name>\n";
-                else repo.merge(args[1]);
-            }
-            else if (command == "log") {
-                repo.log();
+                          << "  exit                   : Exit program\n"
+                          << "Run 'tri --batch' to read length-prefixed requests from stdin (see BatchProtocol.h).\n"
+                          << "Add '--stats' to count hashes, blob reads/writes, copies and table probes and time\n"
+                          << "each operation; the totals are printed to stderr on exit.\n";
             }
             else if (command == "demo") {
                 run_demo();
             }
-            else {
+            else if (!run_command(repo, args, true)) {
                 std::cout << "Unknown command. Type 'help'.\n";
             }
 
@@ -131,11 +293,108 @@ void interactive_shell() {
     }
 }
 
+/**
+ * @brief Answers batch requests from standard input until it ends or `exit`.
+ * @details The repository is opened once. Output a command writes to
+ * std::cout or std::cerr is captured into its response; standard output
+ * carries nothing but responses. Responses are flushed whenever no further
+ * request is already buffered, so pipelined requests share one write.
+ *
+ * Interned paths are never freed while the repository is open, so the
+ * session reopens it once the path pool has grown past twice what one
+ * command needed after the last reopen (and at least kPathPoolFloor):
+ * paths of files long deleted from the working tree do not pile up.
+ * @return Exit status: 1 after a malformed request, else 0.
+ * @see core::BatchProtocol
+ */
+int batch_mode() {
+    std::ios::sync_with_stdio(false);   // buffered cin, so in_avail() sees pipelined requests
+    std::ostream out(std::cout.rdbuf());
+    std::streambuf* cout_buf = std::cout.rdbuf();
+    std::streambuf* cerr_buf = std::cerr.rdbuf();
+
+    constexpr std::size_t kPathPoolFloor = std::size_t(1) << 16;
+    entities::PathPool& paths = entities::PathPool::instance();
+    std::size_t path_limit = kPathPoolFloor;
+    bool reopened = false;
+
+    std::cout.rdbuf(cerr_buf);   // startup messages must not corrupt the response stream
+    std::optional<core::Repository> repo;
+    repo.emplace();
+
+    std::ostringstream captured;
+    std::cout.rdbuf(captured.rdbuf());
+    std::cerr.rdbuf(captured.rdbuf());
+
+    int status = 0;
+    std::vector<std::string> args;
+    while (true) {
+        try {
+            if (!core::BatchProtocol::read_request(std::cin, args)) break;
+        } catch (const std::runtime_error& e) {
+            core::BatchProtocol::write_response(out, false, std::string(e.what()) + "\n");
+            status = 1;
+            break;
+        }
+
+        bool ok = true;
+        bool stop = args[0] == "exit" || args[0] == "quit";
+        try {
+            if (!stop && !run_command(*repo, args, false)) {
+                throw std::runtime_error("Unknown command: " + args[0]);
+            }
+        } catch (const std::exception& e) {
+            std::cout.flush();
+            captured << "Error: " << e.what() << "\n";
+            ok = false;
+        }
+
+        core::BatchProtocol::write_response(out, ok, captured.str());
+        captured.str("");
+        if (stop) break;
+        if (std::cin.rdbuf()->in_avail() <= 0) out.flush();
+
+        if (reopened) {
+            path_limit = std::max(kPathPoolFloor, 2 * paths.size());
+            reopened = false;
+        } else if (paths.size() > path_limit) {
+            std::cout.rdbuf(cerr_buf);
+            std::cerr.rdbuf(cerr_buf);
+            repo.reset();
+            paths.reset();
+            repo.emplace();
+            std::cout.rdbuf(captured.rdbuf());
+            std::cerr.rdbuf(captured.rdbuf());
+            reopened = true;
+        }
+    }
+
+    out.flush();
+    std::cout.rdbuf(cout_buf);
+    std::cerr.rdbuf(cerr_buf);
+    return status;
+}
+
 int main(int argc, char* argv[]) {
-    if (argc > 1 && std::string(argv[1]) == "demo") {
+    std::vector<std::string> flags(argv + 1, argv + argc);
+    auto stats = std::find(flags.begin(), flags.end(), "--stats");
+    if (stats != flags.end()) {
+        flags.erase(stats);
+        core::Stats::enable();
+    }
+
+    int status = 0;
+    if (!flags.empty() && flags[0] == "demo") {
         run_demo();
+    } else if (!flags.empty() && flags[0] == "--batch") {
+        status = batch_mode();
     } else {
         interactive_shell();
     }
-    return 0;
+
+    if (core::Stats::enabled()) {
+        std::cerr << "\n===== tri --stats =====\n";
+        core::Stats::report(std::cerr);
+    }
+    return status;
 }